@@ -23,9 +23,9 @@
 #include <emuframework/EmuAppInlines.hh>
 #undef BytePtr
 #undef Debugger
+#include <emuframework/RomLoader.hh>
 #include <stella/emucore/Cart.hxx>
 #include <stella/emucore/Props.hxx>
-#include <stella/emucore/MD5.hxx>
 #include <stella/emucore/Sound.hxx>
 #include <stella/emucore/SerialPort.hxx>
 #include <stella/emucore/TIA.hxx>
@@ -104,11 +104,12 @@ EmuSystem::Error EmuSystem::loadGame(IO &io, OnLoadProgressDelegate)
 		return makeError("ROM size is too large");
 	}
 	BytePtr image = std::make_unique<uInt8[]>(MAX_ROM_SIZE);
-	if(io.read(image.get(), size) != (ssize_t)size)
+	RomLoader loader{RomLoader::HASH_MD5};
+	if(loader.load(io, image.get(), size) || loader.size() != size)
 	{
 		return makeFileReadError();
 	}
-	string md5 = MD5::hash(image, size);
+	string md5 = loader.hashes().md5String().data();
 	Properties props;
 	osystem.propSet().getMD5(md5, props);
 	defaultGameProps = props;
@@ -144,14 +145,19 @@ void EmuSystem::configAudioRate(double frameTime, int rate)
 
 void EmuSystem::runFrame(EmuVideo *video, bool renderAudio)
 {
+	IG_TRACE_SPAN("EmuSystem::runFrame");
 	auto &console = osystem.console();
 	console.leftController().update();
 	console.rightController().update();
 	console.switches().update();
 	auto &tia = console.tia();
-	tia.update();
+	{
+		IG_TRACE_SPAN("TIA::update");
+		tia.update();
+	}
 	if(video)
 	{
+		IG_TRACE_SPAN("FrameBuffer::render");
 		video->setFormat({{(int)tia.width(), (int)tia.height()}, IG::PIXEL_FMT_RGB565});
 		auto img = video->startFrame();
 		osystem.frameBuffer().render(img.pixmap(), tia);
@@ -159,7 +165,11 @@ void EmuSystem::runFrame(EmuVideo *video, bool renderAudio)
 	}
 	auto frames = audioFramesPerVideoFrame;
 	Int16 buff[frames * soundChannels];
-	uint writtenFrames = osystem.soundGeneric().processAudio(buff, frames);
+	uint writtenFrames;
+	{
+		IG_TRACE_SPAN("Sound::processAudio");
+		writtenFrames = osystem.soundGeneric().processAudio(buff, frames);
+	}
 	if(renderAudio)
 		writeSound(buff, writtenFrames);
 }
@@ -204,6 +214,32 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 	return {};
 }
 
+static StateBufferStreamBuf stateStreamBuf{};
+static Serializer memState{stateStreamBuf};
+
+EmuSystem::Error EmuSystem::saveStateToBuffer(StateBuffer &buff)
+{
+	stateStreamBuf.setForWrite(buff);
+	memState.reset();
+	if(!stateManager.saveState(memState))
+	{
+		return makeFileWriteError();
+	}
+	return {};
+}
+
+EmuSystem::Error EmuSystem::loadStateFromBuffer(const StateBuffer &buff)
+{
+	stateStreamBuf.setForRead(buff);
+	memState.reset();
+	if(!stateManager.loadState(memState))
+	{
+		return makeFileReadError();
+	}
+	updateSwitchValues();
+	return {};
+}
+
 void EmuApp::onCustomizeNavView(EmuApp::NavView &view)
 {
 	const Gfx::LGradientStopDesc navViewGrad[] =
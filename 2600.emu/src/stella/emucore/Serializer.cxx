@@ -82,6 +82,13 @@ Serializer::Serializer()
   }
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Serializer::Serializer(std::streambuf& buffer)
+  : myStream(make_ptr<iostream>(&buffer))
+{
+  myStream->exceptions( ios_base::failbit | ios_base::badbit | ios_base::eofbit );
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::reset()
 {
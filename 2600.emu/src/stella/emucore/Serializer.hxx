@@ -56,6 +56,12 @@ class Serializer
     Serializer(const string& filename, bool readonly = false);
     Serializer();
 
+    /**
+      Creates a new Serializer device streaming to and from the given
+      stream buffer, which must outlive the Serializer.
+    */
+    Serializer(std::streambuf& buffer);
+
   public:
     /**
       Answers whether the serializer is currently initialized for reading
@@ -18,6 +18,7 @@ else ifeq ($(ENV),ios)
 endif
 
 SRC += main/Main.cc \
+main/FrameHandoff.cc \
 main/options.cc \
 main/input.cc \
 main/EmuControls.cc \
@@ -0,0 +1,152 @@
+/*  This file is part of C64.emu.
+
+	C64.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	C64.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with C64.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "FrameHandoff"
+#include <imagine/logger/logger.h>
+#include "internal.hh"
+
+// VICE's main loop never returns, it calls vsync_do_vsync2() at the end of
+// each frame, so it runs in its own context that the frame runner switches
+// into and vsync switches out of. With ucontext the switch is a register swap
+// on the calling thread. Otherwise it's a dedicated thread and a handoff that
+// spins briefly before sleeping, so a waiting side that's still spinning is
+// woken without a system call.
+
+#if defined __linux__ && !defined __ANDROID__
+#define C64_FRAME_COROUTINE
+#endif
+
+#ifdef C64_FRAME_COROUTINE
+#include <ucontext.h>
+#include <sys/mman.h>
+
+static constexpr size_t C64_STACK_SIZE = 8 * 1024 * 1024; // pages are only committed once used
+static ucontext_t frameRunnerContext{}, c64Context{};
+
+void startC64MainLoop()
+{
+	auto stack = mmap(nullptr, C64_STACK_SIZE, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK | MAP_NORESERVE, -1, 0);
+	if(stack == MAP_FAILED)
+	{
+		bug_unreachable("error allocating C64 stack");
+	}
+	// guard page to catch an overflow instead of corrupting other memory
+	mprotect(stack, 4096, PROT_NONE);
+	getcontext(&c64Context);
+	c64Context.uc_stack.ss_sp = stack;
+	c64Context.uc_stack.ss_size = C64_STACK_SIZE;
+	c64Context.uc_link = &frameRunnerContext;
+	makecontext(&c64Context,
+		[]()
+		{
+			logMsg("running C64");
+			plugin.maincpu_mainloop();
+			logErr("C64 main loop exited");
+		}, 0);
+}
+
+void execC64Frame()
+{
+	// runs until vsync switches back, from whichever thread is running frames
+	swapcontext(&frameRunnerContext, &c64Context);
+}
+
+void yieldC64Frame()
+{
+	swapcontext(&c64Context, &frameRunnerContext);
+}
+
+#else
+#include <imagine/thread/Thread.hh>
+#include <imagine/thread/Semaphore.hh>
+#include <atomic>
+#include <thread>
+
+// one-shot event, the semaphore is only touched when the waiter went to sleep
+class HandoffEvent
+{
+public:
+	HandoffEvent() {}
+
+	void notify()
+	{
+		if(state.exchange(SIGNALED, std::memory_order_release) == SLEEPING)
+			sem.notify();
+	}
+
+	void wait()
+	{
+		// spinning only helps when the other side can run at the same time
+		static const uint spins = std::thread::hardware_concurrency() > 1 ? 4096 : 0;
+		iterateTimes(spins, i)
+		{
+			if(state.load(std::memory_order_acquire) == SIGNALED)
+			{
+				state.store(EMPTY, std::memory_order_relaxed);
+				return;
+			}
+			cpuRelax();
+		}
+		int expected = EMPTY;
+		if(state.compare_exchange_strong(expected, SLEEPING, std::memory_order_acquire))
+		{
+			sem.wait();
+		}
+		state.store(EMPTY, std::memory_order_relaxed);
+	}
+
+private:
+	static constexpr int EMPTY = 0, SIGNALED = 1, SLEEPING = -1;
+	std::atomic_int state{EMPTY};
+	IG::Semaphore sem{0};
+
+	static void cpuRelax()
+	{
+		#if defined __i386__ || defined __x86_64__
+		__builtin_ia32_pause();
+		#elif defined __aarch64__ || (defined __arm__ && __ARM_ARCH >= 7)
+		asm volatile("yield");
+		#endif
+	}
+};
+
+static HandoffEvent execEvent{}, execDoneEvent{};
+
+void startC64MainLoop()
+{
+	IG::makeDetachedThread(
+		[]()
+		{
+			execEvent.wait();
+			logMsg("running C64");
+			plugin.maincpu_mainloop();
+		});
+}
+
+void execC64Frame()
+{
+	// signal C64 thread to execute one frame and wait for it to finish
+	execEvent.notify();
+	execDoneEvent.wait();
+}
+
+void yieldC64Frame()
+{
+	execDoneEvent.notify();
+	execEvent.wait();
+}
+
+#endif
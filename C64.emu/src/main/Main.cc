@@ -17,8 +17,6 @@
 #include <emuframework/EmuApp.hh>
 #include <emuframework/EmuInput.hh>
 #include <emuframework/EmuAppInlines.hh>
-#include <imagine/thread/Thread.hh>
-#include <imagine/thread/Semaphore.hh>
 #include <imagine/gui/AlertView.hh>
 #include "internal.hh"
 #include <sys/time.h>
@@ -69,7 +67,6 @@ extern "C"
 }
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2013-2014\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nVice Team\nwww.viceteam.org";
-IG::Semaphore execSem{0}, execDoneSem{0};
 bool runningFrame = false, doAudio = false;
 static bool c64IsInit = false, c64FailedInit = false;
 bool autostartOnLoad = true;
@@ -550,15 +547,9 @@ EmuSystem::Error EmuSystem::loadGame(IO &, OnLoadProgressDelegate)
 	return {};
 }
 
-static void execC64Frame()
-{
-	// signal C64 thread to execute one frame and wait for it to finish
-	execSem.notify();
-	execDoneSem.wait();
-}
-
 void EmuSystem::runFrame(EmuVideo *video, bool renderAudio)
 {
+	IG_TRACE_SPAN("EmuSystem::runFrame");
 	runningFrame = 1;
 	// "Warp" mode frame
 	if(unlikely(*plugin.warp_mode_enabled && video))
@@ -618,13 +609,7 @@ void EmuApp::onMainWindowCreated(ViewAttachParams attach, Input::Event e)
 
 EmuSystem::Error EmuSystem::onInit()
 {
-	IG::makeDetachedThread(
-		[]()
-		{
-			execSem.wait();
-			logMsg("running C64");
-			plugin.maincpu_mainloop();
-		});
+	startC64MainLoop();
 
 	#if defined CONFIG_ENV_LINUX && !defined CONFIG_MACHINE_PANDORA
 	sysFilePath[1] = EmuApp::assetPath();
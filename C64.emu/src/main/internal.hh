@@ -1,7 +1,6 @@
 #pragma once
 
 #include "VicePlugin.hh"
-#include <imagine/thread/Semaphore.hh>
 #include <imagine/pixmap/PixelFormat.hh>
 #include <emuframework/OptionView.hh>
 #include <emuframework/EmuSystem.hh>
@@ -13,7 +12,11 @@ extern bool doAudio;
 extern bool runningFrame;
 extern bool autostartOnLoad;
 static constexpr auto pixFmt = IG::PIXEL_FMT_RGB565;
-extern IG::Semaphore execSem, execDoneSem;
+// runs VICE's main loop until its next vsync
+void startC64MainLoop();
+void execC64Frame();
+// called from vsync to return to execC64Frame()
+void yieldC64Frame();
 extern double systemFrameRate;
 extern struct video_canvas_s *activeCanvas;
 extern IG::Pixmap canvasSrcPix;
@@ -89,16 +89,22 @@ static int loadSysFile(IO &file, const char *name, BYTE *dest, int minsize, int
 	return (int)rsize;
 }
 
-static ArchiveIO archiveIOForSysFile(const char *archivePath, const char *sysFileName, char **complete_path_return)
+static GenericIO archiveIOForSysFile(const char *archivePath, const char *sysFileName, char **complete_path_return, bool needsSeek)
 {
 	std::error_code ec{};
-	for(auto &entry : FS::ArchiveIterator{archivePath, ec})
+	auto index = FS::ArchiveIndex::open(archivePath, ec);
+	if(!index)
 	{
-		if(entry.type() == FS::file_type::directory)
+		logErr("error opening archive:%s", archivePath);
+		return {};
+	}
+	for(auto &entry : index->entries())
+	{
+		if(entry.isDirectory)
 		{
 			continue;
 		}
-		auto name = entry.name();
+		auto name = entry.name.data();
 		if(!string_equal(FS::basename(name).data(), sysFileName))
 			continue;
 		if(!containsSysFileDirName(FS::basename(FS::dirname(name).data())))
@@ -110,16 +116,9 @@ static ArchiveIO archiveIOForSysFile(const char *archivePath, const char *sysFil
 			*complete_path_return = strdup(fullPath.data());
 			assert(*complete_path_return);
 		}
-		return entry.moveIO();
-	}
-	if(ec)
-	{
-		logErr("error opening archive:%s", archivePath);
-	}
-	else
-	{
-		logErr("not found in archive:%s", archivePath);
+		return needsSeek ? index->openSeekableEntry(entry) : index->openEntry(entry);
 	}
+	logErr("not found in archive:%s", archivePath);
 	return {};
 }
 
@@ -138,11 +137,11 @@ CLINK FILE *sysfile_open(const char *name, char **complete_path_return, const ch
 			continue;
 		if(EmuApp::hasArchiveExtension(basePath.data()))
 		{
-			auto io = archiveIOForSysFile(basePath.data(), name, complete_path_return);
+			auto io = archiveIOForSysFile(basePath.data(), name, complete_path_return, true);
 			if(!io)
 				continue;
-			// Uncompress file into memory and wrap in FILE
-			return io.moveToMapIO().makeGeneric().moveToFileStream(open_mode);
+			// VICE may seek in the file, ZIP entries decompress on demand
+			return io.moveToFileStream(open_mode);
 		}
 		else
 		{
@@ -211,7 +210,7 @@ CLINK int sysfile_load(const char *name, BYTE *dest, int minsize, int maxsize)
 			continue;
 		if(EmuApp::hasArchiveExtension(basePath.data()))
 		{
-			auto io = archiveIOForSysFile(basePath.data(), name, nullptr);
+			auto io = archiveIOForSysFile(basePath.data(), name, nullptr, false);
 			if(!io)
 				continue;
 			auto size = loadSysFile(io, name, dest, minsize, maxsize);
@@ -45,9 +45,8 @@ int vsync_do_vsync2(struct video_canvas_s *c, int been_skipped)
 	//assert(EmuSystem::gameIsRunning());
 	if(likely(runningFrame))
 	{
-		//logMsg("vsync_do_vsync signaling main thread");
-		execDoneSem.notify();
-		execSem.wait();
+		//logMsg("vsync_do_vsync returning to frame runner");
+		yieldC64Frame();
 	}
 	else
 	{
@@ -33,24 +33,32 @@ CLINK FILE *zfile_fopen(const char *path, const char *mode)
 			return nullptr;
 		}
 		std::error_code ec{};
-		for(auto &entry : FS::ArchiveIterator{path, ec})
+		auto index = FS::ArchiveIndex::open(path, ec);
+		if(!index)
 		{
-			if(entry.type() == FS::file_type::directory)
+			logErr("error opening archive:%s", path);
+			return nullptr;
+		}
+		for(auto &entry : index->entries())
+		{
+			if(entry.isDirectory)
 			{
 				continue;
 			}
-			auto name = entry.name();
+			auto name = entry.name.data();
 			logMsg("archive file entry:%s", name);
 			if(EmuSystem::defaultFsFilter(name))
 			{
-				return entry.moveIO().moveToMapIO().makeGeneric().moveToFileStream(mode);
+				// disk & tape images are seeked around, ZIP entries decompress on demand
+				auto io = index->openSeekableEntry(entry);
+				if(!io)
+				{
+					logErr("error opening archive entry:%s", name);
+					return nullptr;
+				}
+				return io.moveToFileStream(mode);
 			}
 		}
-		if(ec)
-		{
-			logErr("error opening archive:%s", path);
-			return nullptr;
-		}
 		logErr("no recognized file extensions in archive:%s", path);
 		return nullptr;
 	}
@@ -30,7 +30,19 @@ EmuVideoLayer.cc \
 Cheats.cc \
 Recent.cc \
 EmuLoadProgressView.cc \
-RecentGameView.cc
+RecentGameView.cc \
+HeadlessRunner.cc \
+Benchmark.cc \
+EmuThread.cc \
+StateBuffer.cc \
+Rewind.cc \
+RunAhead.cc \
+AudioRateControl.cc \
+FrameTelemetry.cc \
+SaveFileWriter.cc \
+InputQueue.cc \
+InputLog.cc \
+RomLoader.cc
 
 ifeq ($(emuFramework_onScreenControls), 1)
  SRC += TouchConfigView.cc \
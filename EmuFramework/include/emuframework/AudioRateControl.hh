@@ -0,0 +1,60 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/config/defs.hh>
+#include <imagine/audio/Resampler.hh>
+#include <vector>
+
+// Keeps the output buffer near a target fill level by slightly stretching or
+// shrinking each frame's audio, so small clock differences between the
+// emulated system and the sound card never add up to an underrun or overflow.
+class AudioRateControl
+{
+public:
+	static constexpr double MAX_RATE_DELTA = .005;
+	static constexpr double TARGET_FILL = .5;
+
+	struct Samples
+	{
+		const int16 *data;
+		uint frames;
+	};
+
+	AudioRateControl() {}
+	void reset();
+	void setQuality(Audio::Resampler::Quality quality);
+	// call once per write with the output buffer's free space
+	void update(int framesFree);
+	// resamples interleaved S16 frames by the current ratio
+	Samples resample(const int16 *samples, uint frames, uint channels);
+	// resamples straight into the audio device's buffer, returns false if
+	// the device doesn't expose one and resample() must be used instead
+	bool resampleToPlayBuffer(const int16 *samples, uint frames, uint channels);
+	double ratio() const { return ratio_; }
+	// frames free in the output buffer when it's at the target fill, 0 if unknown
+	int targetFramesFree() const { return capacity * (1. - TARGET_FILL); }
+
+protected:
+	Audio::Resampler resampler{};
+	Audio::Resampler::Quality quality = Audio::Resampler::Quality::MEDIUM;
+	std::vector<int16> outBuff{};
+	double ratio_ = 1.;
+	double avgFill = TARGET_FILL;
+	int capacity = 0;
+
+	bool prepareResampler(uint channels);
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/time/Time.hh>
+#include <imagine/fs/FS.hh>
+#include <emuframework/EmuSystem.hh>
+#include <vector>
+#include <string>
+
+class InputLog;
+
+struct BenchmarkConfig
+{
+	// when set, each run starts from the log's state and replays all its frames
+	// in place of the warm-up & measured frames
+	InputLog *replay{};
+	uint warmupFrames = 60;
+	uint frames = 600;
+	// passes run in order, each renders video unless noted
+	bool videoRun = true;
+	bool videoSkippedRun = true; // no video frames rendered, the emulation-only baseline
+	bool audioRun = true;
+};
+
+// per-frame timing samples of one benchmark run
+class BenchmarkStats
+{
+public:
+	BenchmarkStats() {}
+	void reset(uint expectedFrames);
+	void addSample(IG::Time time);
+	uint frames() const { return samples.size(); }
+	IG::Time total() const { return IG::Time::makeWithNSecs(totalNSecs); }
+	IG::Time min() const;
+	IG::Time max() const;
+	IG::Time median() const { return percentile(50.); }
+	IG::Time percentile(double p) const;
+	double fps() const;
+	explicit operator bool() const { return frames(); }
+
+protected:
+	std::vector<uint64_t> samples{};
+	mutable std::vector<uint64_t> sorted{};
+	uint64_t totalNSecs = 0;
+
+	const std::vector<uint64_t> &sortedSamples() const;
+};
+
+struct BenchmarkResult
+{
+	FS::FileString game{};
+	BenchmarkStats video{};
+	BenchmarkStats videoSkipped{};
+	BenchmarkStats audio{};
+	uint64_t audioFrames = 0;
+	std::string error{};
+};
+
+// runs the currently loaded game, its state is advanced by the benchmark
+BenchmarkResult runBenchmark(const BenchmarkConfig &conf);
+// loads & benchmarks each file in the directory accepted by EmuSystem::defaultBenchmarkFsFilter
+std::vector<BenchmarkResult> runBenchmarkOnDirectory(const char *path, const BenchmarkConfig &conf);
+std::string benchmarkResultsToJSON(const BenchmarkConfig &conf, const BenchmarkResult *result, uint results);
@@ -32,6 +32,8 @@ extern Byte1Option optionSound;
 	#endif
 extern Byte1Option optionSoundBuffers;
 #endif
+extern Byte1Option optionDynamicAudioRate;
+extern Byte1Option optionAudioResamplerQuality;
 #if defined CONFIG_AUDIO_OPENSL_ES && !defined CONFIG_MACHINE_OUYA
 #define EMU_FRAMEWORK_STRICT_UNDERRUN_CHECK_OPTION
 extern OptionAudioHintStrictUnderrunCheck optionSoundUnderrunCheck;
@@ -111,6 +113,11 @@ extern OptionVControllerLayoutPosition optionVControllerLayoutPos;
 extern Byte1Option optionFrameInterval;
 #endif
 extern Byte1Option optionSkipLateFrames;
+extern Byte1Option optionEmulateInThread;
+extern Byte1Option optionShowFrameTiming;
+extern Byte1Option optionRewindMemory; // in MiB, 0 disables rewind
+extern Byte1Option optionRewindInterval;
+extern Byte1Option optionRunAheadFrames;
 extern DoubleOption optionFrameRate;
 extern DoubleOption optionFrameRatePAL;
 extern DoubleOption optionRefreshRateOverride;
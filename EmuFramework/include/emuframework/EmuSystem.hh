@@ -25,9 +25,11 @@
 #include <imagine/gui/View.hh>
 #include <imagine/util/audio/PcmFormat.hh>
 #include <imagine/util/string.h>
+#include <imagine/logger/Trace.hh>
 #include <stdexcept>
 #include <experimental/optional>
 #include <emuframework/EmuVideo.hh>
+#include <emuframework/StateBuffer.hh>
 
 #ifdef ENV_NOTE
 #define PLATFORM_INFO_STR ENV_NOTE " (" CONFIG_ARCH_STR ")"
@@ -100,6 +102,7 @@ public:
 	};
 
 	using OnLoadProgressDelegate = DelegateFunc<bool(int pos, int max, const char *label)>;
+	using AudioSinkDelegate = DelegateFunc<void(const void *samples, uint frames)>;
 
 	using Error = std::experimental::optional<std::runtime_error>;
 	using NameFilterFunc = bool(*)(const char *name);
@@ -151,6 +154,9 @@ public:
 	static void startAutoSaveStateTimer();
 	static Error loadState(const char *path);
 	static Error saveState(const char *path);
+	// in-memory states, cores without a memory serializer go through saveState()/loadState()
+	static Error saveStateToBuffer(StateBuffer &buff);
+	static Error loadStateFromBuffer(const StateBuffer &buff);
 	static bool stateExists(int slot);
 	static bool shouldOverwriteExistingState();
 	static const char *systemName();
@@ -213,13 +219,13 @@ public:
 	static void stopSound();
 	static void startSound();
 	static void writeSound(const void *samples, uint framesToWrite);
+	static void setAudioSink(AudioSinkDelegate sink);
 	static uint advanceFramesWithTime(Base::FrameTimeBase time);
 	static void setupGamePaths(const char *filePath);
 	static void setGameSavePath(const char *path);
 	static void setupGameSavePath();
 	static void clearGamePaths();
 	static FS::PathString baseDefaultGameSavePath();
-	static IG::Time benchmark();
 	static bool gameIsRunning()
 	{
 		return !string_equal(gameName_.data(), "");
@@ -236,6 +242,9 @@ public:
 	static Error makeFileReadError();
 	static Error makeFileWriteError();
 	static Error makeBlankError();
+
+private:
+	static AudioSinkDelegate audioSink;
 };
 
 static const char *stateNameStr(int slot)
@@ -17,6 +17,7 @@
 
 #include <imagine/gfx/Gfx.hh>
 #include <imagine/gfx/Texture.hh>
+#include <atomic>
 
 class EmuVideo;
 
@@ -50,6 +51,27 @@ private:
 	IG::Pixmap pix{};
 };
 
+// lock-free triple buffer of frames, filled by a single producer thread
+// and drained by the render thread, which always gets the newest frame
+class EmuVideoFrameQueue
+{
+public:
+	EmuVideoFrameQueue() {}
+	// buffer for the next frame, re-allocated if the format changed
+	IG::MemPixmap &writeBuffer(IG::PixmapDesc desc);
+	void push();
+	IG::MemPixmap *pop();
+	bool hasFrame() const { return readyIdx.load(std::memory_order_relaxed) & FRESH_BIT; }
+
+protected:
+	static constexpr uint8 IDX_MASK = 0x3;
+	static constexpr uint8 FRESH_BIT = 0x4;
+	IG::MemPixmap buff[3]{};
+	std::atomic<uint8> readyIdx{1};
+	uint8 writeIdx = 0;
+	uint8 readIdx = 2;
+};
+
 class EmuVideo
 {
 public:
@@ -65,13 +87,28 @@ public:
 	Gfx::PixmapTexture &image();
 	Gfx::Renderer &renderer() { return r; }
 	IG::WP size() const;
+	// frames go only to the backing memory pixmap, no texture or renderer is used
+	void setHeadless(bool on);
+	bool isHeadless() const { return headless; }
+	uint writtenFrames() const { return writtenFrames_; }
+	const IG::MemPixmap &memPixmap() const { return memPix; }
+	// frames go to the frame queue and are uploaded by the render thread with uploadQueuedFrame()
+	void setThreaded(bool on);
+	bool isThreaded() const { return threaded; }
+	bool uploadQueuedFrame();
 
 protected:
 	Gfx::Renderer &r;
 	Gfx::PixmapTexture vidImg{};
 	IG::MemPixmap memPix{};
+	EmuVideoFrameQueue frameQueue{};
+	IG::PixmapDesc queueDesc{};
+	uint writtenFrames_ = 0;
 	bool screenshotNextFrame = false;
 	bool renderNextFrame = false;
+	bool headless = false;
+	bool threaded = false;
 
+	void setTextureFormat(IG::PixmapDesc desc);
 	void doScreenshot(IG::Pixmap pix);
 };
@@ -25,7 +25,7 @@ public:
 	EmuFilePicker(ViewAttachParams attach, const char *startingPath, bool pickingDir,
 		EmuSystem::NameFilterFunc filter, FS::RootPathInfo rootInfo,
 		Input::Event e, bool singleDir = false);
-	static EmuFilePicker *makeForBenchmarking(ViewAttachParams attach, Input::Event e, bool singleDir = false);
+	static EmuFilePicker *makeForBenchmarking(ViewAttachParams attach, Input::Event e, bool singleDir = false, bool wholeDir = false);
 	static EmuFilePicker *makeForLoading(ViewAttachParams attach, Input::Event e, bool singleDir = false);
 	static EmuFilePicker *makeForMediaChange(ViewAttachParams attach, Input::Event e, const char *path,
 		EmuSystem::NameFilterFunc filter, FSPicker::OnSelectFileDelegate onSelect);
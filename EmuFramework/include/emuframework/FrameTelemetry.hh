@@ -0,0 +1,81 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/config/defs.hh>
+#include <imagine/gfx/Gfx.hh>
+#include <imagine/gfx/ProjectionPlane.hh>
+#include <imagine/time/Time.hh>
+#include <array>
+#include <atomic>
+#include <system_error>
+
+// Per displayed frame timing, gathered only while enabled. Times reported
+// from the emulation thread accumulate in atomics and are folded into a
+// sample on the main thread once the frame they belong to is presented.
+class FrameTelemetry
+{
+public:
+	static constexpr uint MAX_SAMPLES = 120;
+
+	struct Sample
+	{
+		float runFrameSecs; // emulation, excluding video output nested in it
+		float writeFrameSecs; // pixel conversion & texture upload
+		float presentSecs; // from the draw request until the drawable is presented
+		uint16 skippedFrames; // frames beyond the first from advanceFramesWithTime()
+		int16 audioFill; // output buffer fill in 1/1000ths, -1 if unknown
+		float inputLatencySecs; // from the oldest input event applied until present, 0 if none
+	};
+
+	constexpr FrameTelemetry() {}
+	void setEnabled(bool on);
+	bool isEnabled() const { return enabled; }
+	void reset();
+	// callable from any thread
+	void addRunFrameTime(double secs);
+	void addWriteFrameTime(double secs, double nestedSecs = 0);
+	void addSkippedFrames(uint frames);
+	void setAudioFramesFree(int framesFree);
+	void addInputApplied(IG::Time eventTime);
+	// main thread only
+	void markDrawPosted();
+	void markPresented();
+	void commitFrame();
+	uint samples() const { return sampleCount; }
+	const Sample &sample(uint idx) const;
+	void draw(Gfx::Renderer &r, const Gfx::ProjectionPlane &projP, double frameTime) const;
+	std::error_code writeCSV(const char *path) const;
+	std::error_code writeJSON(const char *path) const;
+
+private:
+	std::array<Sample, MAX_SAMPLES> sample_{};
+	uint nextSample = 0;
+	uint sampleCount = 0;
+	std::atomic_uint runFrameUSecs{};
+	std::atomic_uint writeFrameUSecs{};
+	std::atomic_uint nestedUSecs{};
+	std::atomic_uint skippedFrames{};
+	std::atomic_int audioFill{-1};
+	std::atomic<uint64_t> inputEventNSecs{};
+	int audioCapacity = 0; // most frames ever free, only touched by the audio writer
+	IG::Time drawPostTime{};
+	float presentSecs = 0;
+	float inputLatencySecs = 0;
+	bool drawPosted = false;
+	bool presented = false;
+	bool enabled = false;
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/config/defs.hh>
+#include <emuframework/EmuSystem.hh>
+#include <emuframework/StateBuffer.hh>
+#include <system_error>
+#include <vector>
+
+// Core independent input movie: an in-memory state to start from and every
+// EmuSystem::handleInputAction() call the framework made, keyed by the
+// number of emulated frames run before it. Replaying it from the same state
+// reproduces the same frames, so it gives benchmarks and profiling runs an
+// identical workload. Recording and replay run on the thread running frames.
+class InputLog
+{
+public:
+	struct Action
+	{
+		uint32_t frame;
+		uint32_t emuKey;
+		uint32_t state;
+	};
+
+	InputLog() {}
+	// snapshots the current state, the emulation thread must be held
+	EmuSystem::Error startRecording();
+	void stopRecording();
+	bool isRecording() const { return recording; }
+	// called with each action applied and after each emulated frame
+	void addAction(uint state, uint emuKey);
+	void addFrames(uint frames);
+	uint frames() const { return frames_; }
+	std::error_code writeFile(const char *path) const;
+	EmuSystem::Error readFile(const char *path);
+	// loads the initial state and rewinds to the first frame
+	EmuSystem::Error startReplay();
+	// applies the next frame's actions, false once past the last recorded frame
+	bool replayFrame();
+
+protected:
+	StateBuffer initialState{};
+	std::vector<Action> action{};
+	uint32_t frames_ = 0;
+	uint32_t replayFrameIdx = 0;
+	uint32_t replayActionIdx = 0;
+	bool recording = false;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/config/defs.hh>
+#include <imagine/time/Time.hh>
+#include <array>
+#include <atomic>
+
+// Emulated input actions waiting for the frame they belong to. The UI thread
+// pushes actions stamped with their event time, and whichever thread runs
+// frames applies them right before the first frame whose boundary falls after
+// that time, so each frame of a frame-skip burst sees the input it would have
+// seen at full speed. Single producer, single consumer and lock-free.
+class InputQueue
+{
+public:
+	static constexpr uint QUEUE_SIZE = 256;
+
+	constexpr InputQueue() {}
+	// UI thread
+	void push(IG::Time time, uint state, uint emuKey);
+	// frame thread, framesLeft is the number of frames in the burst still to
+	// run after the next one, which ends at batchTime when framesLeft is 0
+	void applyForFrame(IG::Time batchTime, uint framesLeft);
+	void applyAll();
+	// both sides must be idle
+	void clear();
+
+private:
+	struct Action
+	{
+		uint64_t time; // nanoseconds
+		uint state;
+		uint emuKey;
+	};
+
+	std::array<Action, QUEUE_SIZE> action{};
+	std::atomic_uint writePos{}, readPos{};
+
+	void applyUntil(uint64_t time);
+};
@@ -47,6 +47,8 @@ protected:
 	MultiChoiceMenuItem frameInterval;
 	#endif
 	BoolMenuItem dropLateFrames;
+	BoolMenuItem emulateInThread;
+	BoolMenuItem showFrameTiming;
 	char frameRateStr[64]{};
 	TextMenuItem frameRate;
 	char frameRatePALStr[64]{};
@@ -101,13 +103,16 @@ protected:
 	#endif
 	TextMenuItem audioRateItem[4];
 	MultiChoiceMenuItem audioRate;
+	BoolMenuItem dynamicRate;
+	TextMenuItem resamplerQualityItem[3];
+	MultiChoiceMenuItem resamplerQuality;
 	#ifdef CONFIG_AUDIO_OPENSL_ES
 	BoolMenuItem sndUnderrunCheck;
 	#endif
 	#ifdef CONFIG_AUDIO_MANAGER_SOLO_MIX
 	BoolMenuItem audioSoloMix;
 	#endif
-	StaticArrayList<MenuItem*, 12> item{};
+	StaticArrayList<MenuItem*, 14> item{};
 
 public:
 	AudioOptionView(ViewAttachParams attach, bool customMenu = false);
@@ -127,14 +132,21 @@ protected:
 	static constexpr uint MIN_FAST_FORWARD_SPEED = 2;
 	TextMenuItem fastForwardSpeedItem[6];
 	MultiChoiceMenuItem fastForwardSpeed;
+	TextMenuItem rewindMemoryItem[5];
+	MultiChoiceMenuItem rewindMemory;
+	TextMenuItem rewindIntervalItem[4];
+	MultiChoiceMenuItem rewindInterval;
+	TextMenuItem runAheadItem[5];
+	MultiChoiceMenuItem runAhead;
 	#if defined __ANDROID__
 	TextMenuItem processPriorityItem[3];
 	MultiChoiceMenuItem processPriority;
 	BoolMenuItem fakeUserActivity;
 	#endif
-	StaticArrayList<MenuItem*, 24> item{};
+	StaticArrayList<MenuItem*, 30> item{};
 
 	void onSavePathChange(const char *path);
+	void setRunAheadFrames(uint frames);
 	virtual void onFirmwarePathChange(const char *path, Input::Event e);
 	void pushAndShowFirmwarePathMenu(const char *name, Input::Event e);
 
@@ -0,0 +1,62 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/config/defs.hh>
+#include <emuframework/StateBuffer.hh>
+#include <memory>
+#include <deque>
+
+// Keeps a history of save states for rewinding. Only the newest state is
+// stored whole, older ones are the XOR against their successor with zero
+// runs compressed out, kept in a fixed size ring so the oldest history is
+// dropped once the memory limit is reached.
+class RewindManager
+{
+public:
+	RewindManager() {}
+	void setMemoryLimit(size_t bytes);
+	size_t memoryLimit() const { return ringSize; }
+	void setInterval(uint frames);
+	bool isEnabled() const { return ringSize; }
+	// call before running the given number of frames, captures a state once the interval has passed
+	void onFramesRun(uint frames);
+	// loads the previous snapshot, returns false if no history is left
+	bool rewind();
+	void clear();
+	void deinit();
+	uint snapshots() const { return entries.size() + !lastState.empty(); }
+
+protected:
+	struct Entry
+	{
+		size_t offset;
+		uint size;
+		uint stateSize;
+	};
+
+	std::unique_ptr<uint8[]> ring{};
+	size_t ringSize = 0;
+	std::deque<Entry> entries{};
+	StateBuffer lastState{}, newState{}, encodeBuff{};
+	int framesSinceCapture = 0;
+	uint interval = 1;
+	bool lastStateLoaded = false; // lastState was restored since it was captured
+
+	void capture();
+	void pushEntry(uint stateSize);
+	size_t nextEntryOffset(uint size);
+};
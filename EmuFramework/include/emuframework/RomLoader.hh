@@ -0,0 +1,111 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/config/defs.hh>
+#include <imagine/io/IO.hh>
+#include <imagine/util/bits.h>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <system_error>
+#include <vector>
+
+// Reads a ROM image into a core's buffer in chunks. While the next chunk
+// decompresses on the calling thread, the previous one is hashed on a
+// ThreadPool worker and then has any IPS or UPS patch applied to it, so the
+// hashes describe the unpatched image as ROM databases expect. BPS patches
+// copy from anywhere in the source and are applied once reading completes.
+class RomLoader
+{
+public:
+	static constexpr uint HASH_CRC32 = IG::bit(0);
+	static constexpr uint HASH_MD5 = IG::bit(1);
+	static constexpr uint HASH_SHA1 = IG::bit(2);
+	static constexpr size_t CHUNK_SIZE = 256 * 1024;
+
+	enum class PatchType : uint8 { NONE, IPS, UPS, BPS };
+
+	struct Hashes
+	{
+		uint32 crc32;
+		std::array<uint8, 16> md5;
+		std::array<uint8, 20> sha1;
+
+		// lowercase hex digests
+		std::array<char, 33> md5String() const;
+		std::array<char, 41> sha1String() const;
+	};
+
+	RomLoader(uint hashFlags = 0): hashFlags{hashFlags} {}
+	// looks for <basePath>.ips, .ups or .bps in that order, a missing patch isn't an error
+	std::error_code findPatch(const char *basePath);
+	// hashes only bytes [offset, offset + size) of the unpatched image, for
+	// formats whose databases skip a header, UPS and BPS patches need the
+	// whole image hashed to check their source
+	void setHashRange(size_t offset, size_t size) { hashOffset = offset; hashSize = size; }
+	// reads all of io into dest, the final size is available from size()
+	std::error_code load(IO &io, void *dest, size_t destSize);
+	// Like load(), but when io is a memory-mapped file its pages are moved to
+	// dest instead of read, so only pages the core or a patch writes get
+	// copied. That needs dest to be page aligned memory the core owns whole
+	// pages of, like a static array or mmap(), and destSize a multiple of the
+	// page size. Either way dest is zeroed past the source image.
+	std::error_code loadMapped(IO &io, void *dest, size_t destSize);
+	size_t size() const { return size_; }
+	// size before patching
+	size_t sourceSize() const { return sourceSize_; }
+	const Hashes &hashes() const { return hashes_; }
+	PatchType patchType() const { return patch.type; }
+	const char *patchTypeName() const;
+
+private:
+	struct PatchRecord
+	{
+		uint32 offset;
+		uint32 size;
+		const uint8 *data; // null for an IPS run of rleValue
+		uint8 rleValue;
+	};
+
+	struct Patch
+	{
+		std::unique_ptr<uint8[]> data{};
+		size_t dataSize = 0;
+		std::vector<PatchRecord> record{};
+		size_t sourceSize = 0; // UPS/BPS only
+		size_t targetSize = 0; // 0 keeps the source size
+		size_t actionsOffset = 0; // BPS only
+		uint32 sourceCRC = 0;
+		PatchType type = PatchType::NONE;
+	};
+
+	Patch patch{};
+	Hashes hashes_{};
+	size_t size_ = 0;
+	size_t sourceSize_ = 0;
+	size_t hashOffset = 0;
+	size_t hashSize = SIZE_MAX;
+	uint hashFlags = 0;
+
+	std::error_code parsePatch();
+	uint loadHashFlags() const;
+	size_t hashEnd() const { return hashSize > SIZE_MAX - hashOffset ? SIZE_MAX : hashOffset + hashSize; }
+	bool hasStreamedPatch() const;
+	std::error_code finishPatch(uint8 *dest, size_t destSize);
+	void applyStreamedPatch(uint8 *dest, size_t begin, size_t end) const;
+	std::error_code applyBPS(uint8 *dest, size_t destSize);
+};
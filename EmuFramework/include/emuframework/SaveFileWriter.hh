@@ -0,0 +1,70 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/config/defs.hh>
+#include <imagine/fs/FSDefs.hh>
+#include <imagine/thread/Semaphore.hh>
+#include <emuframework/StateBuffer.hh>
+#include <deque>
+#include <system_error>
+#include <mutex>
+#include <vector>
+
+// Writes save files from a background thread so the caller only pays for
+// copying the data. Each file is written to a temporary, synced, and renamed
+// over the old one, so an interrupted write never leaves a truncated save.
+class SaveFileWriter
+{
+public:
+	SaveFileWriter() {}
+	// takes the buffer's contents, a still queued write to the same path is replaced
+	void write(const char *path, StateBuffer buff);
+	// for battery saves, only queues a write if the data differs from the last
+	// write, or from what's on disk the first time, returns the error from
+	// the last completed write to the file
+	std::error_code writeIfChanged(const char *path, const void *data, size_t size);
+	// blocks until every queued write completes
+	void flush();
+
+protected:
+	struct Job
+	{
+		FS::PathString path{};
+		StateBuffer buff{};
+		IG::Semaphore *done{};
+		bool checkFile = false;
+	};
+
+	struct FileHash
+	{
+		FS::PathString path{};
+		uint64_t hash = 0;
+		std::error_code lastError{};
+	};
+
+	std::mutex mutex{};
+	std::deque<Job> jobs{};
+	std::vector<FileHash> fileHashes{};
+	IG::Semaphore jobSem{0};
+	bool threadStarted = false;
+
+	void queue(Job job);
+	FileHash *findFileHash(const char *path);
+	static bool fileMatches(const char *path, const void *data, size_t size);
+};
+
+extern SaveFileWriter saveFileWriter;
@@ -0,0 +1,62 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/config/defs.hh>
+#include <memory>
+#include <streambuf>
+
+// Memory for an in-memory save state. The allocation only grows so a buffer
+// reused for every snapshot stops allocating once it fits the largest state.
+class StateBuffer
+{
+public:
+	StateBuffer() {}
+	uint8 *data() { return buff.get(); }
+	const uint8 *data() const { return buff.get(); }
+	size_t size() const { return size_; }
+	size_t capacity() const { return capacity_; }
+	bool empty() const { return !size_; }
+	// growing keeps the existing contents, any new space is uninitialized
+	void resize(size_t size);
+	void reserve(size_t capacity);
+	void clear() { size_ = 0; }
+	void assign(const void *data, size_t size);
+	void append(const void *data, size_t size);
+
+protected:
+	std::unique_ptr<uint8[]> buff{};
+	size_t size_ = 0;
+	size_t capacity_ = 0;
+};
+
+// std::streambuf over a StateBuffer for cores with iostream based state code,
+// writes go to the end of the buffer and reads start from its beginning
+class StateBufferStreamBuf : public std::streambuf
+{
+public:
+	StateBufferStreamBuf() {}
+	void setForWrite(StateBuffer &buff);
+	void setForRead(const StateBuffer &buff);
+
+protected:
+	StateBuffer *writeBuff{};
+
+	std::streamsize xsputn(const char_type *s, std::streamsize count) override;
+	int_type overflow(int_type ch) override;
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+};
@@ -18,7 +18,7 @@
 namespace EmuControls
 {
 
-static const uint gameActionKeys = 9;
+static const uint gameActionKeys = 10;
 static const uint systemKeyMapStart = gameActionKeys;
 typedef uint GameActionKeyArray[gameActionKeys];
 
@@ -33,6 +33,7 @@ static const char *gameActionName[gameActionKeys] =
 	"Fast-forward",
 	"Take Screenshot",
 	"Open Menu",
+	"Rewind",
 };
 
 }
@@ -41,7 +42,7 @@ static const char *gameActionName[gameActionKeys] =
 {"Set In-Game Actions", gameActionName, 0}
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_UNBINDED_PROFILE_INIT \
-0, 0, 0, 0, 0, 0, 0, 0, 0
+0, 0, 0, 0, 0, 0, 0, 0, 0, 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_ICP_NUBS_PROFILE_INIT \
 Input::iControlPad::RNUB_DOWN, \
@@ -52,6 +53,7 @@ Input::iControlPad::RNUB_UP, \
 0, \
 Input::iControlPad::LNUB_UP, \
 0, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_ICADE_PROFILE_INIT \
@@ -63,6 +65,7 @@ Input::ICade::Z, \
 0, \
 0, \
 0, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_WIIMOTE_PROFILE_INIT \
@@ -74,6 +77,7 @@ Input::Wiimote::HOME, \
 0, \
 0, \
 0, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_WII_CC_PROFILE_INIT \
@@ -85,6 +89,7 @@ Input::WiiCC::HOME, \
 0, \
 Input::WiiCC::ZR, \
 0, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_WEBOS_KB_PROFILE_INIT \
@@ -96,6 +101,7 @@ Input::Keycode::A, \
 0, \
 Input::Keycode::AT, \
 0, \
+0, \
 0
 
 #define EMU_CONTROLS_WEBOS_KB_8WAY_DIRECTION_PROFILE_INIT \
@@ -117,7 +123,8 @@ Input::Keycode::MENU, \
 0, \
 Input::Keycode::SEARCH, \
 0, \
-Input::Keycode::BACK
+Input::Keycode::BACK, \
+0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_ANDROID_GENERIC_GAMEPAD_PROFILE_INIT \
 0, \
@@ -128,6 +135,7 @@ Input::Keycode::JS2_YAXIS_NEG, \
 0, \
 Input::Keycode::JS_RTRIGGER_AXIS, \
 0, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_OUYA_PROFILE_INIT \
@@ -139,6 +147,7 @@ Input::Keycode::MENU, \
 0, \
 Input::Keycode::Ouya::R2, \
 0, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_OUYA_MINIMAL_PROFILE_INIT \
@@ -150,6 +159,7 @@ Input::Keycode::MENU, \
 0, \
 0, \
 0, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_NVIDIA_SHIELD_PROFILE_INIT \
@@ -161,7 +171,8 @@ Input::Keycode::MENU, \
 0, \
 Input::Keycode::JS_RTRIGGER_AXIS, \
 0, \
-Input::Keycode::BACK
+Input::Keycode::BACK, \
+0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_NVIDIA_SHIELD_MINIMAL_PROFILE_INIT \
 0, \
@@ -172,7 +183,8 @@ Input::Keycode::BACK
 0, \
 Input::Keycode::JS_RTRIGGER_AXIS, \
 0, \
-Input::Keycode::BACK
+Input::Keycode::BACK, \
+0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_ANDROID_PS3_GAMEPAD_PROFILE_INIT \
 0, \
@@ -183,6 +195,7 @@ Input::Keycode::GAME_1, \
 0, \
 Input::Keycode::GAME_R2, \
 0, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_ANDROID_PS3_GAMEPAD_MINIMAL_PROFILE_INIT \
@@ -194,6 +207,7 @@ Input::Keycode::GAME_1, \
 0, \
 0, \
 0, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_GENERIC_KB_PROFILE_INIT \
@@ -205,7 +219,8 @@ Input::Keycode::LEFT_BRACKET, \
 Input::Keycode::RIGHT_BRACKET, \
 Input::Keycode::GRAVE, \
 0, \
-Input::Keycode::ESCAPE
+Input::Keycode::ESCAPE, \
+0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_GENERIC_KB_ALT_PROFILE_INIT \
 Input::Keycode::L, \
@@ -216,7 +231,8 @@ Input::Keycode::LEFT_BRACKET, \
 Input::Keycode::RIGHT_BRACKET, \
 Input::Keycode::GRAVE, \
 0, \
-Input::Keycode::ESCAPE
+Input::Keycode::ESCAPE, \
+0
 
 #ifdef CONFIG_BASE_ANDROID
 #define EMU_CONTROLS_IN_GAME_ACTIONS_GENERIC_KB_MINIMAL_PROFILE_INIT \
@@ -228,6 +244,7 @@ Input::Keycode::MENU, \
 0, \
 Input::Keycode::SEARCH, \
 0, \
+0, \
 0
 #else
 #define EMU_CONTROLS_IN_GAME_ACTIONS_GENERIC_KB_MINIMAL_PROFILE_INIT \
@@ -239,6 +256,7 @@ Input::Keycode::MENU, \
 0, \
 Input::Keycode::F11, \
 0, \
+0, \
 0
 #endif
 
@@ -257,6 +275,7 @@ Input::Keycode::F11, \
 	0, \
 	Input::PS3::R2, \
 	0, \
+	0, \
 	0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_GENERIC_PS3PAD_ALT_MINIMAL_PROFILE_INIT \
@@ -268,6 +287,7 @@ Input::Keycode::F11, \
 	0, \
 	0, \
 	0, \
+	0, \
 	0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_PANDORA_PROFILE_INIT \
@@ -279,7 +299,8 @@ Input::Keycode::F11, \
 	Input::Keycode::_6, \
 	Input::Keycode::Pandora::R, \
 	0, \
-	Input::Keycode::BACK_SPACE
+	Input::Keycode::BACK_SPACE, \
+	0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_PANDORA_ALT_PROFILE_INIT \
 	Input::Keycode::L, \
@@ -290,7 +311,8 @@ Input::Keycode::F11, \
 	Input::Keycode::_6, \
 	Input::Keycode::_0, \
 	0, \
-	Input::Keycode::BACK_SPACE
+	Input::Keycode::BACK_SPACE, \
+	0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_PANDORA_ALT_MINIMAL_PROFILE_INIT \
 	0, \
@@ -301,6 +323,7 @@ Input::Keycode::F11, \
 	0, \
 	Input::Keycode::Pandora::R, \
 	0, \
+	0, \
 	0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_APPLEGC_PROFILE_INIT \
@@ -312,6 +335,7 @@ Input::Keycode::F11, \
 	0, \
 	Input::AppleGC::R2, \
 	0, \
+	0, \
 	0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_APPLEGC_MINIMAL_PROFILE_INIT \
@@ -323,4 +347,5 @@ Input::Keycode::F11, \
 	0, \
 	0, \
 	0, \
+	0, \
 	0
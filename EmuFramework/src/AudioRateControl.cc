@@ -0,0 +1,98 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "AudioRateControl"
+#include <emuframework/AudioRateControl.hh>
+#include <imagine/audio/Audio.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/math/math.hh>
+
+void AudioRateControl::reset()
+{
+	ratio_ = 1.;
+	avgFill = TARGET_FILL;
+	capacity = 0;
+	resampler.reset();
+}
+
+void AudioRateControl::setQuality(Audio::Resampler::Quality newQuality)
+{
+	if(newQuality == quality)
+		return;
+	quality = newQuality;
+	// re-created with the new filter on the next resample()
+	resampler.deinit();
+}
+
+void AudioRateControl::update(int framesFree)
+{
+	// the buffer size isn't known directly, it's the most ever seen free
+	capacity = std::max(capacity, framesFree);
+	if(!capacity)
+		return;
+	double fill = 1. - framesFree / (double)capacity;
+	// filter out the jitter of each write so the pitch doesn't waver
+	avgFill = avgFill * .95 + fill * .05;
+	// an overfull buffer gets fewer samples, an underfull one more
+	double error = IG::clamp((TARGET_FILL - avgFill) / TARGET_FILL, -1., 1.);
+	ratio_ = 1. + MAX_RATE_DELTA * error;
+}
+
+bool AudioRateControl::prepareResampler(uint channels)
+{
+	if(channels > Audio::Resampler::MAX_CHANNELS)
+		return false;
+	if(!resampler || resampler.channels() != channels)
+	{
+		// input and output share the same nominal rate, only the adjustment varies
+		if(!resampler.init(1., 1., channels, quality))
+			return false;
+	}
+	resampler.setRatioAdjust(ratio_);
+	return true;
+}
+
+AudioRateControl::Samples AudioRateControl::resample(const int16 *samples, uint frames, uint channels)
+{
+	if(!frames || !prepareResampler(channels))
+		return {samples, frames};
+	uint maxOutFrames = resampler.maxOutputFrames(frames);
+	if(outBuff.size() < maxOutFrames * channels)
+		outBuff.resize(maxOutFrames * channels);
+	auto outFrames = resampler.process(samples, frames, outBuff.data(), maxOutFrames);
+	return {outBuff.data(), outFrames};
+}
+
+bool AudioRateControl::resampleToPlayBuffer(const int16 *samples, uint frames, uint channels)
+{
+	if(!frames || !prepareResampler(channels))
+		return false;
+	uint maxOutFrames = resampler.maxOutputFrames(frames);
+	auto buff = Audio::getPlayBuffer(maxOutFrames);
+	if(!buff)
+		return false;
+	auto outFrames = resampler.process(samples, frames, (int16*)buff.data, buff.frames);
+	Audio::commitPlayBuffer(buff, outFrames);
+	if(outFrames == buff.frames && outFrames < maxOutFrames)
+	{
+		// the device buffer wrapped, the rest goes at its start
+		if(auto buff2 = Audio::getPlayBuffer(maxOutFrames - outFrames);
+			buff2)
+		{
+			Audio::commitPlayBuffer(buff2, resampler.process(nullptr, 0, (int16*)buff2.data, buff2.frames));
+		}
+	}
+	return true;
+}
@@ -0,0 +1,251 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "Benchmark"
+#include <emuframework/Benchmark.hh>
+#include <emuframework/EmuApp.hh>
+#include <imagine/util/string.h>
+#include <imagine/util/math/math.hh>
+#include <algorithm>
+#include <cmath>
+#include "private.hh"
+
+void BenchmarkStats::reset(uint expectedFrames)
+{
+	samples.clear();
+	samples.reserve(expectedFrames);
+	sorted.clear();
+	totalNSecs = 0;
+}
+
+void BenchmarkStats::addSample(IG::Time time)
+{
+	auto nSecs = time.nSecs();
+	samples.emplace_back(nSecs);
+	totalNSecs += nSecs;
+	sorted.clear();
+}
+
+const std::vector<uint64_t> &BenchmarkStats::sortedSamples() const
+{
+	if(sorted.size() != samples.size())
+	{
+		sorted = samples;
+		std::sort(sorted.begin(), sorted.end());
+	}
+	return sorted;
+}
+
+IG::Time BenchmarkStats::min() const
+{
+	if(samples.empty())
+		return {};
+	return IG::Time::makeWithNSecs(sortedSamples().front());
+}
+
+IG::Time BenchmarkStats::max() const
+{
+	if(samples.empty())
+		return {};
+	return IG::Time::makeWithNSecs(sortedSamples().back());
+}
+
+IG::Time BenchmarkStats::percentile(double p) const
+{
+	if(samples.empty())
+		return {};
+	auto &s = sortedSamples();
+	// nearest-rank method
+	auto rank = (size_t)std::ceil(p / 100. * s.size());
+	rank = IG::clamp(rank, (size_t)1, s.size());
+	return IG::Time::makeWithNSecs(s[rank - 1]);
+}
+
+double BenchmarkStats::fps() const
+{
+	if(!totalNSecs)
+		return 0;
+	return frames() / (totalNSecs / 1.0e9);
+}
+
+static void replayFrames(BenchmarkStats &stats, InputLog &log, EmuVideo *video, bool renderAudio)
+{
+	if(auto err = log.startReplay();
+		err)
+	{
+		logErr("error starting replay:%s", err->what());
+		return;
+	}
+	stats.reset(log.frames());
+	while(log.replayFrame())
+	{
+		stats.addSample(IG::timeFunc([&](){ EmuSystem::runFrame(video, renderAudio); }));
+	}
+}
+
+static void runFrames(BenchmarkStats &stats, const BenchmarkConfig &conf, EmuVideo *video, bool renderAudio)
+{
+	if(conf.replay)
+	{
+		replayFrames(stats, *conf.replay, video, renderAudio);
+		return;
+	}
+	iterateTimes(conf.warmupFrames, i)
+	{
+		EmuSystem::runFrame(video, renderAudio);
+	}
+	stats.reset(conf.frames);
+	iterateTimes(conf.frames, i)
+	{
+		stats.addSample(IG::timeFunc([&](){ EmuSystem::runFrame(video, renderAudio); }));
+	}
+}
+
+BenchmarkResult runBenchmark(const BenchmarkConfig &conf)
+{
+	BenchmarkResult result{};
+	result.game = EmuSystem::fullGameName();
+	if(!EmuSystem::gameIsRunning())
+	{
+		result.error = "System not running";
+		return result;
+	}
+	// count samples instead of sending them to the audio device
+	EmuSystem::setAudioSink(
+		[&result](const void *, uint frames)
+		{
+			result.audioFrames += frames;
+		});
+	logMsg("starting benchmark of %s, %u warm-up & %u measured frames", result.game.data(), conf.warmupFrames, conf.frames);
+	if(conf.videoRun)
+		runFrames(result.video, conf, &emuVideo, false);
+	if(conf.videoSkippedRun)
+		runFrames(result.videoSkipped, conf, nullptr, false);
+	if(conf.audioRun)
+		runFrames(result.audio, conf, &emuVideo, true);
+	EmuSystem::setAudioSink({});
+	return result;
+}
+
+std::vector<BenchmarkResult> runBenchmarkOnDirectory(const char *path, const BenchmarkConfig &conf)
+{
+	std::vector<BenchmarkResult> results{};
+	std::error_code ec{};
+	std::vector<FS::PathString> gamePaths{};
+	for(auto &entry : FS::directory_iterator{path, ec})
+	{
+		if(entry.type() == FS::file_type::directory)
+			continue;
+		auto name = entry.name();
+		if(!EmuSystem::defaultBenchmarkFsFilter(name) &&
+			!(!EmuSystem::handlesArchiveFiles && EmuApp::hasArchiveExtension(name)))
+			continue;
+		gamePaths.emplace_back(FS::makePathStringPrintf("%s/%s", path, name));
+	}
+	if(ec)
+	{
+		logErr("error reading directory %s: %s", path, ec.message().c_str());
+		return results;
+	}
+	std::sort(gamePaths.begin(), gamePaths.end(),
+		[](const FS::PathString &a, const FS::PathString &b)
+		{
+			return strcmp(a.data(), b.data()) < 0;
+		});
+	for(auto &gamePath : gamePaths)
+	{
+		if(auto err = EmuSystem::loadGameFromPath(gamePath.data(),
+			[](int pos, int max, const char *label){ return true; });
+			err)
+		{
+			BenchmarkResult result{};
+			result.game = FS::basename(gamePath);
+			result.error = err->what();
+			logErr("error loading %s: %s", gamePath.data(), err->what());
+			results.emplace_back(std::move(result));
+			continue;
+		}
+		EmuSystem::prepareAudioVideo();
+		results.emplace_back(runBenchmark(conf));
+		EmuSystem::closeGame(false);
+	}
+	return results;
+}
+
+static void appendJSONString(std::string &json, const char *str)
+{
+	json += '"';
+	for(auto c = str; *c; c++)
+	{
+		switch(*c)
+		{
+			case '"': json += "\\\""; break;
+			case '\\': json += "\\\\"; break;
+			case '\n': json += "\\n"; break;
+			default:
+				if((unsigned char)*c < 0x20)
+					json += string_makePrintf<8>("\\u%04x", *c).data();
+				else
+					json += *c;
+		}
+	}
+	json += '"';
+}
+
+static void appendJSONStats(std::string &json, const char *name, const BenchmarkStats &stats)
+{
+	json += string_makePrintf<64>(",\n      \"%s\": ", name).data();
+	if(!stats)
+	{
+		json += "null";
+		return;
+	}
+	json += string_makePrintf<512>("{\"frames\": %u, \"totalSecs\": %.6f, \"fps\": %.3f, "
+		"\"minMs\": %.4f, \"medianMs\": %.4f, \"p95Ms\": %.4f, \"p99Ms\": %.4f, \"maxMs\": %.4f}",
+		stats.frames(), (double)stats.total(), stats.fps(),
+		(double)stats.min() * 1000., (double)stats.median() * 1000., (double)stats.percentile(95.) * 1000.,
+		(double)stats.percentile(99.) * 1000., (double)stats.max() * 1000.).data();
+}
+
+std::string benchmarkResultsToJSON(const BenchmarkConfig &conf, const BenchmarkResult *result, uint results)
+{
+	std::string json{};
+	json += "{\n  \"system\": ";
+	appendJSONString(json, EmuSystem::shortSystemName());
+	json += string_makePrintf<128>(",\n  \"warmupFrames\": %u,\n  \"frames\": %u,\n  \"replay\": %s,\n  \"results\": [",
+		conf.replay ? 0 : conf.warmupFrames, conf.replay ? conf.replay->frames() : conf.frames,
+		conf.replay ? "true" : "false").data();
+	iterateTimes(results, i)
+	{
+		auto &r = result[i];
+		json += i ? ",\n    {\n      \"game\": " : "\n    {\n      \"game\": ";
+		appendJSONString(json, r.game.data());
+		if(r.error.size())
+		{
+			json += ",\n      \"error\": ";
+			appendJSONString(json, r.error.c_str());
+		}
+		else
+		{
+			appendJSONStats(json, "video", r.video);
+			appendJSONStats(json, "videoSkipped", r.videoSkipped);
+			appendJSONStats(json, "audio", r.audio);
+			json += string_makePrintf<64>(",\n      \"audioFrames\": %llu", (unsigned long long)r.audioFrames).data();
+		}
+		json += "\n    }";
+	}
+	json += "\n  ]\n}\n";
+	return json;
+}
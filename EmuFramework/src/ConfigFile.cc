@@ -170,6 +170,8 @@ static bool readConfig2(IO &io)
 			}
 			bcase CFGKEY_SOUND: optionSound.readFromIO(io, size);
 			bcase CFGKEY_SOUND_RATE: optionSoundRate.readFromIO(io, size);
+			bcase CFGKEY_DYNAMIC_AUDIO_RATE: optionDynamicAudioRate.readFromIO(io, size);
+			bcase CFGKEY_AUDIO_RESAMPLER_QUALITY: optionAudioResamplerQuality.readFromIO(io, size);
 			bcase CFGKEY_TOUCH_CONTROL_ALPHA: optionTouchCtrlAlpha.readFromIO(io, size);
 			#ifdef CONFIG_VCONTROLS_GAMEPAD
 			bcase CFGKEY_TOUCH_CONTROL_DISPLAY: optionTouchCtrl.readFromIO(io, size);
@@ -195,6 +197,11 @@ static bool readConfig2(IO &io)
 			bcase CFGKEY_FRAME_INTERVAL: optionFrameInterval.readFromIO(io, size);
 			#endif
 			bcase CFGKEY_SKIP_LATE_FRAMES: optionSkipLateFrames.readFromIO(io, size);
+			bcase CFGKEY_EMULATE_IN_THREAD: optionEmulateInThread.readFromIO(io, size);
+			bcase CFGKEY_SHOW_FRAME_TIMING: optionShowFrameTiming.readFromIO(io, size);
+			bcase CFGKEY_REWIND_MEMORY: optionRewindMemory.readFromIO(io, size);
+			bcase CFGKEY_REWIND_INTERVAL: optionRewindInterval.readFromIO(io, size);
+			bcase CFGKEY_RUN_AHEAD_FRAMES: optionRunAheadFrames.readFromIO(io, size);
 			bcase CFGKEY_FRAME_RATE: optionFrameRate.readFromIO(io, size);
 			bcase CFGKEY_FRAME_RATE_PAL: optionFrameRatePAL.readFromIO(io, size);
 			#if defined(CONFIG_BASE_ANDROID)
@@ -419,6 +426,8 @@ static OptionBase *cfgFileOption[] =
 	&optionConfirmAutoLoadState,
 	&optionSound,
 	&optionSoundRate,
+	&optionDynamicAudioRate,
+	&optionAudioResamplerQuality,
 	&optionAspectRatio,
 	&optionImageZoom,
 	&optionViewportZoom,
@@ -471,6 +480,11 @@ static OptionBase *cfgFileOption[] =
 	&optionFrameInterval,
 	#endif
 	&optionSkipLateFrames,
+	&optionEmulateInThread,
+	&optionShowFrameTiming,
+	&optionRewindMemory,
+	&optionRewindInterval,
+	&optionRunAheadFrames,
 	&optionFrameRate,
 	&optionFrameRatePAL,
 	&optionVibrateOnPush,
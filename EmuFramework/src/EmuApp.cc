@@ -21,9 +21,11 @@
 #include <emuframework/EmuView.hh>
 #include <emuframework/EmuLoadProgressView.hh>
 #include <emuframework/FileUtils.hh>
+#include <emuframework/Benchmark.hh>
 #include <imagine/gui/AlertView.hh>
 #include <imagine/util/utility.h>
 #include <imagine/util/ScopeGuard.hh>
+#include <imagine/util/string.h>
 #include <imagine/base/Pipe.hh>
 #include <imagine/thread/Thread.hh>
 #include <cmath>
@@ -219,6 +221,7 @@ static Gfx::PixmapTexture *getCollectTextCloseAsset(Gfx::Renderer &r)
 
 void postDrawToEmuWindows()
 {
+	frameTelemetry.markDrawPosted();
 	emuWin->win.postDraw();
 }
 
@@ -230,7 +233,11 @@ static void drawEmuVideo(Gfx::Renderer &r)
 		emuView2.draw();
 	popup.draw();
 	r.setClipRect(false);
-	r.presentDrawable(emuWin->drawable);
+	{
+		IG_TRACE_SPAN("presentDrawable");
+		r.presentDrawable(emuWin->drawable);
+	}
+	frameTelemetry.markPresented();
 }
 
 void updateAndDrawEmuVideo()
@@ -288,11 +295,16 @@ static void startEmulation()
 {
 	setCPUNeedsLowLatency(true);
 	EmuSystem::start();
+	rewindManager.setMemoryLimit(optionRewindMemory * 1024 * 1024);
+	rewindManager.setInterval(optionRewindInterval);
+	if(optionEmulateInThread)
+		startEmulationThread();
 	emuWin->win.screen()->addOnFrameOnce(onFrameUpdate);
 }
 
 static void pauseEmulation()
 {
+	stopEmulationThread();
 	EmuSystem::pause();
 	emuWin->win.screen()->removeOnFrame(onFrameUpdate);
 	setCPUNeedsLowLatency(false);
@@ -307,6 +319,7 @@ static void suspendEmulation()
 
 void closeGame(bool allowAutosaveState)
 {
+	stopEmulationThread();
 	EmuSystem::closeGame(allowAutosaveState);
 	emuWin->win.screen()->removeOnFrame(onFrameUpdate);
 	setCPUNeedsLowLatency(false);
@@ -325,11 +338,17 @@ void EmuApp::exitGame(bool allowAutosaveState)
 
 static void drawEmuFrame(Gfx::Renderer &r)
 {
-	if(EmuSystem::runFrameOnDraw)
+	if(emuVideo.uploadQueuedFrame() || emulationThreadIsActive())
+	{
+		// frame was produced by the emulation thread
+		drawEmuVideo(r);
+	}
+	else if(EmuSystem::runFrameOnDraw)
 	{
-		bool renderAudio = optionSound;
+		bool renderAudio = optionSound && !rewindActive;
 		emuVideo.renderNextFrameToApp();
-		EmuSystem::runFrame(&emuVideo, renderAudio);
+		auto time = IG::timeFunc([&](){ runFrameWithRunAhead(&emuVideo, renderAudio); });
+		frameTelemetry.addRunFrameTime(time);
 		EmuSystem::runFrameOnDraw = false;
 	}
 	else
@@ -338,6 +357,18 @@ static void drawEmuFrame(Gfx::Renderer &r)
 	}
 }
 
+static uint maxFrameSkip()
+{
+	constexpr uint maxLateFrameSkip = 6;
+	uint maxFrameSkip = optionSkipLateFrames ? maxLateFrameSkip : 0;
+	#if defined CONFIG_BASE_SCREEN_FRAME_INTERVAL
+	if(!optionSkipLateFrames)
+		maxFrameSkip = optionFrameInterval - 1;
+	#endif
+	assumeExpr(maxFrameSkip <= maxLateFrameSkip);
+	return maxFrameSkip;
+}
+
 static bool allWindowsAreFocused()
 {
 	return mainWin.focused && (!extraWin.win || extraWin.focused);
@@ -560,12 +591,24 @@ void EmuApp::showExitAlert(ViewAttachParams attach, Input::Event e)
 
 static const char *parseCmdLineArgs(int argc, char** argv)
 {
-	if(argc < 2)
+	const char *launchGame{};
+	for(int i = 1; i < argc; i++)
 	{
-		return nullptr;
+		if(string_equal(argv[i], "--trace"))
+		{
+			if(Trace::isSupported)
+			{
+				logMsg("recording trace spans");
+				Trace::setEnabled(true);
+			}
+			else
+				logWarn("--trace needs a build with imagineTrace := 1");
+		}
+		else if(!launchGame)
+			launchGame = argv[i];
 	}
-	auto launchGame = argv[1];
-	logMsg("starting game from command line: %s", launchGame);
+	if(launchGame)
+		logMsg("starting game from command line: %s", launchGame);
 	return launchGame;
 }
 
@@ -583,6 +626,7 @@ void mainInitCommon(int argc, char** argv)
 	initOptions();
 	auto launchGame = parseCmdLineArgs(argc, argv);
 	loadConfigFile();
+	frameTelemetry.setEnabled(optionShowFrameTiming);
 	if(auto err = EmuSystem::onOptionsLoaded();
 		err)
 	{
@@ -744,6 +788,7 @@ void mainInitCommon(int argc, char** argv)
 				closeGame();
 			}
 
+			saveFileWriter.flush();
 			saveConfigFile();
 
 			#ifdef CONFIG_BLUETOOTH
@@ -755,6 +800,13 @@ void mainInitCommon(int argc, char** argv)
 			extraWin.drawable.freeCaches();
 			renderer.finish();
 
+			if(Trace::isEnabled())
+			{
+				Trace::writeJSON(FS::makePathStringPrintf("%s/trace.json", EmuApp::supportPath().data()).data());
+				if(!backgrounded)
+					Trace::deinit();
+			}
+
 			#ifdef CONFIG_BASE_IOS
 			//if(backgrounded)
 			//	FsSys::remove("/private/var/mobile/Library/Caches/" CONFIG_APP_ID "/com.apple.opengl/shaders.maps");
@@ -816,10 +868,48 @@ void mainInitCommon(int argc, char** argv)
 	onFrameUpdate = [](Base::Screen::FrameParams params)
 		{
 			commonUpdateInput();
-			if(unlikely(fastForwardActive))
+			frameTelemetry.commitFrame();
+			// input is timed against the monotonic clock, which frame timestamps may not share
+			auto batchTime = IG::Time::now();
+			if(unlikely(rewindActive))
+			{
+				// step back one snapshot per screen refresh
+				{
+					auto lock = lockEmulationThread();
+					inputLog.stopRecording(); // the log can't follow the game backwards
+					rewindManager.rewind();
+				}
+				EmuSystem::resetFrameTime();
+				if(emulationThreadIsActive())
+				{
+					// like the single-threaded path, rewound frames play no audio
+					postFramesToEmulationThread(1, 0, true, batchTime, true);
+				}
+				else
+				{
+					EmuSystem::runFrameOnDraw = true;
+					postDrawToEmuWindows();
+				}
+			}
+			else if(emulationThreadIsActive())
+			{
+				if(unlikely(fastForwardActive))
+				{
+					uint skip = optionFastForwardSpeed;
+					postFramesToEmulationThread(skip + 1, skip, true, batchTime);
+				}
+				else if(uint frames = EmuSystem::advanceFramesWithTime(params.timestamp());
+					frames)
+				{
+					frameTelemetry.addSkippedFrames(frames - 1);
+					postFramesToEmulationThread(frames, maxFrameSkip(), false, batchTime);
+				}
+			}
+			else if(unlikely(fastForwardActive))
 			{
 				EmuSystem::runFrameOnDraw = true;
 				postDrawToEmuWindows();
+				rewindManager.onFramesRun(optionFastForwardSpeed + 1);
 				EmuSystem::skipFrames((uint)optionFastForwardSpeed);
 			}
 			else
@@ -828,24 +918,27 @@ void mainInitCommon(int argc, char** argv)
 				//logDMsg("%d frames elapsed (%fs)", frames, Base::frameTimeBaseToSecsDec(params.frameTimeDiff()));
 				if(frames)
 				{
+					frameTelemetry.addSkippedFrames(frames - 1);
+					rewindManager.onFramesRun(frames);
 					EmuSystem::runFrameOnDraw = true;
 					postDrawToEmuWindows();
-					constexpr uint maxLateFrameSkip = 6;
-					uint maxFrameSkip = optionSkipLateFrames ? maxLateFrameSkip : 0;
-					#if defined CONFIG_BASE_SCREEN_FRAME_INTERVAL
-					if(!optionSkipLateFrames)
-						maxFrameSkip = optionFrameInterval - 1;
-					#endif
-					assumeExpr(maxFrameSkip <= maxLateFrameSkip);
-					if(frames > 1 && maxFrameSkip)
+					uint maxSkip = maxFrameSkip();
+					if(frames > 1 && maxSkip)
 					{
 						uint framesToSkip = frames - 1;
-						framesToSkip = std::min(framesToSkip, maxFrameSkip);
+						framesToSkip = std::min(framesToSkip, maxSkip);
 						bool renderAudio = optionSound;
-						iterateTimes(framesToSkip, i)
-						{
-							EmuSystem::runFrame(nullptr, renderAudio);
-						}
+						auto time = IG::timeFunc(
+							[&]()
+							{
+								iterateTimes(framesToSkip, i)
+								{
+									inputQueue.applyForFrame(batchTime, framesToSkip - i);
+									EmuSystem::runFrame(nullptr, renderAudio);
+									inputLog.addFrames(1);
+								}
+							});
+						frameTelemetry.addRunFrameTime(time);
 					}
 				}
 			}
@@ -1142,11 +1235,37 @@ void onSelectFileFromPicker(Gfx::Renderer &r, const char* name, Input::Event e)
 
 void runBenchmarkOneShot()
 {
-	logMsg("starting benchmark");
-	IG::Time time = EmuSystem::benchmark();
+	BenchmarkConfig conf{};
+	conf.videoSkippedRun = conf.audioRun = false;
+	auto result = runBenchmark(conf);
 	EmuSystem::closeGame(false);
-	logMsg("done in: %f", double(time));
-	popup.printf(2, 0, "%.2f fps", double(180.)/double(time));
+	logMsg("%s", benchmarkResultsToJSON(conf, &result, 1).c_str());
+	popup.printf(4, 0, "%.2f fps\nmedian %.2fms, 99%% %.2fms, max %.2fms",
+		result.video.fps(), double(result.video.median()) * 1000.,
+		double(result.video.percentile(99.)) * 1000., double(result.video.max()) * 1000.);
+}
+
+void runBenchmarkOnDirectoryOneShot(const char *path)
+{
+	if(EmuSystem::gameIsRunning())
+		closeGame();
+	BenchmarkConfig conf{};
+	auto results = runBenchmarkOnDirectory(path, conf);
+	if(!results.size())
+	{
+		popup.postError("No games found to benchmark");
+		return;
+	}
+	auto outPath = FS::makePathStringPrintf("%s/benchmark.json", path);
+	auto json = benchmarkResultsToJSON(conf, results.data(), results.size());
+	if(auto ec = writeToNewFile(outPath.data(), json.data(), json.size());
+		ec)
+	{
+		logMsg("%s", json.c_str());
+		popup.printf(4, true, "Error writing %s: %s", outPath.data(), ec.message().c_str());
+		return;
+	}
+	popup.printf(4, 0, "Benchmarked %u games, results in:\n%s", (uint)results.size(), outPath.data());
 }
 
 void EmuApp::launchSystemWithResumePrompt(Gfx::Renderer &r, Input::Event e, bool addToRecent)
@@ -1329,6 +1448,8 @@ void EmuApp::createSystemWithMedia(GenericIO io, const char *path, const char *n
 		[ioPtr, pathStr, fileStr, loadProgressView]()
 		{
 			logMsg("starting loader thread");
+			IG_TRACE_THREAD_NAME("Loader");
+			IG_TRACE_SPAN("EmuSystem::createWithMedia");
 			GenericIO io{std::unique_ptr<IO>(ioPtr)};
 			EmuSystem::Error err;
 			EmuSystem::createWithMedia(std::move(io), pathStr.data(), fileStr.data(), err,
@@ -1364,9 +1485,23 @@ void EmuApp::saveAutoState()
 {
 	if(optionAutoSaveState)
 	{
+		if(!EmuSystem::gameIsRunning())
+			return;
 		auto saveStr = EmuSystem::sprintStateFilename(-1);
 		//logMsg("saving autosave-state %s", saveStr.data());
-		saveState(saveStr.data());
+		fixFilePermissions(saveStr.data());
+		// only the snapshot holds up emulation, the file is written in the background
+		StateBuffer buff;
+		{
+			auto lock = lockEmulationThread();
+			if(auto err = saveStateFileToBuffer(buff);
+				err)
+			{
+				logErr("error saving autosave-state:%s", err->what());
+				return;
+			}
+		}
+		saveFileWriter.write(saveStr.data(), std::move(buff));
 	}
 }
 
@@ -1392,6 +1527,9 @@ EmuSystem::Error EmuApp::saveState(const char *path)
 	}
 	fixFilePermissions(path);
 	logMsg("saving state %s", path);
+	// a pending auto-save of the same file mustn't land after this one
+	saveFileWriter.flush();
+	auto lock = lockEmulationThread();
 	return EmuSystem::saveState(path);
 }
 
@@ -1407,12 +1545,15 @@ EmuSystem::Error EmuApp::loadState(const char *path)
 	{
 		return EmuSystem::makeError("System not running");
 	}
+	saveFileWriter.flush();
 	if(!FS::exists(path))
 	{
 		return EmuSystem::makeError("File doesn't exist");
 	}
 	fixFilePermissions(path);
 	logMsg("loading state %s", path);
+	auto lock = lockEmulationThread();
+	inputLog.stopRecording();
 	return EmuSystem::loadState(path);
 }
 
@@ -1502,12 +1643,17 @@ namespace Base
 
 void onInit(int argc, char** argv)
 {
+	IG_TRACE_THREAD_NAME("Main");
 	if(auto err = EmuSystem::onInit();
 		err)
 	{
 		Base::exitWithErrorMessagePrintf(-1, "%s", err->what());
 		return;
 	}
+	if(isHeadlessLaunch(argc, argv))
+	{
+		::exit(runHeadless(argc, argv));
+	}
 	mainInitCommon(argc, argv);
 }
 
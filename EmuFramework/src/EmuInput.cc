@@ -41,6 +41,7 @@ bool touchControlsAreOn = false;
 VControllerLayoutPosition vControllerLayoutPos[2][7];
 bool vControllerLayoutPosChanged = false;
 bool fastForwardActive = false;
+bool rewindActive = false;
 
 #ifdef CONFIG_VCONTROLS_GAMEPAD
 static Gfx::GC vControllerGCSize()
@@ -197,7 +198,7 @@ void processRelPtr(Input::Event e)
 	{
 		//logMsg("reversed trackball X direction");
 		relPtr.x = e.pos().x;
-		EmuSystem::handleInputAction(Input::RELEASED, relPtr.xAction);
+		inputQueue.push(e.time(), Input::RELEASED, relPtr.xAction);
 	}
 	else
 		relPtr.x += e.pos().x;
@@ -205,14 +206,14 @@ void processRelPtr(Input::Event e)
 	if(e.pos().x)
 	{
 		relPtr.xAction = EmuSystem::translateInputAction(e.pos().x > 0 ? EmuControls::systemKeyMapStart+1 : EmuControls::systemKeyMapStart+3);
-		EmuSystem::handleInputAction(Input::PUSHED, relPtr.xAction);
+		inputQueue.push(e.time(), Input::PUSHED, relPtr.xAction);
 	}
 
 	if(relPtr.y != 0 && sign(relPtr.y) != sign(e.pos().y))
 	{
 		//logMsg("reversed trackball Y direction");
 		relPtr.y = e.pos().y;
-		EmuSystem::handleInputAction(Input::RELEASED, relPtr.yAction);
+		inputQueue.push(e.time(), Input::RELEASED, relPtr.yAction);
 	}
 	else
 		relPtr.y += e.pos().y;
@@ -220,7 +221,7 @@ void processRelPtr(Input::Event e)
 	if(e.pos().y)
 	{
 		relPtr.yAction = EmuSystem::translateInputAction(e.pos().y > 0 ? EmuControls::systemKeyMapStart+2 : EmuControls::systemKeyMapStart);
-		EmuSystem::handleInputAction(Input::PUSHED, relPtr.yAction);
+		inputQueue.push(e.time(), Input::PUSHED, relPtr.yAction);
 	}
 
 	//logMsg("trackball event %d,%d, rel ptr %d,%d", e.x, e.y, relPtr.x, relPtr.y);
@@ -231,6 +232,7 @@ void commonInitInput()
 	relPtr = {};
 	turboActions = {};
 	fastForwardActive = false;
+	rewindActive = false;
 }
 
 void commonUpdateInput()
@@ -246,12 +248,12 @@ void commonUpdateInput()
 			if(turboClock == 0)
 			{
 				//logMsg("turbo push for player %d, action %d", e.player, e.action);
-				EmuSystem::handleInputAction(Input::PUSHED, e.action);
+				inputQueue.push(IG::Time::now(), Input::PUSHED, e.action);
 			}
 			else if(turboClock == turboFrames/2)
 			{
 				//logMsg("turbo release for player %d, action %d", e.player, e.action);
-				EmuSystem::handleInputAction(Input::RELEASED, e.action);
+				inputQueue.push(IG::Time::now(), Input::RELEASED, e.action);
 			}
 		}
 	}
@@ -269,13 +271,13 @@ void commonUpdateInput()
 	{
 		relPtr.x = applyRelPointerDecel(relPtr.x);
 		if(!relPtr.x)
-			EmuSystem::handleInputAction(Input::RELEASED, relPtr.xAction);
+			inputQueue.push(IG::Time::now(), Input::RELEASED, relPtr.xAction);
 	}
 	if(relPtr.y)
 	{
 		relPtr.y = applyRelPointerDecel(relPtr.y);
 		if(!relPtr.y)
-			EmuSystem::handleInputAction(Input::RELEASED, relPtr.yAction);
+			inputQueue.push(IG::Time::now(), Input::RELEASED, relPtr.yAction);
 	}
 #endif
 }
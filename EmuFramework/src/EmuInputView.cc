@@ -43,6 +43,7 @@ void EmuInputView::resetInput()
 	vController.resetInput();
 	#endif
 	ffKeyPushed = ffToggleActive = false;
+	rewindActive = false;
 }
 
 void EmuInputView::updateFastforward()
@@ -127,6 +128,17 @@ bool EmuInputView::inputEvent(Input::Event e)
 						logMsg("fast-forward key state: %d", ffKeyPushed);
 					}
 
+					bcase guiKeyIdxRewind:
+					{
+						if(e.pushed() && !rewindManager.isEnabled())
+						{
+							popup.post("Rewind history is off in System Options");
+							return true;
+						}
+						rewindActive = e.pushed();
+						logMsg("rewind key state: %d", rewindActive);
+					}
+
 					bcase guiKeyIdxLoadGame:
 					if(e.pushed())
 					{
@@ -249,7 +261,7 @@ bool EmuInputView::inputEvent(Input::Event e)
 								turboActions.removeEvent(sysAction);
 							}
 						}
-						EmuSystem::handleInputAction(e.state(), sysAction);
+						inputQueue.push(e.time(), e.state(), sysAction);
 					}
 				}
 			}
@@ -213,6 +213,7 @@ void EmuMainMenuView::loadStandardItems()
 	}
 	#endif
 	item.emplace_back(&benchmark);
+	item.emplace_back(&benchmarkDir);
 	item.emplace_back(&about);
 	item.emplace_back(&exitApp);
 }
@@ -294,6 +295,14 @@ EmuMainMenuView::EmuMainMenuView(ViewAttachParams attach, bool customMenu):
 			modalViewController.pushAndShow(*EmuFilePicker::makeForBenchmarking(attachParams(), e), e, false);
 		}
 	},
+	benchmarkDir
+	{
+		"Benchmark Directory",
+		[this](TextMenuItem &, View &, Input::Event e)
+		{
+			modalViewController.pushAndShow(*EmuFilePicker::makeForBenchmarking(attachParams(), e, false, true), e, false);
+		}
+	},
 	#ifdef CONFIG_BLUETOOTH
 	scanWiimotes
 	{
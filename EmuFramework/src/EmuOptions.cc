@@ -48,6 +48,8 @@ bool optionOrientationIsValid(uint32 val)
 Byte1Option optionAutoSaveState(CFGKEY_AUTO_SAVE_STATE, 1);
 Byte1Option optionConfirmAutoLoadState(CFGKEY_CONFIRM_AUTO_LOAD_STATE, 1);
 Byte1Option optionSound(CFGKEY_SOUND, 1);
+Byte1Option optionDynamicAudioRate(CFGKEY_DYNAMIC_AUDIO_RATE, 1);
+Byte1Option optionAudioResamplerQuality{CFGKEY_AUDIO_RESAMPLER_QUALITY, 1, 0, optionIsValidWithMax<2>};
 
 #ifdef CONFIG_AUDIO_LATENCY_HINT
 Byte1Option optionSoundBuffers(CFGKEY_SOUND_BUFFERS,
@@ -208,6 +210,11 @@ Byte1Option optionFrameInterval
 	{CFGKEY_FRAME_INTERVAL,	1, !Config::envIsIOS, optionIsValidWithMinMax<1, 4>};
 #endif
 Byte1Option optionSkipLateFrames{CFGKEY_SKIP_LATE_FRAMES, 1, 0};
+Byte1Option optionEmulateInThread{CFGKEY_EMULATE_IN_THREAD, 0, 0};
+Byte1Option optionShowFrameTiming{CFGKEY_SHOW_FRAME_TIMING, 0, 0};
+Byte1Option optionRewindMemory{CFGKEY_REWIND_MEMORY, 0, 0, optionIsValidWithMax<128>};
+Byte1Option optionRewindInterval{CFGKEY_REWIND_INTERVAL, 2, 0, optionIsValidWithMinMax<1, 8>};
+Byte1Option optionRunAheadFrames{CFGKEY_RUN_AHEAD_FRAMES, 0, 0, optionIsValidWithMax<4>};
 DoubleOption optionFrameRate{CFGKEY_FRAME_RATE, 0, 0, optionFrameTimeIsValid};
 DoubleOption optionFrameRatePAL{CFGKEY_FRAME_RATE_PAL, 1./50., !EmuSystem::hasPALVideoSystem, optionFrameTimePALIsValid};
 
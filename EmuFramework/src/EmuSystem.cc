@@ -18,6 +18,7 @@
 #include <emuframework/EmuApp.hh>
 #include <emuframework/FileUtils.hh>
 #include <emuframework/FilePicker.hh>
+#include <emuframework/AudioRateControl.hh>
 #include <imagine/fs/ArchiveFS.hh>
 #include <imagine/audio/Audio.hh>
 #include <imagine/util/utility.h>
@@ -25,6 +26,9 @@
 #include <imagine/util/ScopeGuard.hh>
 #include <algorithm>
 #include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/syscall.h>
 #include "private.hh"
 
 EmuSystem::State EmuSystem::state = EmuSystem::State::OFF;
@@ -44,6 +48,7 @@ int EmuSystem::saveStateSlot = 0;
 Audio::PcmFormat EmuSystem::pcmFormat = {44100, Audio::SampleFormats::s16, 2};
 uint EmuSystem::audioFramesPerVideoFrame = 0;
 Base::Timer EmuSystem::autoSaveStateTimer;
+EmuSystem::AudioSinkDelegate EmuSystem::audioSink{};
 [[gnu::weak]] bool EmuSystem::inputHasKeyboard = false;
 [[gnu::weak]] bool EmuSystem::inputHasOptionsView = false;
 [[gnu::weak]] bool EmuSystem::hasBundledGames = false;
@@ -58,6 +63,20 @@ double EmuSystem::frameTimePAL = 1./50.;
 [[gnu::weak]] int EmuSystem::forcedSoundRate = 0;
 [[gnu::weak]] bool EmuSystem::constFrameRate = false;
 
+static AudioRateControl audioRateControl{};
+
+// frames free in the output buffer when playback should begin
+static int playbackStartFramesFree()
+{
+	int framesFree = EmuSystem::audioFramesPerVideoFrame;
+	if(optionDynamicAudioRate)
+	{
+		// start at the fill level the rate control aims for
+		framesFree = std::max(framesFree, audioRateControl.targetFramesFree());
+	}
+	return framesFree;
+}
+
 void EmuSystem::cancelAutoSaveStateTimer()
 {
 	autoSaveStateTimer.deinit();
@@ -90,8 +109,10 @@ void EmuSystem::startSound()
 			Audio::setHintOutputLatency(wantedLatency);
 			#endif
 			Audio::openPcm(pcmFormat);
+			audioRateControl.setQuality((Audio::Resampler::Quality)optionAudioResamplerQuality.val);
+			audioRateControl.reset();
 		}
-		else if(Audio::framesFree() <= (int)audioFramesPerVideoFrame)
+		else if(Audio::framesFree() <= playbackStartFramesFree())
 			Audio::resumePcm();
 	}
 }
@@ -107,14 +128,38 @@ void EmuSystem::stopSound()
 
 void EmuSystem::writeSound(const void *samples, uint framesToWrite)
 {
-	Audio::writePcm(samples, framesToWrite);
-	if(!Audio::isPlaying() && Audio::framesFree() <= (int)audioFramesPerVideoFrame)
+	if(unlikely(audioSink))
+	{
+		audioSink(samples, framesToWrite);
+		return;
+	}
+	if(optionDynamicAudioRate && pcmFormat.sample.toBits() == 16)
+	{
+		audioRateControl.update(Audio::framesFree());
+		if(!audioRateControl.resampleToPlayBuffer((const int16*)samples, framesToWrite, pcmFormat.channels))
+		{
+			auto resampled = audioRateControl.resample((const int16*)samples, framesToWrite, pcmFormat.channels);
+			Audio::writePcm(resampled.data, resampled.frames);
+		}
+	}
+	else
+	{
+		Audio::writePcm(samples, framesToWrite);
+	}
+	if(frameTelemetry.isEnabled())
+		frameTelemetry.setAudioFramesFree(Audio::framesFree());
+	if(!Audio::isPlaying() && Audio::framesFree() <= playbackStartFramesFree())
 	{
 		logMsg("starting audio playback with %d frames free in buffer", Audio::framesFree());
 		Audio::resumePcm();
 	}
 }
 
+void EmuSystem::setAudioSink(AudioSinkDelegate sink)
+{
+	audioSink = sink;
+}
+
 bool EmuSystem::stateExists(int slot)
 {
 	auto saveStr = sprintStateFilename(slot);
@@ -321,8 +366,13 @@ void EmuSystem::closeGame(bool allowAutosaveState)
 			EmuApp::saveAutoState();
 		logMsg("closing game %s", gameName_.data());
 		closeSystem();
+		rewindManager.deinit();
+		resetRunAhead();
+		inputQueue.clear();
+		inputLog.stopRecording();
 		cancelAutoSaveStateTimer();
-		viewStack.navView()->showRightBtn(false);
+		if(viewStack.navView())
+			viewStack.navView()->showRightBtn(false);
 		state = State::OFF;
 	}
 	clearGamePaths();
@@ -350,17 +400,6 @@ void EmuSystem::start()
 	startAutoSaveStateTimer();
 }
 
-IG::Time EmuSystem::benchmark()
-{
-	auto now = IG::Time::now();
-	iterateTimes(180, i)
-	{
-		runFrame(&emuVideo, false);
-	}
-	auto after = IG::Time::now();
-	return after-now;
-}
-
 void EmuSystem::skipFrames(uint frames)
 {
 	if(!gameIsRunning())
@@ -369,6 +408,7 @@ void EmuSystem::skipFrames(uint frames)
 	{
 		runFrame(nullptr, false);
 	}
+	inputLog.addFrames(frames);
 }
 
 void EmuSystem::configFrameTime()
@@ -458,6 +498,8 @@ static void closeAndSetupNew(const char *path)
 
 void EmuSystem::createWithMedia(GenericIO io, const char *path, const char *name, Error &err, OnLoadProgressDelegate onLoadProgress)
 {
+	// the previous game's saves may still be in flight
+	saveFileWriter.flush();
 	if(io)
 		err = loadGameFromFile(std::move(io), name, onLoadProgress);
 	else
@@ -622,3 +664,69 @@ char EmuSystem::saveSlotCharUpper(int slot)
 {
 	return fullGameNameForPathDefaultImpl(path);
 }
+
+// Generic in-memory states for cores whose state code only writes to files,
+// the core's file based functions are pointed at an anonymous memory file
+// when the OS supports it so nothing touches the disk.
+
+static int stateMemFd = -1;
+static FS::PathString stateMemPath{};
+
+static bool openStateMemFile()
+{
+	if(stateMemFd != -1)
+		return true;
+	#if defined __linux__ && defined SYS_memfd_create
+	stateMemFd = syscall(SYS_memfd_create, "EmuState", 0);
+	if(stateMemFd != -1)
+	{
+		stateMemPath = FS::makePathStringPrintf("/proc/self/fd/%d", stateMemFd);
+		logMsg("using memory file for in-memory states");
+		return true;
+	}
+	#endif
+	stateMemPath = FS::makePathStringPrintf("%s/memState.tmp", Base::cachePath(appName()).data());
+	stateMemFd = open(stateMemPath.data(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+	if(stateMemFd == -1)
+	{
+		logErr("error creating state file:%s", stateMemPath.data());
+		return false;
+	}
+	logMsg("using file:%s for in-memory states", stateMemPath.data());
+	return true;
+}
+
+EmuSystem::Error saveStateFileToBuffer(StateBuffer &buff)
+{
+	if(!openStateMemFile())
+		return EmuSystem::makeFileWriteError();
+	if(auto err = EmuSystem::saveState(stateMemPath.data());
+		err)
+	{
+		return err;
+	}
+	auto size = lseek(stateMemFd, 0, SEEK_END);
+	if(size < 0)
+		return EmuSystem::makeFileReadError();
+	buff.resize(size);
+	if(pread(stateMemFd, buff.data(), size, 0) != size)
+		return EmuSystem::makeFileReadError();
+	return {};
+}
+
+[[gnu::weak]] EmuSystem::Error EmuSystem::saveStateToBuffer(StateBuffer &buff)
+{
+	return saveStateFileToBuffer(buff);
+}
+
+[[gnu::weak]] EmuSystem::Error EmuSystem::loadStateFromBuffer(const StateBuffer &buff)
+{
+	if(!openStateMemFile())
+		return makeFileReadError();
+	if(ftruncate(stateMemFd, 0) == -1 ||
+		pwrite(stateMemFd, buff.data(), buff.size(), 0) != (ssize_t)buff.size())
+	{
+		return makeFileWriteError();
+	}
+	return loadState(stateMemPath.data());
+}
@@ -92,6 +92,10 @@ void EmuSystemActionsView::onShow()
 	stateSlotText[12] = EmuSystem::saveSlotChar(EmuSystem::saveStateSlot);
 	stateSlot.compile(renderer(), projP);
 	screenshot.setActive(EmuSystem::gameIsRunning());
+	inputRecording.setActive(EmuSystem::gameIsRunning());
+	inputRecording.t.setString(inputLog.isRecording() ? "Stop Input Recording" : "Start Input Recording");
+	inputRecording.compile(renderer(), projP);
+	frameTimingLog.setActive(frameTelemetry.samples());
 	#if defined CONFIG_BASE_ANDROID && !defined CONFIG_MACHINE_OUYA
 	addLauncherIcon.setActive(EmuSystem::gameIsRunning());
 	#endif
@@ -113,6 +117,11 @@ void EmuSystemActionsView::loadStandardItems()
 	item.emplace_back(&addLauncherIcon);
 	#endif
 	item.emplace_back(&screenshot);
+	item.emplace_back(&inputRecording);
+	if(frameTelemetry.isEnabled())
+	{
+		item.emplace_back(&frameTimingLog);
+	}
 	item.emplace_back(&close);
 }
 
@@ -270,7 +279,70 @@ EmuSystemActionsView::EmuSystemActionsView(ViewAttachParams attach, bool customM
 			{
 				emuVideo.takeGameScreenshot();
 				EmuSystem::runFrame(&emuVideo, false);
+				inputLog.addFrames(1);
+			}
+		}
+	},
+	inputRecording
+	{
+		"Start Input Recording",
+		[this]()
+		{
+			if(!EmuSystem::gameIsRunning())
+				return;
+			if(!inputLog.isRecording())
+			{
+				auto lock = lockEmulationThread();
+				if(auto err = inputLog.startRecording();
+					err)
+				{
+					popup.printf(4, true, "Can't record input: %s", err->what());
+					return;
+				}
+				popup.post("Recording input from current state");
+			}
+			else
+			{
+				{
+					auto lock = lockEmulationThread();
+					inputLog.stopRecording();
+				}
+				auto path = FS::makePathStringPrintf("%s/%s.inputlog", EmuSystem::savePath(), EmuSystem::gameName().data());
+				if(auto ec = inputLog.writeFile(path.data());
+					ec)
+				{
+					popup.post("Error writing input log: ", ec);
+					return;
+				}
+				popup.printf(3, false, "Wrote %u frames to %s", inputLog.frames(), path.data());
+			}
+			onShow();
+			postDraw();
+		}
+	},
+	frameTimingLog
+	{
+		"Save Frame Timing Log",
+		[]()
+		{
+			if(!frameTelemetry.samples())
+				return;
+			FS::PathString csvPath{}, jsonPath{};
+			string_printf(csvPath, "%s/frameTiming.csv", EmuSystem::savePath());
+			string_printf(jsonPath, "%s/frameTiming.json", EmuSystem::savePath());
+			if(auto ec = frameTelemetry.writeCSV(csvPath.data());
+				ec)
+			{
+				popup.post("Error writing log: ", ec);
+				return;
+			}
+			if(auto ec = frameTelemetry.writeJSON(jsonPath.data());
+				ec)
+			{
+				popup.post("Error writing log: ", ec);
+				return;
 			}
+			popup.printf(3, false, "Wrote %u frames to %s", frameTelemetry.samples(), EmuSystem::savePath());
 		}
 	},
 	close
@@ -0,0 +1,140 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "EmuThread"
+#include <emuframework/EmuSystem.hh>
+#include <emuframework/EmuOptions.hh>
+#include <imagine/thread/Thread.hh>
+#include <imagine/thread/Semaphore.hh>
+#include <imagine/base/Pipe.hh>
+#include <atomic>
+#include "private.hh"
+
+static IG::Semaphore frameRequestSem{0}, threadExitSem{0};
+static std::mutex frameMutex{};
+static Base::Pipe frameReadyPipe{};
+static std::atomic_uint pendingFrames{};
+static std::atomic_uint pendingMaxFrameSkip{};
+static std::atomic_bool pendingFastForward{};
+static std::atomic_bool pendingMuteAudio{};
+static std::atomic<uint64_t> pendingBatchNSecs{};
+static std::atomic_bool quitThread{};
+static bool threadActive = false;
+
+static void runRequestedFrames()
+{
+	uint frames = pendingFrames.exchange(0, std::memory_order_acquire);
+	if(!frames)
+		return;
+	IG_TRACE_SPAN("runRequestedFrames");
+	uint maxFrameSkip = pendingMaxFrameSkip.load(std::memory_order_relaxed);
+	bool renderAudio = optionSound && !pendingMuteAudio.load(std::memory_order_relaxed);
+	bool renderSkippedAudio = renderAudio && !pendingFastForward.load(std::memory_order_relaxed);
+	auto batchTime = IG::Time::makeWithNSecs(pendingBatchNSecs.load(std::memory_order_relaxed));
+	// frames the thread fell behind on are skipped, the last one is always rendered
+	uint framesToSkip = std::min(frames - 1, maxFrameSkip);
+	std::lock_guard<std::mutex> lock{frameMutex};
+	rewindManager.onFramesRun(frames);
+	auto time = IG::timeFunc(
+		[&]()
+		{
+			iterateTimes(framesToSkip, i)
+			{
+				inputQueue.applyForFrame(batchTime, framesToSkip - i);
+				EmuSystem::runFrame(nullptr, renderSkippedAudio);
+				inputLog.addFrames(1);
+			}
+			runFrameWithRunAhead(&emuVideo, renderAudio);
+		});
+	frameTelemetry.addRunFrameTime(time);
+	uint8 msg = 0;
+	frameReadyPipe.write(&msg, sizeof(msg));
+}
+
+void startEmulationThread()
+{
+	if(threadActive)
+		return;
+	logMsg("starting emulation thread");
+	frameReadyPipe.init({},
+		[](Base::Pipe &pipe)
+		{
+			bool gotFrame = false;
+			while(pipe.hasData())
+			{
+				uint8 msg;
+				pipe.read(&msg, sizeof(msg));
+				gotFrame = true;
+			}
+			if(gotFrame && threadActive)
+				postDrawToEmuWindows();
+			return 1;
+		});
+	pendingFrames.store(0, std::memory_order_relaxed);
+	quitThread.store(false, std::memory_order_relaxed);
+	emuVideo.setThreaded(true);
+	threadActive = true;
+	IG::makeDetachedThread(
+		[]()
+		{
+			IG_TRACE_THREAD_NAME("Emulation");
+			for(;;)
+			{
+				frameRequestSem.wait();
+				if(quitThread.load(std::memory_order_acquire))
+				{
+					threadExitSem.notify();
+					return;
+				}
+				runRequestedFrames();
+			}
+		});
+}
+
+void stopEmulationThread()
+{
+	if(!threadActive)
+		return;
+	logMsg("stopping emulation thread");
+	quitThread.store(true, std::memory_order_release);
+	frameRequestSem.notify();
+	threadExitSem.wait();
+	frameReadyPipe.deinit();
+	emuVideo.setThreaded(false);
+	threadActive = false;
+}
+
+bool emulationThreadIsActive()
+{
+	return threadActive;
+}
+
+void postFramesToEmulationThread(uint frames, uint maxFrameSkip, bool fastForward, IG::Time batchTime, bool muteAudio)
+{
+	assumeExpr(threadActive);
+	pendingMuteAudio.store(muteAudio, std::memory_order_relaxed);
+	pendingBatchNSecs.store(batchTime.nSecs(), std::memory_order_relaxed);
+	pendingMaxFrameSkip.store(maxFrameSkip, std::memory_order_relaxed);
+	pendingFastForward.store(fastForward, std::memory_order_relaxed);
+	pendingFrames.fetch_add(frames, std::memory_order_release);
+	frameRequestSem.notify();
+}
+
+std::unique_lock<std::mutex> lockEmulationThread()
+{
+	if(!threadActive)
+		return {};
+	return std::unique_lock<std::mutex>{frameMutex};
+}
@@ -22,12 +22,36 @@
 
 void EmuVideo::resetImage()
 {
+	if(headless)
+	{
+		memPix = {};
+		return;
+	}
 	auto desc = vidImg.usedPixmapDesc();
 	vidImg.deinit();
-	setFormat(desc);
+	setTextureFormat(desc);
 }
 
 void EmuVideo::setFormat(IG::PixmapDesc desc)
+{
+	if(headless)
+	{
+		if(memPix && desc == memPix)
+			return;
+		memPix = {desc};
+		logMsg("resized headless image to:%dx%d", desc.w(), desc.h());
+		return;
+	}
+	queueDesc = desc;
+	if(threaded)
+	{
+		// applied to the texture when the frame is uploaded
+		return;
+	}
+	setTextureFormat(desc);
+}
+
+void EmuVideo::setTextureFormat(IG::PixmapDesc desc)
 {
 	if(vidImg && desc == vidImg.usedPixmapDesc())
 	{
@@ -57,6 +81,14 @@ void EmuVideo::setFormat(IG::PixmapDesc desc)
 
 EmuVideoImage EmuVideo::startFrame()
 {
+	if(headless)
+	{
+		return {*this, (IG::Pixmap)memPix};
+	}
+	if(threaded)
+	{
+		return {*this, (IG::Pixmap)frameQueue.writeBuffer(queueDesc)};
+	}
 	auto lockedTex = vidImg.lock(0);
 	if(!lockedTex)
 	{
@@ -72,30 +104,56 @@ EmuVideoImage EmuVideo::startFrame()
 
 void EmuVideo::writeFrame(Gfx::LockedTextureBuffer texBuff)
 {
+	IG_TRACE_SPAN("EmuVideo::writeFrame");
+	writtenFrames_++;
 	if(screenshotNextFrame)
 	{
 		doScreenshot(texBuff.pixmap());
 	}
+	auto start = IG::Time::now();
 	vidImg.unlock(texBuff);
+	auto uploadEnd = IG::Time::now();
 	if(renderNextFrame)
 	{
 		renderNextFrame = false;
 		updateAndDrawEmuVideo();
 	}
+	frameTelemetry.addWriteFrameTime(double(uploadEnd - start), double(IG::Time::now() - start));
 }
 
 void EmuVideo::writeFrame(IG::Pixmap pix)
 {
+	IG_TRACE_SPAN("EmuVideo::writeFrame");
+	writtenFrames_++;
+	auto start = IG::Time::now();
+	if(threaded)
+	{
+		auto &buff = frameQueue.writeBuffer(pix);
+		if(pix.pixel({}) != buff.pixel({}))
+			buff.write(pix);
+		frameQueue.push();
+		auto secs = double(IG::Time::now() - start);
+		frameTelemetry.addWriteFrameTime(secs, secs);
+		return;
+	}
 	if(screenshotNextFrame)
 	{
 		doScreenshot(pix);
 	}
+	if(headless)
+	{
+		if(pix.pixel({}) != memPix.pixel({}))
+			memPix.write(pix);
+		return;
+	}
 	vidImg.write(0, pix, {}, vidImg.bestAlignment(pix));
+	auto uploadEnd = IG::Time::now();
 	if(renderNextFrame)
 	{
 		renderNextFrame = false;
 		updateAndDrawEmuVideo();
 	}
+	frameTelemetry.addWriteFrameTime(double(uploadEnd - start), double(IG::Time::now() - start));
 }
 
 void EmuVideo::takeGameScreenshot()
@@ -156,8 +214,62 @@ void EmuVideoImage::endFrame()
 	}
 }
 
+void EmuVideo::setHeadless(bool on)
+{
+	headless = on;
+	memPix = {};
+	writtenFrames_ = 0;
+}
+
+void EmuVideo::setThreaded(bool on)
+{
+	// any frame still in the queue is uploaded on the next draw
+	threaded = on;
+}
+
+bool EmuVideo::uploadQueuedFrame()
+{
+	auto pix = frameQueue.pop();
+	if(!pix)
+		return false;
+	IG_TRACE_SPAN("EmuVideo::uploadQueuedFrame");
+	setTextureFormat(*pix);
+	if(screenshotNextFrame)
+	{
+		doScreenshot(*pix);
+	}
+	auto uploadSecs = IG::timeFunc([&](){ vidImg.write(0, *pix, {}, vidImg.bestAlignment(*pix)); });
+	frameTelemetry.addWriteFrameTime(uploadSecs);
+	return true;
+}
+
+IG::MemPixmap &EmuVideoFrameQueue::writeBuffer(IG::PixmapDesc desc)
+{
+	auto &b = buff[writeIdx];
+	if(!b || desc != b)
+	{
+		b = {desc};
+	}
+	return b;
+}
+
+void EmuVideoFrameQueue::push()
+{
+	writeIdx = readyIdx.exchange(writeIdx | FRESH_BIT, std::memory_order_acq_rel) & IDX_MASK;
+}
+
+IG::MemPixmap *EmuVideoFrameQueue::pop()
+{
+	if(!hasFrame())
+		return nullptr;
+	readIdx = readyIdx.exchange(readIdx, std::memory_order_acq_rel) & IDX_MASK;
+	return &buff[readIdx];
+}
+
 IG::WP EmuVideo::size() const
 {
+	if(headless)
+		return memPix.size();
 	if(!vidImg)
 		return {};
 	else
@@ -16,6 +16,7 @@
 #include <emuframework/EmuView.hh>
 #include <emuframework/EmuApp.hh>
 #include <algorithm>
+#include "private.hh"
 
 EmuView::EmuView(ViewAttachParams attach, EmuVideoLayer *layer, EmuInputView *inputView):
 	View{attach},
@@ -35,6 +36,10 @@ void EmuView::draw()
 		renderer().loadTransform(projP.makeTranslate());
 		inputView->draw();
 	}
+	if(EmuSystem::isActive())
+	{
+		frameTelemetry.draw(renderer(), projP, EmuSystem::frameTime());
+	}
 }
 
 void EmuView::place()
@@ -102,7 +102,7 @@ static FS::RootPathInfo nearestRootLocation(const char *path)
 	return {nearestPtr->root.name, nearestPtr->root.length};
 }
 
-EmuFilePicker *EmuFilePicker::makeForBenchmarking(ViewAttachParams attach, Input::Event e, bool singleDir)
+EmuFilePicker *EmuFilePicker::makeForBenchmarking(ViewAttachParams attach, Input::Event e, bool singleDir, bool wholeDir)
 {
 	auto rootInfo = nearestRootLocation(lastLoadPath.data());
 	auto picker = new EmuFilePicker{attach, lastLoadPath.data(), false, EmuSystem::defaultBenchmarkFsFilter, rootInfo, e, singleDir};
@@ -111,15 +111,29 @@ EmuFilePicker *EmuFilePicker::makeForBenchmarking(ViewAttachParams attach, Input
 		{
 			lastLoadPath = picker.path();
 		});
-	picker->setOnSelectFile(
-		[](FSPicker &picker, const char* name, Input::Event e)
-		{
-			EmuApp::createSystemWithMedia({}, name, "", e,
-				[](Input::Event e)
-				{
-					runBenchmarkOneShot();
-				});
-		});
+	if(wholeDir)
+	{
+		// selecting any file benchmarks every game in its directory
+		picker->setOnSelectFile(
+			[](FSPicker &picker, const char* name, Input::Event e)
+			{
+				auto path = picker.path();
+				EmuApp::popModalViews();
+				runBenchmarkOnDirectoryOneShot(path.data());
+			});
+	}
+	else
+	{
+		picker->setOnSelectFile(
+			[](FSPicker &picker, const char* name, Input::Event e)
+			{
+				EmuApp::createSystemWithMedia({}, name, "", e,
+					[](Input::Event e)
+					{
+						runBenchmarkOneShot();
+					});
+			});
+	}
 	return picker;
 }
 
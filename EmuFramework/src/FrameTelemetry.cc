@@ -0,0 +1,269 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "FrameTelemetry"
+#include <emuframework/FrameTelemetry.hh>
+#include <imagine/gfx/GeomRect.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/logger/logger.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "private.hh"
+
+FrameTelemetry frameTelemetry{};
+
+static uint toUSecs(double secs)
+{
+	return secs > 0 ? secs * 1000000. : 0;
+}
+
+static float fromUSecs(uint usecs)
+{
+	return usecs / 1000000.f;
+}
+
+void FrameTelemetry::setEnabled(bool on)
+{
+	if(on == enabled)
+		return;
+	enabled = on;
+	reset();
+}
+
+void FrameTelemetry::reset()
+{
+	nextSample = sampleCount = 0;
+	runFrameUSecs.store(0, std::memory_order_relaxed);
+	writeFrameUSecs.store(0, std::memory_order_relaxed);
+	nestedUSecs.store(0, std::memory_order_relaxed);
+	skippedFrames.store(0, std::memory_order_relaxed);
+	audioFill.store(-1, std::memory_order_relaxed);
+	inputEventNSecs.store(0, std::memory_order_relaxed);
+	presentSecs = 0;
+	inputLatencySecs = 0;
+	presented = false;
+	drawPosted = false;
+}
+
+void FrameTelemetry::addRunFrameTime(double secs)
+{
+	if(!enabled)
+		return;
+	// the core may call writeFrame() and even present from inside runFrame()
+	uint usecs = toUSecs(secs);
+	uint nested = std::min(nestedUSecs.exchange(0, std::memory_order_relaxed), usecs);
+	runFrameUSecs.fetch_add(usecs - nested, std::memory_order_relaxed);
+}
+
+void FrameTelemetry::addWriteFrameTime(double secs, double nestedSecs)
+{
+	if(!enabled)
+		return;
+	writeFrameUSecs.fetch_add(toUSecs(secs), std::memory_order_relaxed);
+	if(nestedSecs)
+		nestedUSecs.fetch_add(toUSecs(nestedSecs), std::memory_order_relaxed);
+}
+
+void FrameTelemetry::addSkippedFrames(uint frames)
+{
+	if(!enabled || !frames)
+		return;
+	skippedFrames.fetch_add(frames, std::memory_order_relaxed);
+}
+
+void FrameTelemetry::setAudioFramesFree(int framesFree)
+{
+	if(!enabled)
+		return;
+	// like AudioRateControl, the buffer size is the most ever seen free
+	audioCapacity = std::max(audioCapacity, framesFree);
+	if(!audioCapacity)
+		return;
+	audioFill.store(1000 - (int)(framesFree * 1000ll / audioCapacity), std::memory_order_relaxed);
+}
+
+void FrameTelemetry::addInputApplied(IG::Time eventTime)
+{
+	if(!enabled)
+		return;
+	// events are applied in order, so only the first since the last present is kept
+	uint64_t noEvent = 0;
+	inputEventNSecs.compare_exchange_strong(noEvent, eventTime.nSecs(), std::memory_order_relaxed);
+}
+
+void FrameTelemetry::markDrawPosted()
+{
+	if(!enabled || drawPosted)
+		return;
+	drawPostTime = IG::Time::now();
+	drawPosted = true;
+}
+
+void FrameTelemetry::markPresented()
+{
+	if(!enabled)
+		return;
+	if(drawPosted)
+	{
+		presentSecs = double(IG::Time::now() - drawPostTime);
+		drawPosted = false;
+	}
+	if(auto eventNSecs = inputEventNSecs.exchange(0, std::memory_order_relaxed);
+		eventNSecs)
+	{
+		inputLatencySecs = double(IG::Time::now() - IG::Time::makeWithNSecs(eventNSecs));
+	}
+	presented = true;
+}
+
+void FrameTelemetry::commitFrame()
+{
+	if(!enabled || !presented)
+		return;
+	presented = false;
+	auto &s = sample_[nextSample];
+	s.runFrameSecs = fromUSecs(runFrameUSecs.exchange(0, std::memory_order_relaxed));
+	s.writeFrameSecs = fromUSecs(writeFrameUSecs.exchange(0, std::memory_order_relaxed));
+	s.presentSecs = presentSecs;
+	s.skippedFrames = std::min(skippedFrames.exchange(0, std::memory_order_relaxed), 0xFFFFu);
+	s.audioFill = audioFill.load(std::memory_order_relaxed);
+	s.inputLatencySecs = inputLatencySecs;
+	presentSecs = 0;
+	inputLatencySecs = 0;
+	nextSample = (nextSample + 1) % MAX_SAMPLES;
+	sampleCount = std::min(sampleCount + 1, MAX_SAMPLES);
+}
+
+const FrameTelemetry::Sample &FrameTelemetry::sample(uint idx) const
+{
+	assumeExpr(idx < sampleCount);
+	// index 0 is the oldest sample
+	return sample_[(nextSample + MAX_SAMPLES - sampleCount + idx) % MAX_SAMPLES];
+}
+
+void FrameTelemetry::draw(Gfx::Renderer &r, const Gfx::ProjectionPlane &projP, double frameTime) const
+{
+	using namespace Gfx;
+	if(!enabled || !frameTime)
+		return;
+	// top-left quarter of the view, the graph's height spans two frame times
+	GCRect bounds{-projP.wHalf(), projP.hHalf() - projP.h * .25f, 0, projP.hHalf()};
+	Gfx::GC colW = bounds.xSize() / MAX_SAMPLES;
+	Gfx::GC secsToY = bounds.ySize() / (frameTime * 2.);
+	Gfx::GC tickH = projP.unprojectYSize(2);
+	r.noTexProgram.use(r, projP.makeTranslate());
+	r.setBlendMode(BLEND_MODE_ALPHA);
+	r.setColor(0., 0., 0., .5);
+	GeomRect::draw(r, bounds);
+	// one frame time reference line
+	r.setColor(.5, .5, .5, .75);
+	Gfx::GC frameY = bounds.y + frameTime * secsToY;
+	GeomRect::draw(r, GCRect{bounds.x, frameY, bounds.x2, frameY + tickH});
+	iterateTimes(sampleCount, i)
+	{
+		auto &s = sample(i);
+		Gfx::GC x = bounds.x + i * colW;
+		Gfx::GC x2 = x + colW;
+		Gfx::GC runY = std::min(bounds.y + s.runFrameSecs * secsToY, bounds.y2);
+		Gfx::GC writeY = std::min(runY + s.writeFrameSecs * secsToY, bounds.y2);
+		r.setColor(0., .75, 0., .75); // emulation
+		GeomRect::draw(r, GCRect{x, bounds.y, x2, runY});
+		r.setColor(0., .5, 1., .75); // video conversion & upload
+		GeomRect::draw(r, GCRect{x, runY, x2, writeY});
+		r.setColor(1., 1., 0., 1.); // draw request to present
+		Gfx::GC presentY = std::min(bounds.y + s.presentSecs * secsToY, bounds.y2 - tickH);
+		GeomRect::draw(r, GCRect{x, presentY, x2, presentY + tickH});
+		if(s.skippedFrames)
+		{
+			r.setColor(1., 0., 0., .75);
+			Gfx::GC skipH = std::min(s.skippedFrames, (uint16)8) * (bounds.ySize() / 8);
+			GeomRect::draw(r, GCRect{x, bounds.y2 - skipH, x2, bounds.y2});
+		}
+		if(s.audioFill >= 0)
+		{
+			r.setColor(1., 1., 1., 1.);
+			Gfx::GC fillY = bounds.y + std::min(s.audioFill / 1000.f, 1.f) * (bounds.ySize() - tickH);
+			GeomRect::draw(r, GCRect{x, fillY, x2, fillY + tickH});
+		}
+		if(s.inputLatencySecs)
+		{
+			r.setColor(1., 0., 1., 1.); // input event to present
+			Gfx::GC latencyY = std::min(bounds.y + s.inputLatencySecs * secsToY, bounds.y2 - tickH);
+			GeomRect::draw(r, GCRect{x, latencyY, x2, latencyY + tickH});
+		}
+	}
+	r.setColor(1., 1., 1., 1.);
+}
+
+static bool writeString(IO &io, const char *str)
+{
+	size_t len = strlen(str);
+	return io.write(str, len) == (ssize_t)len;
+}
+
+std::error_code FrameTelemetry::writeCSV(const char *path) const
+{
+	FileIO io;
+	if(auto ec = io.create(path);
+		ec)
+	{
+		logErr("error creating %s", path);
+		return ec;
+	}
+	bool ok = writeString(io, "frame,runFrameMs,writeFrameMs,presentMs,skippedFrames,audioFill,inputLatencyMs\n");
+	iterateTimes(sampleCount, i)
+	{
+		auto &s = sample(i);
+		char line[128];
+		snprintf(line, sizeof(line), "%u,%.3f,%.3f,%.3f,%u,%.3f,%.3f\n", i,
+			s.runFrameSecs * 1000., s.writeFrameSecs * 1000., s.presentSecs * 1000.,
+			(uint)s.skippedFrames, s.audioFill >= 0 ? s.audioFill / 1000. : -1.,
+			s.inputLatencySecs * 1000.);
+		ok = ok && writeString(io, line);
+	}
+	if(!ok)
+		return {EIO, std::system_category()};
+	logMsg("wrote %u samples to %s", sampleCount, path);
+	return {};
+}
+
+std::error_code FrameTelemetry::writeJSON(const char *path) const
+{
+	FileIO io;
+	if(auto ec = io.create(path);
+		ec)
+	{
+		logErr("error creating %s", path);
+		return ec;
+	}
+	bool ok = writeString(io, "[\n");
+	iterateTimes(sampleCount, i)
+	{
+		auto &s = sample(i);
+		char line[224];
+		snprintf(line, sizeof(line),
+			"{\"frame\":%u,\"runFrameMs\":%.3f,\"writeFrameMs\":%.3f,\"presentMs\":%.3f,\"skippedFrames\":%u,\"audioFill\":%.3f,\"inputLatencyMs\":%.3f}%s\n", i,
+			s.runFrameSecs * 1000., s.writeFrameSecs * 1000., s.presentSecs * 1000.,
+			(uint)s.skippedFrames, s.audioFill >= 0 ? s.audioFill / 1000. : -1.,
+			s.inputLatencySecs * 1000., i + 1 < sampleCount ? "," : "");
+		ok = ok && writeString(io, line);
+	}
+	ok = ok && writeString(io, "]\n");
+	if(!ok)
+		return {EIO, std::system_category()};
+	logMsg("wrote %u samples to %s", sampleCount, path);
+	return {};
+}
@@ -0,0 +1,176 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "Headless"
+#include <emuframework/EmuSystem.hh>
+#include <emuframework/EmuOptions.hh>
+#include <emuframework/Benchmark.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/util/string.h>
+#include <cstdio>
+#include <cstdlib>
+#include "private.hh"
+
+struct HeadlessConfig
+{
+	const char *gamePath{};
+	const char *jsonPath{};
+	const char *replayPath{};
+	const char *tracePath{};
+	BenchmarkConfig benchmark{};
+};
+
+static void printHeadlessUsage(const char *exe)
+{
+	fprintf(stderr, "usage: %s --headless [--warmup=N] [--frames=N] [--no-video] [--no-audio] [--json=PATH] [--replay=INPUT LOG] [--trace=PATH] <game path or directory>\n"
+		"  --no-video  only runs the pass that skips rendering video frames, both other passes render them\n"
+		"  --no-audio  skips the pass that renders audio\n", exe);
+}
+
+static bool parseHeadlessArgs(int argc, char** argv, HeadlessConfig &conf)
+{
+	auto optionValue =
+		[](const char *arg, const char *prefix) -> const char*
+		{
+			return strstr(arg, prefix) == arg ? arg + strlen(prefix) : nullptr;
+		};
+	for(int i = 2; i < argc; i++)
+	{
+		auto arg = argv[i];
+		if(string_equal(arg, "--no-video"))
+		{
+			// leaves only the videoSkipped pass, the audio pass also renders video
+			conf.benchmark.videoRun = false;
+			conf.benchmark.audioRun = false;
+		}
+		else if(string_equal(arg, "--no-audio"))
+			conf.benchmark.audioRun = false;
+		else if(auto val = optionValue(arg, "--frames="))
+			conf.benchmark.frames = strtoul(val, nullptr, 10);
+		else if(auto val = optionValue(arg, "--warmup="))
+			conf.benchmark.warmupFrames = strtoul(val, nullptr, 10);
+		else if(auto val = optionValue(arg, "--json="))
+			conf.jsonPath = val;
+		else if(auto val = optionValue(arg, "--replay="))
+			conf.replayPath = val;
+		else if(auto val = optionValue(arg, "--trace="))
+		{
+			if(!Trace::isSupported)
+			{
+				fprintf(stderr, "--trace needs a build with imagineTrace := 1\n");
+				return false;
+			}
+			conf.tracePath = val;
+		}
+		else if(arg[0] == '-')
+		{
+			fprintf(stderr, "unknown option: %s\n", arg);
+			return false;
+		}
+		else
+			conf.gamePath = arg;
+	}
+	return conf.gamePath && conf.benchmark.frames;
+}
+
+bool isHeadlessLaunch(int argc, char** argv)
+{
+	return argc > 1 && string_equal(argv[1], "--headless");
+}
+
+int runHeadless(int argc, char** argv)
+{
+	HeadlessConfig conf{};
+	if(!parseHeadlessArgs(argc, argv, conf))
+	{
+		printHeadlessUsage(argv[0]);
+		return 1;
+	}
+	initOptions();
+	loadConfigFile();
+	if(auto err = EmuSystem::onOptionsLoaded();
+		err)
+	{
+		fprintf(stderr, "error: %s\n", err->what());
+		return 1;
+	}
+	emuVideo.setHeadless(true);
+	Trace::setEnabled(conf.tracePath);
+	std::vector<BenchmarkResult> results{};
+	InputLog replayLog{};
+	if(conf.replayPath && FS::status(conf.gamePath).type() == FS::file_type::directory)
+	{
+		fprintf(stderr, "error: --replay needs a single game\n");
+		return 1;
+	}
+	if(FS::status(conf.gamePath).type() == FS::file_type::directory)
+	{
+		results = runBenchmarkOnDirectory(conf.gamePath, conf.benchmark);
+	}
+	else
+	{
+		if(auto err = EmuSystem::loadGameFromPath(conf.gamePath,
+			[](int pos, int max, const char *label){ return true; });
+			err)
+		{
+			fprintf(stderr, "error loading %s: %s\n", conf.gamePath, err->what());
+			return 1;
+		}
+		EmuSystem::prepareAudioVideo();
+		if(conf.replayPath)
+		{
+			if(auto err = replayLog.readFile(conf.replayPath);
+				err)
+			{
+				fprintf(stderr, "error reading %s: %s\n", conf.replayPath, err->what());
+				return 1;
+			}
+			conf.benchmark.replay = &replayLog;
+		}
+		results.emplace_back(runBenchmark(conf.benchmark));
+		EmuSystem::closeGame(false);
+	}
+	emuVideo.setHeadless(false);
+	if(conf.tracePath)
+	{
+		auto ec = Trace::writeJSON(conf.tracePath);
+		Trace::deinit();
+		if(ec)
+		{
+			fprintf(stderr, "error writing %s: %s\n", conf.tracePath, ec.message().c_str());
+			return 1;
+		}
+	}
+	if(!results.size())
+	{
+		fprintf(stderr, "no games found in %s\n", conf.gamePath);
+		return 1;
+	}
+	auto json = benchmarkResultsToJSON(conf.benchmark, results.data(), results.size());
+	if(conf.jsonPath)
+	{
+		if(auto ec = writeToNewFile(conf.jsonPath, json.data(), json.size());
+			ec)
+		{
+			fprintf(stderr, "error writing %s: %s\n", conf.jsonPath, ec.message().c_str());
+			return 1;
+		}
+	}
+	else
+	{
+		fputs(json.c_str(), stdout);
+	}
+	return 0;
+}
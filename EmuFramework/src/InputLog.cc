@@ -0,0 +1,157 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "InputLog"
+#include <emuframework/InputLog.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/string.h>
+#include <cstring>
+#include "private.hh"
+
+InputLog inputLog{};
+
+// file layout, all fields in native byte order:
+// header, initial state (stateSize bytes), actions (actions * Action)
+struct InputLogHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t frames;
+	uint32_t stateSize;
+	uint32_t actions;
+	char system[16];
+};
+
+static constexpr char INPUT_LOG_MAGIC[8]{'E', 'M', 'U', 'I', 'N', 'L', 'O', 'G'};
+static constexpr uint32_t INPUT_LOG_VERSION = 1;
+
+EmuSystem::Error InputLog::startRecording()
+{
+	stopRecording();
+	action.clear();
+	frames_ = 0;
+	if(auto err = EmuSystem::saveStateToBuffer(initialState);
+		err)
+	{
+		return err;
+	}
+	logMsg("started recording with %u byte state", (uint)initialState.size());
+	recording = true;
+	return {};
+}
+
+void InputLog::stopRecording()
+{
+	if(!recording)
+		return;
+	logMsg("stopped recording after %u frames & %u actions", frames_, (uint)action.size());
+	recording = false;
+}
+
+void InputLog::addAction(uint state, uint emuKey)
+{
+	if(!recording)
+		return;
+	action.push_back({frames_, emuKey, state});
+}
+
+void InputLog::addFrames(uint frames)
+{
+	if(!recording)
+		return;
+	frames_ += frames;
+}
+
+std::error_code InputLog::writeFile(const char *path) const
+{
+	FileIO io;
+	if(auto ec = io.create(path);
+		ec)
+	{
+		logErr("error creating %s", path);
+		return ec;
+	}
+	InputLogHeader header{};
+	memcpy(header.magic, INPUT_LOG_MAGIC, sizeof(header.magic));
+	header.version = INPUT_LOG_VERSION;
+	header.frames = frames_;
+	header.stateSize = initialState.size();
+	header.actions = action.size();
+	string_copy(header.system, EmuSystem::shortSystemName());
+	if(auto ec = io.writeAll(&header, sizeof(header)); ec)
+		return ec;
+	if(auto ec = io.writeAll((void*)initialState.data(), initialState.size()); ec)
+		return ec;
+	if(auto ec = io.writeAll((void*)action.data(), action.size() * sizeof(Action)); ec)
+		return ec;
+	logMsg("wrote %u frames & %u actions to %s", frames_, (uint)action.size(), path);
+	return {};
+}
+
+EmuSystem::Error InputLog::readFile(const char *path)
+{
+	FileIO io;
+	io.open(path, IO::AccessHint::SEQUENTIAL);
+	if(!io)
+		return EmuSystem::makeFileReadError();
+	InputLogHeader header{};
+	if(io.read(&header, sizeof(header)) != sizeof(header) ||
+		memcmp(header.magic, INPUT_LOG_MAGIC, sizeof(header.magic)))
+	{
+		return EmuSystem::makeError("Not an input log");
+	}
+	if(header.version != INPUT_LOG_VERSION)
+		return EmuSystem::makeError("Unsupported input log version %u", header.version);
+	header.system[sizeof(header.system) - 1] = 0;
+	if(!string_equal(header.system, EmuSystem::shortSystemName()))
+		return EmuSystem::makeError("Input log is for system %s", header.system);
+	size_t actionBytes = (size_t)header.actions * sizeof(Action);
+	if(sizeof(header) + header.stateSize + actionBytes != (size_t)io.size())
+		return EmuSystem::makeError("Input log is truncated");
+	stopRecording();
+	initialState.resize(header.stateSize);
+	action.resize(header.actions);
+	if(io.read(initialState.data(), header.stateSize) != (ssize_t)header.stateSize ||
+		io.read(action.data(), actionBytes) != (ssize_t)actionBytes)
+	{
+		return EmuSystem::makeFileReadError();
+	}
+	frames_ = header.frames;
+	replayFrameIdx = replayActionIdx = 0;
+	logMsg("read %u frames & %u actions from %s", frames_, (uint)action.size(), path);
+	return {};
+}
+
+EmuSystem::Error InputLog::startReplay()
+{
+	if(initialState.empty())
+		return EmuSystem::makeError("No input log loaded");
+	replayFrameIdx = replayActionIdx = 0;
+	return EmuSystem::loadStateFromBuffer(initialState);
+}
+
+bool InputLog::replayFrame()
+{
+	if(replayFrameIdx >= frames_)
+		return false;
+	for(; replayActionIdx < action.size() && action[replayActionIdx].frame <= replayFrameIdx; replayActionIdx++)
+	{
+		auto &a = action[replayActionIdx];
+		EmuSystem::handleInputAction(a.state, a.emuKey);
+	}
+	replayFrameIdx++;
+	return true;
+}
@@ -0,0 +1,82 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "InputQueue"
+#include <emuframework/InputQueue.hh>
+#include <emuframework/EmuSystem.hh>
+#include <imagine/logger/logger.h>
+#include "private.hh"
+
+InputQueue inputQueue{};
+
+static constexpr uint64_t MAX_EVENT_AGE_NSECS = 1000000000;
+
+void InputQueue::push(IG::Time time, uint state, uint emuKey)
+{
+	auto now = IG::Time::now().nSecs();
+	auto eventTime = time.nSecs();
+	// not every input source stamps events with the monotonic clock
+	if(!eventTime || eventTime > now || now - eventTime > MAX_EVENT_AGE_NSECS)
+		eventTime = now;
+	auto w = writePos.load(std::memory_order_relaxed);
+	if(w - readPos.load(std::memory_order_acquire) == QUEUE_SIZE)
+	{
+		logWarn("queue full, applying pending actions early");
+		auto lock = lockEmulationThread();
+		applyAll();
+	}
+	action[w % QUEUE_SIZE] = {eventTime, state, emuKey};
+	writePos.store(w + 1, std::memory_order_release);
+}
+
+void InputQueue::applyForFrame(IG::Time batchTime, uint framesLeft)
+{
+	if(!framesLeft || !batchTime.nSecs())
+	{
+		applyAll();
+		return;
+	}
+	uint64_t framesLeftNSecs = framesLeft * EmuSystem::frameTime() * 1000000000.;
+	auto frameTime = batchTime.nSecs();
+	if(framesLeftNSecs >= frameTime)
+		return;
+	applyUntil(frameTime - framesLeftNSecs);
+}
+
+void InputQueue::applyAll()
+{
+	applyUntil(UINT64_MAX);
+}
+
+void InputQueue::clear()
+{
+	readPos.store(writePos.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void InputQueue::applyUntil(uint64_t time)
+{
+	auto r = readPos.load(std::memory_order_relaxed);
+	auto w = writePos.load(std::memory_order_acquire);
+	for(; r != w; r++)
+	{
+		auto &a = action[r % QUEUE_SIZE];
+		if(a.time > time)
+			break;
+		EmuSystem::handleInputAction(a.state, a.emuKey);
+		inputLog.addAction(a.state, a.emuKey);
+		frameTelemetry.addInputApplied(IG::Time::makeWithNSecs(a.time));
+	}
+	readPos.store(r, std::memory_order_release);
+}
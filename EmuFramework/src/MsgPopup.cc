@@ -61,8 +61,10 @@ void MsgPopup::unpost()
 void MsgPopup::postContent(int secs, bool error)
 {
 	assert(strlen(str.data()));
-	mainWin.win.postDraw();
 	logMsg("%s", str.data());
+	if(!text.face)
+		return; // running without a window, only log the message
+	mainWin.win.postDraw();
 	text.compile(r, projP);
 	this->error = error;
 	unpostTimer.callbackAfterSec([this](){unpost();}, secs, {});
@@ -409,6 +409,8 @@ void VideoOptionView::loadStockItems()
 	item.emplace_back(&frameInterval);
 	#endif
 	item.emplace_back(&dropLateFrames);
+	item.emplace_back(&emulateInThread);
+	item.emplace_back(&showFrameTiming);
 	if(!optionFrameRate.isConst)
 	{
 		printFrameRateStr(frameRateStr);
@@ -459,6 +461,8 @@ void AudioOptionView::loadStockItems()
 {
 	item.emplace_back(&snd);
 	if(!optionSoundRate.isConst) { item.emplace_back(&audioRate); }
+	item.emplace_back(&dynamicRate);
+	item.emplace_back(&resamplerQuality);
 	#ifdef CONFIG_AUDIO_LATENCY_HINT
 	item.emplace_back(&soundBuffers);
 	#endif
@@ -479,6 +483,9 @@ void SystemOptionView::loadStockItems()
 	item.emplace_back(&savePath);
 	item.emplace_back(&checkSavePathWriteAccess);
 	item.emplace_back(&fastForwardSpeed);
+	item.emplace_back(&rewindMemory);
+	item.emplace_back(&rewindInterval);
+	item.emplace_back(&runAhead);
 	#ifdef __ANDROID__
 	item.emplace_back(&processPriority);
 	if(!optionFakeUserActivity.isConst)
@@ -654,6 +661,25 @@ VideoOptionView::VideoOptionView(ViewAttachParams attach, bool customMenu):
 			optionSkipLateFrames.val = item.flipBoolValue(*this);
 		}
 	},
+	emulateInThread
+	{
+		"Emulate In Separate Thread",
+		(bool)optionEmulateInThread,
+		[this](BoolMenuItem &item, View &, Input::Event e)
+		{
+			optionEmulateInThread.val = item.flipBoolValue(*this);
+		}
+	},
+	showFrameTiming
+	{
+		"Show Frame Timing Graph",
+		(bool)optionShowFrameTiming,
+		[this](BoolMenuItem &item, View &, Input::Event e)
+		{
+			optionShowFrameTiming.val = item.flipBoolValue(*this);
+			frameTelemetry.setEnabled(optionShowFrameTiming);
+		}
+	},
 	frameRate
 	{
 		frameRateStr,
@@ -1110,6 +1136,27 @@ AudioOptionView::AudioOptionView(ViewAttachParams attach, bool customMenu):
 		{
 			return audioRateItem[idx];
 		}
+	},
+	dynamicRate
+	{
+		"Dynamic Rate Control",
+		(bool)optionDynamicAudioRate,
+		[this](BoolMenuItem &item, View &, Input::Event e)
+		{
+			optionDynamicAudioRate = item.flipBoolValue(*this);
+		}
+	},
+	resamplerQualityItem
+	{
+		{"Low", [this]() { optionAudioResamplerQuality = 0; }},
+		{"Medium", [this]() { optionAudioResamplerQuality = 1; }},
+		{"High", [this]() { optionAudioResamplerQuality = 2; }},
+	},
+	resamplerQuality
+	{
+		"Resampler Quality",
+		optionAudioResamplerQuality,
+		resamplerQualityItem
 	}
 	#ifdef EMU_FRAMEWORK_STRICT_UNDERRUN_CHECK_OPTION
 	,sndUnderrunCheck
@@ -1254,6 +1301,66 @@ SystemOptionView::SystemOptionView(ViewAttachParams attach, bool customMenu):
 			return 0;
 		}(),
 		fastForwardSpeedItem
+	},
+	rewindMemoryItem
+	{
+		{"Off", [this]() { optionRewindMemory = 0; }},
+		{"16MB", [this]() { optionRewindMemory = 16; }},
+		{"32MB", [this]() { optionRewindMemory = 32; }},
+		{"64MB", [this]() { optionRewindMemory = 64; }},
+		{"128MB", [this]() { optionRewindMemory = 128; }},
+	},
+	rewindMemory
+	{
+		"Rewind History",
+		[]() -> uint
+		{
+			switch(optionRewindMemory.val)
+			{
+				default: return 0;
+				case 16: return 1;
+				case 32: return 2;
+				case 64: return 3;
+				case 128: return 4;
+			}
+		}(),
+		rewindMemoryItem
+	},
+	rewindIntervalItem
+	{
+		{"Every Frame", [this]() { optionRewindInterval = 1; }},
+		{"Every 2 Frames", [this]() { optionRewindInterval = 2; }},
+		{"Every 4 Frames", [this]() { optionRewindInterval = 4; }},
+		{"Every 8 Frames", [this]() { optionRewindInterval = 8; }},
+	},
+	rewindInterval
+	{
+		"Rewind Snapshots",
+		[]() -> uint
+		{
+			switch(optionRewindInterval.val)
+			{
+				case 1: return 0;
+				default: return 1;
+				case 4: return 2;
+				case 8: return 3;
+			}
+		}(),
+		rewindIntervalItem
+	},
+	runAheadItem
+	{
+		{"Off", [this]() { setRunAheadFrames(0); }},
+		{"1", [this]() { setRunAheadFrames(1); }},
+		{"2", [this]() { setRunAheadFrames(2); }},
+		{"3", [this]() { setRunAheadFrames(3); }},
+		{"4", [this]() { setRunAheadFrames(4); }},
+	},
+	runAhead
+	{
+		"Run-ahead Frames",
+		optionRunAheadFrames,
+		runAheadItem
 	}
 	#if defined __ANDROID__
 	,processPriorityItem
@@ -1332,6 +1439,21 @@ void SystemOptionView::onSavePathChange(const char *path)
 	EmuSystem::savePathChanged();
 }
 
+void SystemOptionView::setRunAheadFrames(uint frames)
+{
+	optionRunAheadFrames = frames;
+	if(!frames || !EmuSystem::gameIsRunning())
+		return;
+	// let the user know if the current game can keep up
+	if(auto cost = runAheadFrameCost(frames);
+		cost)
+	{
+		auto budget = EmuSystem::frameTime();
+		popup.printf(4, cost > budget, "Estimated frame time %.2fms of %.2fms budget%s",
+			cost * 1000., budget * 1000., cost > budget ? ", expect slowdown" : "");
+	}
+}
+
 void SystemOptionView::onFirmwarePathChange(const char *path, Input::Event e) {}
 
 void SystemOptionView::pushAndShowFirmwarePathMenu(const char *name, Input::Event e)
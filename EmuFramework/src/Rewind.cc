@@ -0,0 +1,267 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "Rewind"
+#include <emuframework/Rewind.hh>
+#include <emuframework/EmuSystem.hh>
+#include <imagine/logger/logger.h>
+#include <algorithm>
+#include <cstring>
+#include "private.hh"
+
+RewindManager rewindManager{};
+
+// dest ^= src over the length of dest, src is treated as zero-extended
+static void xorState(uint8 *dest, size_t destSize, const uint8 *src, size_t srcSize)
+{
+	auto size = std::min(destSize, srcSize);
+	size_t i = 0;
+	for(; i + 8 <= size; i += 8)
+	{
+		uint64_t d, s;
+		memcpy(&d, dest + i, 8);
+		memcpy(&s, src + i, 8);
+		d ^= s;
+		memcpy(dest + i, &d, 8);
+	}
+	for(; i < size; i++)
+	{
+		dest[i] ^= src[i];
+	}
+}
+
+static uint8 *writeVarint(uint8 *out, size_t val)
+{
+	while(val >= 0x80)
+	{
+		*out++ = (val & 0x7F) | 0x80;
+		val >>= 7;
+	}
+	*out++ = val;
+	return out;
+}
+
+static const uint8 *readVarint(const uint8 *in, size_t &val)
+{
+	val = 0;
+	uint shift = 0;
+	uint8 byte;
+	do
+	{
+		byte = *in++;
+		val |= size_t(byte & 0x7F) << shift;
+		shift += 7;
+	} while(byte & 0x80);
+	return in;
+}
+
+static bool wordIsZero(const uint8 *data, size_t size, size_t word)
+{
+	auto offset = word * 8;
+	if(offset + 8 <= size)
+	{
+		uint64_t val;
+		memcpy(&val, data + offset, 8);
+		return !val;
+	}
+	return std::all_of(data + offset, data + size, [](uint8 b){ return !b; });
+}
+
+// A delta is encoded as pairs of varint word counts, a run of zero words
+// followed by a run of literal words and then the literal bytes. Most of a
+// XOR delta between neighbouring frames is zero so this alone gives most of
+// the size reduction of a general purpose compressor at a fraction of the cost.
+static void encodeDelta(StateBuffer &out, const uint8 *data, size_t size)
+{
+	// worst case is a literal word after every zero word, costing 2 bytes per 16
+	out.resize(size + 16);
+	auto o = out.data();
+	auto words = (size + 7) / 8;
+	size_t w = 0;
+	while(w < words)
+	{
+		auto zeroStart = w;
+		while(w < words && wordIsZero(data, size, w))
+			w++;
+		auto literalStart = w;
+		while(w < words && !wordIsZero(data, size, w))
+			w++;
+		o = writeVarint(o, literalStart - zeroStart);
+		o = writeVarint(o, w - literalStart);
+		// the last word may be partial
+		auto literalBytes = w > literalStart ? std::min(w * 8, size) - literalStart * 8 : 0;
+		memcpy(o, data + literalStart * 8, literalBytes);
+		o += literalBytes;
+	}
+	out.resize(o - out.data());
+}
+
+// applies an encoded delta to data in place
+static void decodeDelta(uint8 *data, size_t size, const uint8 *in, size_t inSize)
+{
+	auto inEnd = in + inSize;
+	size_t pos = 0;
+	while(in < inEnd)
+	{
+		size_t zeroWords, literalWords;
+		in = readVarint(in, zeroWords);
+		in = readVarint(in, literalWords);
+		pos = std::min(pos + zeroWords * 8, size);
+		auto literalBytes = std::min(pos + literalWords * 8, size) - pos;
+		xorState(data + pos, literalBytes, in, literalBytes);
+		in += literalBytes;
+		pos += literalBytes;
+	}
+}
+
+void RewindManager::setMemoryLimit(size_t bytes)
+{
+	if(bytes == ringSize)
+		return;
+	clear();
+	ring.reset();
+	ringSize = 0;
+	if(!bytes)
+	{
+		logMsg("rewind disabled");
+		lastState = {};
+		newState = {};
+		encodeBuff = {};
+		return;
+	}
+	logMsg("allocating %zu bytes for rewind history", bytes);
+	ring.reset(new uint8[bytes]);
+	ringSize = bytes;
+}
+
+void RewindManager::setInterval(uint frames)
+{
+	interval = std::max(frames, 1u);
+}
+
+void RewindManager::onFramesRun(uint frames)
+{
+	if(!isEnabled())
+		return;
+	framesSinceCapture += frames;
+	if(framesSinceCapture >= (int)interval)
+	{
+		framesSinceCapture = 0;
+		capture();
+	}
+}
+
+void RewindManager::capture()
+{
+	if(auto err = EmuSystem::saveStateToBuffer(newState);
+		err)
+	{
+		logErr("error capturing state:%s", err->what());
+		clear();
+		return;
+	}
+	if(!lastState.empty())
+	{
+		// the previous state becomes its delta from the new one
+		xorState(lastState.data(), lastState.size(), newState.data(), newState.size());
+		encodeDelta(encodeBuff, lastState.data(), lastState.size());
+		pushEntry(lastState.size());
+	}
+	std::swap(lastState, newState);
+	lastStateLoaded = false;
+}
+
+size_t RewindManager::nextEntryOffset(uint size)
+{
+	size_t offset = 0;
+	if(entries.size())
+	{
+		auto end = entries.back().offset + entries.back().size;
+		offset = end;
+		if(offset + size > ringSize)
+		{
+			offset = 0;
+			// entries past the newest are older than any at the start of the ring,
+			// so they go first even if the new one doesn't reach them
+			while(entries.size() && entries.front().offset >= end)
+				entries.pop_front();
+		}
+	}
+	// drop the oldest entries in the way, which always start right after the newest
+	while(entries.size())
+	{
+		auto &e = entries.front();
+		if(e.offset >= offset + size || e.offset + e.size <= offset)
+			break;
+		entries.pop_front();
+	}
+	return offset;
+}
+
+void RewindManager::pushEntry(uint stateSize)
+{
+	auto size = encodeBuff.size();
+	if(size > ringSize)
+	{
+		logWarn("state delta of %zu bytes doesn't fit in rewind history", size);
+		entries.clear();
+		return;
+	}
+	auto offset = nextEntryOffset(size);
+	memcpy(ring.get() + offset, encodeBuff.data(), size);
+	entries.push_back({offset, (uint)size, stateSize});
+}
+
+bool RewindManager::rewind()
+{
+	if(lastState.empty())
+		return false;
+	// the first step after a capture restores that capture, later ones go back a delta
+	bool hasHistory = !lastStateLoaded || entries.size();
+	if(lastStateLoaded && entries.size())
+	{
+		auto e = entries.back();
+		entries.pop_back();
+		auto newerSize = lastState.size();
+		lastState.resize(e.stateSize);
+		if(e.stateSize > newerSize)
+			std::fill_n(lastState.data() + newerSize, e.stateSize - newerSize, 0);
+		decodeDelta(lastState.data(), lastState.size(), ring.get() + e.offset, e.size);
+	}
+	if(auto err = EmuSystem::loadStateFromBuffer(lastState);
+		err)
+	{
+		logErr("error loading state:%s", err->what());
+		clear();
+		return false;
+	}
+	lastStateLoaded = true;
+	// don't capture the state again in the frame run to display it
+	framesSinceCapture = -1;
+	return hasHistory;
+}
+
+void RewindManager::clear()
+{
+	entries.clear();
+	lastState.clear();
+	lastStateLoaded = false;
+	framesSinceCapture = 0;
+}
+
+void RewindManager::deinit()
+{
+	setMemoryLimit(0);
+}
@@ -0,0 +1,725 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "RomLoader"
+#include <emuframework/RomLoader.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/fs/FS.hh>
+#include <imagine/thread/ThreadPool.hh>
+#include <imagine/logger/Trace.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/algorithm.h>
+#include <imagine/util/system/pagesize.h>
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <sys/mman.h>
+
+static constexpr std::array<uint32, 256> makeCRC32Table()
+{
+	std::array<uint32, 256> table{};
+	for(uint32 i = 0; i < 256; i++)
+	{
+		uint32 crc = i;
+		for(uint b = 0; b < 8; b++)
+			crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+		table[i] = crc;
+	}
+	return table;
+}
+
+static constexpr std::array<uint32, 256> crc32Table = makeCRC32Table();
+
+static uint32 updateCRC32(uint32 crc, const uint8 *data, size_t size)
+{
+	crc = ~crc;
+	iterateTimes(size, i)
+	{
+		crc = crc32Table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+static uint32 rotl(uint32 x, uint n)
+{
+	return (x << n) | (x >> (32 - n));
+}
+
+// MD5 and SHA-1 both pad the message to 64-byte blocks, differing in byte order
+template <class T>
+class BlockHash
+{
+public:
+	void update(const uint8 *data, size_t size)
+	{
+		length += size;
+		if(blockFill)
+		{
+			auto copySize = std::min(size, block.size() - blockFill);
+			memcpy(&block[blockFill], data, copySize);
+			blockFill += copySize;
+			data += copySize;
+			size -= copySize;
+			if(blockFill < block.size())
+				return;
+			static_cast<T*>(this)->transform(block.data());
+			blockFill = 0;
+		}
+		for(; size >= block.size(); data += block.size(), size -= block.size())
+		{
+			static_cast<T*>(this)->transform(data);
+		}
+		memcpy(block.data(), data, size);
+		blockFill = size;
+	}
+
+protected:
+	std::array<uint8, 64> block{};
+	size_t blockFill = 0;
+	uint64_t length = 0;
+
+	void pad(bool bigEndian)
+	{
+		uint64_t bits = length * 8;
+		uint8 padding[64]{0x80};
+		update(padding, (blockFill < 56 ? 56 : 120) - blockFill);
+		uint8 lengthBytes[8];
+		iterateTimes(8, i)
+		{
+			lengthBytes[bigEndian ? 7 - i : i] = bits >> (i * 8);
+		}
+		update(lengthBytes, 8);
+	}
+};
+
+class MD5 : public BlockHash<MD5>
+{
+public:
+	void transform(const uint8 *data)
+	{
+		static constexpr uint32 k[64]
+		{
+			0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+			0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+			0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+			0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+			0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+			0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+			0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+			0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+		};
+		static constexpr uint8 r[16]{7, 12, 17, 22, 5, 9, 14, 20, 4, 11, 16, 23, 6, 10, 15, 21};
+		uint32 m[16];
+		iterateTimes(16, i)
+		{
+			m[i] = data[i * 4] | (data[i * 4 + 1] << 8) | (data[i * 4 + 2] << 16) | ((uint32)data[i * 4 + 3] << 24);
+		}
+		uint32 a = state[0], b = state[1], c = state[2], d = state[3];
+		iterateTimes(64, i)
+		{
+			uint32 f;
+			uint g;
+			switch(i / 16)
+			{
+				case 0: f = (b & c) | (~b & d); g = i; break;
+				case 1: f = (d & b) | (~d & c); g = (5 * i + 1) % 16; break;
+				case 2: f = b ^ c ^ d; g = (3 * i + 5) % 16; break;
+				default: f = c ^ (b | ~d); g = (7 * i) % 16; break;
+			}
+			uint32 tmp = d;
+			d = c;
+			c = b;
+			b = b + rotl(a + f + k[i] + m[g], r[(i / 16) * 4 + i % 4]);
+			a = tmp;
+		}
+		state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+	}
+
+	std::array<uint8, 16> finish()
+	{
+		pad(false);
+		std::array<uint8, 16> digest;
+		iterateTimes(16, i)
+		{
+			digest[i] = state[i / 4] >> ((i % 4) * 8);
+		}
+		return digest;
+	}
+
+private:
+	uint32 state[4]{0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476};
+};
+
+class SHA1 : public BlockHash<SHA1>
+{
+public:
+	void transform(const uint8 *data)
+	{
+		uint32 w[80];
+		iterateTimes(16, i)
+		{
+			w[i] = ((uint32)data[i * 4] << 24) | (data[i * 4 + 1] << 16) | (data[i * 4 + 2] << 8) | data[i * 4 + 3];
+		}
+		for(uint i = 16; i < 80; i++)
+		{
+			w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+		}
+		uint32 a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+		iterateTimes(80, i)
+		{
+			uint32 f, k;
+			switch(i / 20)
+			{
+				case 0: f = (b & c) | (~b & d); k = 0x5a827999; break;
+				case 1: f = b ^ c ^ d; k = 0x6ed9eba1; break;
+				case 2: f = (b & c) | (b & d) | (c & d); k = 0x8f1bbcdc; break;
+				default: f = b ^ c ^ d; k = 0xca62c1d6; break;
+			}
+			uint32 tmp = rotl(a, 5) + f + e + k + w[i];
+			e = d;
+			d = c;
+			c = rotl(b, 30);
+			b = a;
+			a = tmp;
+		}
+		state[0] += a; state[1] += b; state[2] += c; state[3] += d; state[4] += e;
+	}
+
+	std::array<uint8, 20> finish()
+	{
+		pad(true);
+		std::array<uint8, 20> digest;
+		iterateTimes(20, i)
+		{
+			digest[i] = state[i / 4] >> ((3 - i % 4) * 8);
+		}
+		return digest;
+	}
+
+private:
+	uint32 state[5]{0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+};
+
+struct RomHasher
+{
+	MD5 md5{};
+	SHA1 sha1{};
+	uint32 crc32 = 0;
+	uint flags;
+	size_t hashBegin, hashEnd;
+
+	RomHasher(uint flags, size_t hashBegin, size_t hashEnd):
+		flags{flags}, hashBegin{hashBegin}, hashEnd{hashEnd} {}
+
+	// hashes the part of image[begin, end) inside the hash range
+	void update(const uint8 *image, size_t begin, size_t end)
+	{
+		begin = std::max(begin, hashBegin);
+		end = std::min(end, hashEnd);
+		if(begin >= end)
+			return;
+		auto data = &image[begin];
+		auto size = end - begin;
+		if(flags & RomLoader::HASH_CRC32)
+			crc32 = updateCRC32(crc32, data, size);
+		if(flags & RomLoader::HASH_MD5)
+			md5.update(data, size);
+		if(flags & RomLoader::HASH_SHA1)
+			sha1.update(data, size);
+	}
+
+	RomLoader::Hashes finish()
+	{
+		RomLoader::Hashes hashes{};
+		hashes.crc32 = crc32;
+		if(flags & RomLoader::HASH_MD5)
+			hashes.md5 = md5.finish();
+		if(flags & RomLoader::HASH_SHA1)
+			hashes.sha1 = sha1.finish();
+		return hashes;
+	}
+};
+
+template <size_t S>
+static std::array<char, S * 2 + 1> hexString(const std::array<uint8, S> &digest)
+{
+	static constexpr char hexDigit[] = "0123456789abcdef";
+	std::array<char, S * 2 + 1> str{};
+	iterateTimes(S, i)
+	{
+		str[i * 2] = hexDigit[digest[i] >> 4];
+		str[i * 2 + 1] = hexDigit[digest[i] & 0xF];
+	}
+	return str;
+}
+
+std::array<char, 33> RomLoader::Hashes::md5String() const
+{
+	return hexString(md5);
+}
+
+std::array<char, 41> RomLoader::Hashes::sha1String() const
+{
+	return hexString(sha1);
+}
+
+const char *RomLoader::patchTypeName() const
+{
+	switch(patch.type)
+	{
+		case PatchType::NONE: return "None";
+		case PatchType::IPS: return "IPS";
+		case PatchType::UPS: return "UPS";
+		case PatchType::BPS: return "BPS";
+	}
+	return "";
+}
+
+std::error_code RomLoader::findPatch(const char *basePath)
+{
+	static constexpr struct { const char *ext; PatchType type; } patchFormat[]
+	{
+		{"ips", PatchType::IPS}, {"ups", PatchType::UPS}, {"bps", PatchType::BPS}
+	};
+	patch = {};
+	for(auto &format : patchFormat)
+	{
+		auto path = FS::makePathStringPrintf("%s.%s", basePath, format.ext);
+		if(!FS::exists(path))
+			continue;
+		logMsg("found %s patch: %s", format.ext, path.data());
+		FileIO io{};
+		if(auto ec = io.open(path, IO::AccessHint::ALL);
+			ec)
+		{
+			return ec;
+		}
+		patch.dataSize = io.size();
+		patch.data = std::make_unique<uint8[]>(patch.dataSize);
+		if(io.read(patch.data.get(), patch.dataSize) != (ssize_t)patch.dataSize)
+		{
+			patch = {};
+			return {EIO, std::system_category()};
+		}
+		patch.type = format.type;
+		if(auto ec = parsePatch();
+			ec)
+		{
+			logErr("invalid %s patch", format.ext);
+			patch = {};
+			return ec;
+		}
+		return {};
+	}
+	return {};
+}
+
+static uint32 readLE32(const uint8 *data)
+{
+	return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32)data[3] << 24);
+}
+
+// UPS & BPS variable length integer, returns false if it runs past end
+static bool readVarInt(const uint8 *&data, const uint8 *end, size_t &val)
+{
+	val = 0;
+	size_t shift = 1;
+	while(data != end)
+	{
+		uint8 x = *data++;
+		val += (x & 0x7f) * shift;
+		if(x & 0x80)
+			return true;
+		shift <<= 7;
+		val += shift;
+	}
+	return false;
+}
+
+std::error_code RomLoader::parsePatch()
+{
+	const std::error_code invalid{EINVAL, std::system_category()};
+	const uint8 *data = patch.data.get();
+	auto end = data + patch.dataSize;
+	if(patch.type == PatchType::IPS)
+	{
+		if(patch.dataSize < 8 || memcmp(data, "PATCH", 5) != 0)
+			return invalid;
+		auto pos = data + 5;
+		while(true)
+		{
+			if(end - pos < 3)
+				return invalid;
+			uint32 offset = (pos[0] << 16) | (pos[1] << 8) | pos[2];
+			pos += 3;
+			if(offset == 0x454f46) // "EOF"
+				break;
+			if(end - pos < 2)
+				return invalid;
+			uint32 size = (pos[0] << 8) | pos[1];
+			pos += 2;
+			if(size)
+			{
+				if((size_t)(end - pos) < size)
+					return invalid;
+				patch.record.emplace_back(PatchRecord{offset, size, pos, 0});
+				pos += size;
+			}
+			else
+			{
+				if(end - pos < 3)
+					return invalid;
+				size = (pos[0] << 8) | pos[1];
+				patch.record.emplace_back(PatchRecord{offset, size, nullptr, pos[2]});
+				pos += 3;
+			}
+		}
+		// optional truncation size after the EOF marker
+		if(end - pos >= 3)
+			patch.targetSize = (pos[0] << 16) | (pos[1] << 8) | pos[2];
+		return {};
+	}
+	// UPS & BPS end with source, target & patch CRC32s
+	if(patch.dataSize < 16 || updateCRC32(0, data, patch.dataSize - 4) != readLE32(end - 4))
+		return invalid;
+	patch.sourceCRC = readLE32(end - 12);
+	auto actionsEnd = end - 12;
+	auto pos = data + 4;
+	if(patch.type == PatchType::UPS)
+	{
+		if(memcmp(data, "UPS1", 4) != 0 ||
+			!readVarInt(pos, actionsEnd, patch.sourceSize) ||
+			!readVarInt(pos, actionsEnd, patch.targetSize))
+		{
+			return invalid;
+		}
+		// each run XORs bytes up to a zero terminator, which also skips one byte
+		size_t offset = 0;
+		while(pos != actionsEnd)
+		{
+			size_t skip;
+			if(!readVarInt(pos, actionsEnd, skip))
+				return invalid;
+			offset += skip;
+			auto runEnd = (const uint8*)memchr(pos, 0, actionsEnd - pos);
+			if(!runEnd)
+				return invalid;
+			uint32 size = runEnd - pos;
+			if(size)
+				patch.record.emplace_back(PatchRecord{(uint32)offset, size, pos, 0});
+			offset += size + 1;
+			pos = runEnd + 1;
+		}
+		return {};
+	}
+	size_t metadataSize;
+	if(memcmp(data, "BPS1", 4) != 0 ||
+		!readVarInt(pos, actionsEnd, patch.sourceSize) ||
+		!readVarInt(pos, actionsEnd, patch.targetSize) ||
+		!readVarInt(pos, actionsEnd, metadataSize) ||
+		(size_t)(actionsEnd - pos) < metadataSize)
+	{
+		return invalid;
+	}
+	patch.actionsOffset = (pos + metadataSize) - data;
+	return {};
+}
+
+void RomLoader::applyStreamedPatch(uint8 *dest, size_t begin, size_t end) const
+{
+	// records are applied in file order since IPS records may overlap
+	for(auto &rec : patch.record)
+	{
+		size_t recBegin = std::max(begin, (size_t)rec.offset);
+		size_t recEnd = std::min(end, (size_t)rec.offset + rec.size);
+		if(recBegin >= recEnd)
+			continue;
+		auto size = recEnd - recBegin;
+		if(!rec.data)
+			memset(&dest[recBegin], rec.rleValue, size);
+		else if(patch.type == PatchType::IPS)
+			memcpy(&dest[recBegin], &rec.data[recBegin - rec.offset], size);
+		else
+		{
+			auto src = &rec.data[recBegin - rec.offset];
+			iterateTimes(size, i)
+			{
+				dest[recBegin + i] ^= src[i];
+			}
+		}
+	}
+}
+
+std::error_code RomLoader::applyBPS(uint8 *dest, size_t destSize)
+{
+	const std::error_code invalid{EINVAL, std::system_category()};
+	auto targetSize = patch.targetSize;
+	if(targetSize > destSize)
+		return {EFBIG, std::system_category()};
+	auto source = std::make_unique<uint8[]>(sourceSize_);
+	memcpy(source.get(), dest, sourceSize_);
+	const uint8 *pos = patch.data.get() + patch.actionsOffset;
+	auto actionsEnd = patch.data.get() + patch.dataSize - 12;
+	size_t outOffset = 0, sourceRelOffset = 0, targetRelOffset = 0;
+	while(pos != actionsEnd)
+	{
+		size_t action;
+		if(!readVarInt(pos, actionsEnd, action))
+			return invalid;
+		size_t len = (action >> 2) + 1;
+		if(len > targetSize - outOffset)
+			return invalid;
+		switch(action & 3)
+		{
+			case 0: // SourceRead
+				if(outOffset + len > sourceSize_)
+					return invalid;
+				memcpy(&dest[outOffset], &source[outOffset], len);
+				break;
+			case 1: // TargetRead
+				if((size_t)(actionsEnd - pos) < len)
+					return invalid;
+				memcpy(&dest[outOffset], pos, len);
+				pos += len;
+				break;
+			case 2: // SourceCopy
+			case 3: // TargetCopy
+			{
+				size_t data;
+				if(!readVarInt(pos, actionsEnd, data))
+					return invalid;
+				auto &relOffset = (action & 3) == 2 ? sourceRelOffset : targetRelOffset;
+				relOffset += (data & 1) ? -(data >> 1) : (data >> 1);
+				if((action & 3) == 2)
+				{
+					if(relOffset > sourceSize_ || len > sourceSize_ - relOffset)
+						return invalid;
+					memcpy(&dest[outOffset], &source[relOffset], len);
+				}
+				else
+				{
+					if(relOffset >= outOffset)
+						return invalid;
+					// may overlap the output on purpose to repeat a pattern
+					iterateTimes(len, i)
+					{
+						dest[outOffset + i] = dest[relOffset + i];
+					}
+				}
+				relOffset += len;
+				break;
+			}
+		}
+		outOffset += len;
+	}
+	if(outOffset != targetSize)
+		return invalid;
+	return {};
+}
+
+std::error_code RomLoader::load(IO &io, void *destPtr, size_t destSize)
+{
+	IG_TRACE_SPAN("RomLoader::load");
+	auto dest = (uint8*)destPtr;
+	auto flags = loadHashFlags();
+	bool streamPatch = hasStreamedPatch();
+	RomHasher hasher{flags, hashOffset, hashEnd()};
+	std::mutex mutex{};
+	std::condition_variable readCond{};
+	size_t readSize = 0;
+	bool readDone = false;
+	auto consumeData =
+		[&]()
+		{
+			size_t pos = 0;
+			while(true)
+			{
+				size_t end;
+				bool done;
+				{
+					std::unique_lock<std::mutex> lock{mutex};
+					readCond.wait(lock, [&](){ return readSize > pos || readDone; });
+					end = readSize;
+					done = readDone;
+				}
+				if(end > pos)
+				{
+					hasher.update(dest, pos, end);
+					if(streamPatch)
+						applyStreamedPatch(dest, pos, end);
+					pos = end;
+				}
+				if(done)
+					return;
+			}
+		};
+	std::error_code ec{};
+	{
+		bool useWorker = flags || streamPatch;
+		IG::ThreadPool::TaskGroup group{IG::ThreadPool::shared()};
+		if(useWorker)
+			group.run([&consumeData](){ consumeData(); });
+		size_t pos = 0;
+		while(pos < destSize)
+		{
+			auto bytes = io.read(&dest[pos], std::min(CHUNK_SIZE, destSize - pos));
+			if(bytes < 0)
+			{
+				ec = {EIO, std::system_category()};
+				break;
+			}
+			if(!bytes)
+				break;
+			pos += bytes;
+			if(useWorker)
+			{
+				{
+					std::lock_guard<std::mutex> lock{mutex};
+					readSize = pos;
+				}
+				readCond.notify_one();
+			}
+		}
+		{
+			std::lock_guard<std::mutex> lock{mutex};
+			readSize = pos;
+			readDone = true;
+		}
+		readCond.notify_one();
+		// runs the consumer here if no worker picked it up
+		group.wait();
+		sourceSize_ = size_ = pos;
+	}
+	if(ec)
+		return ec;
+	hashes_ = hasher.finish();
+	return finishPatch(dest, destSize);
+}
+
+// replaces the range with zeroed anonymous pages if it covers whole pages,
+// dropping whatever the last image left resident
+static bool resetPages(void *addr, size_t size)
+{
+	#if defined __linux__
+	auto page = (uintptr_t)pageSize();
+	if((uintptr_t)addr % page || size % page)
+		return false;
+	if(mmap(addr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED)
+	{
+		logErr("error resetting pages at %p", addr);
+		return false;
+	}
+	return true;
+	#else
+	return false;
+	#endif
+}
+
+std::error_code RomLoader::loadMapped(IO &io, void *destPtr, size_t destSize)
+{
+	IG_TRACE_SPAN("RomLoader::loadMapped");
+	auto dest = (uint8*)destPtr;
+	if(!resetPages(dest, destSize))
+	{
+		std::fill_n(dest, destSize, 0);
+		return load(io, destPtr, destSize);
+	}
+	size_t size = io.size();
+	if(size > destSize)
+		return load(io, destPtr, destSize);
+	if(auto ec = io.moveMappingTo(dest);
+		ec)
+	{
+		if(io)
+		{
+			// not a memory-mapped file, read into the zeroed pages
+			return load(io, destPtr, destSize);
+		}
+		return ec;
+	}
+	logMsg("mapped %zu byte image at %p", size, dest);
+	sourceSize_ = size_ = size;
+	// only pages the hash or patch touch get read in, only patched ones get copied
+	RomHasher hasher{loadHashFlags(), hashOffset, hashEnd()};
+	hasher.update(dest, 0, size);
+	hashes_ = hasher.finish();
+	if(hasStreamedPatch())
+		applyStreamedPatch(dest, 0, size);
+	return finishPatch(dest, destSize);
+}
+
+uint RomLoader::loadHashFlags() const
+{
+	if(patch.type == PatchType::UPS || patch.type == PatchType::BPS)
+		return hashFlags | HASH_CRC32; // to check the patch targets this image
+	return hashFlags;
+}
+
+bool RomLoader::hasStreamedPatch() const
+{
+	return patch.type == PatchType::IPS || patch.type == PatchType::UPS;
+}
+
+std::error_code RomLoader::finishPatch(uint8 *dest, size_t destSize)
+{
+	if(patch.type == PatchType::NONE)
+		return {};
+	if(patch.type != PatchType::IPS && (hashOffset || hashSize != SIZE_MAX))
+	{
+		logErr("%s patch can't be checked against a partial image hash", patchTypeName());
+		return {EINVAL, std::system_category()};
+	}
+	if(patch.type != PatchType::IPS &&
+		(patch.sourceSize != sourceSize_ || patch.sourceCRC != hashes_.crc32))
+	{
+		logErr("%s patch expects a %zu byte image with CRC32 %08X, got %zu bytes with %08X",
+			patchTypeName(), patch.sourceSize, patch.sourceCRC, sourceSize_, hashes_.crc32);
+		return {EINVAL, std::system_category()};
+	}
+	if(patch.type == PatchType::BPS)
+	{
+		if(auto ec = applyBPS(dest, destSize);
+			ec)
+		{
+			return ec;
+		}
+		size_ = patch.targetSize;
+	}
+	else
+	{
+		// records past the original end apply over zeros
+		size_t targetSize = patch.targetSize;
+		if(!targetSize)
+		{
+			// IPS without a truncation size grows to fit its last record
+			targetSize = sourceSize_;
+			for(auto &rec : patch.record)
+			{
+				targetSize = std::max(targetSize, (size_t)rec.offset + rec.size);
+			}
+		}
+		if(targetSize > destSize)
+			return {EFBIG, std::system_category()};
+		if(targetSize > sourceSize_)
+		{
+			memset(&dest[sourceSize_], 0, targetSize - sourceSize_);
+			applyStreamedPatch(dest, sourceSize_, targetSize);
+		}
+		size_ = targetSize;
+	}
+	logMsg("applied %s patch, size %zu -> %zu", patchTypeName(), sourceSize_, size_);
+	return {};
+}
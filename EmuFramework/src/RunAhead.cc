@@ -0,0 +1,123 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "RunAhead"
+#include <emuframework/EmuSystem.hh>
+#include <emuframework/EmuOptions.hh>
+#include <emuframework/StateBuffer.hh>
+#include <imagine/time/Time.hh>
+#include "private.hh"
+
+// Run-ahead shows the result of frames that haven't happened yet using the
+// current input, then rolls the system back to the real frame. Cores only
+// exist as a single instance so the roll back always goes through the
+// in-memory save state path.
+
+static StateBuffer runAheadState{};
+static double avgFrameSecs = 0, avgStateSecs = 0;
+static bool runAheadUnsupported = false;
+
+static void addCostSample(double &avg, double secs)
+{
+	// smooth out per frame variation while still following changes in the game
+	avg = avg ? avg * .9 + secs * .1 : secs;
+}
+
+static bool saveRunAheadState()
+{
+	if(auto err = EmuSystem::saveStateToBuffer(runAheadState);
+		err)
+	{
+		logErr("disabling run-ahead, error saving state:%s", err->what());
+		runAheadUnsupported = true;
+		return false;
+	}
+	return true;
+}
+
+static bool loadRunAheadState()
+{
+	if(auto err = EmuSystem::loadStateFromBuffer(runAheadState);
+		err)
+	{
+		logErr("disabling run-ahead, error loading state:%s", err->what());
+		runAheadUnsupported = true;
+		return false;
+	}
+	return true;
+}
+
+void runFrameWithRunAhead(EmuVideo *video, bool renderAudio)
+{
+	IG_TRACE_SPAN("runFrameWithRunAhead");
+	// whatever input is still queued belongs to the displayed frame
+	inputQueue.applyAll();
+	inputLog.addFrames(1);
+	uint frames = optionRunAheadFrames;
+	if(!frames || !video || runAheadUnsupported)
+	{
+		auto time = IG::timeFunc([&](){ EmuSystem::runFrame(video, renderAudio); });
+		if(video)
+			addCostSample(avgFrameSecs, time);
+		return;
+	}
+	// the real frame, only its audio is heard
+	auto frameStart = IG::Time::now();
+	EmuSystem::runFrame(nullptr, renderAudio);
+	auto stateStart = IG::Time::now();
+	if(!saveRunAheadState())
+	{
+		EmuSystem::runFrame(video, false);
+		return;
+	}
+	auto stateSecs = double(IG::Time::now() - stateStart);
+	iterateTimes(frames - 1, i)
+	{
+		EmuSystem::runFrame(nullptr, false);
+	}
+	EmuSystem::runFrame(video, false);
+	stateStart = IG::Time::now();
+	loadRunAheadState();
+	auto end = IG::Time::now();
+	stateSecs += double(end - stateStart);
+	addCostSample(avgStateSecs, stateSecs);
+	addCostSample(avgFrameSecs, (double(end - frameStart) - stateSecs) / (frames + 1));
+}
+
+double runAheadFrameCost(uint frames)
+{
+	if(!avgFrameSecs)
+		return 0;
+	if(!frames)
+		return avgFrameSecs;
+	if(runAheadUnsupported)
+		return 0;
+	if(!avgStateSecs)
+	{
+		// not measured yet, time a save & restore of the current state
+		auto start = IG::Time::now();
+		if(!saveRunAheadState() || !loadRunAheadState())
+			return 0;
+		avgStateSecs = double(IG::Time::now() - start);
+	}
+	return avgFrameSecs * (frames + 1) + avgStateSecs;
+}
+
+void resetRunAhead()
+{
+	runAheadState = {};
+	avgFrameSecs = avgStateSecs = 0;
+	runAheadUnsupported = false;
+}
@@ -0,0 +1,165 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "SaveFileWriter"
+#include <emuframework/SaveFileWriter.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/fs/FS.hh>
+#include <imagine/thread/Thread.hh>
+#include <imagine/logger/Trace.hh>
+#include <imagine/logger/logger.h>
+#include <algorithm>
+#include <cstring>
+
+SaveFileWriter saveFileWriter{};
+
+static uint64_t fnv1aHash(const void *data, size_t size)
+{
+	auto bytes = (const uint8*)data;
+	uint64_t hash = 0xcbf29ce484222325;
+	iterateTimes(size, i)
+	{
+		hash = (hash ^ bytes[i]) * 0x100000001b3;
+	}
+	return hash;
+}
+
+void SaveFileWriter::write(const char *path, StateBuffer buff)
+{
+	queue({FS::makePathString(path), std::move(buff), nullptr});
+}
+
+std::error_code SaveFileWriter::writeIfChanged(const char *path, const void *data, size_t size)
+{
+	auto hash = fnv1aHash(data, size);
+	bool checkFile = false;
+	std::error_code lastError{};
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		if(auto f = findFileHash(path);
+			f)
+		{
+			lastError = f->lastError;
+			if(hash == f->hash)
+			{
+				logMsg("%s unchanged, skipping write", path);
+				return lastError;
+			}
+			f->hash = hash;
+		}
+		else
+		{
+			// first write to this file since launch, the writer thread compares it against what's on disk
+			fileHashes.push_back({FS::makePathString(path), hash});
+			checkFile = true;
+		}
+	}
+	StateBuffer buff;
+	buff.assign(data, size);
+	queue({FS::makePathString(path), std::move(buff), nullptr, checkFile});
+	return lastError;
+}
+
+void SaveFileWriter::flush()
+{
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		if(!threadStarted)
+			return;
+	}
+	IG::Semaphore done{0};
+	queue({{}, {}, &done});
+	done.wait();
+}
+
+void SaveFileWriter::queue(Job job)
+{
+	std::lock_guard<std::mutex> lock{mutex};
+	if(!job.done)
+	{
+		auto sameFile = std::find_if(jobs.begin(), jobs.end(),
+			[&](const Job &j){ return !j.done && !strcmp(j.path.data(), job.path.data()); });
+		if(sameFile != jobs.end())
+		{
+			// the newer data supersedes a write that hasn't started yet
+			sameFile->buff = std::move(job.buff);
+			sameFile->checkFile |= job.checkFile;
+			return;
+		}
+	}
+	jobs.emplace_back(std::move(job));
+	jobSem.notify();
+	if(threadStarted)
+		return;
+	threadStarted = true;
+	IG::makeDetachedThread(
+		[this]()
+		{
+			IG_TRACE_THREAD_NAME("SaveFileWriter");
+			// runs for the life of the process, flush() before exiting
+			while(true)
+			{
+				jobSem.wait();
+				Job job;
+				{
+					std::lock_guard<std::mutex> lock{mutex};
+					job = std::move(jobs.front());
+					jobs.pop_front();
+				}
+				if(job.done)
+				{
+					job.done->notify();
+					continue;
+				}
+				IG_TRACE_SPAN("SaveFileWriter::write");
+				if(job.checkFile && fileMatches(job.path.data(), job.buff.data(), job.buff.size()))
+				{
+					logMsg("%s unchanged, skipping write", job.path.data());
+					continue;
+				}
+				auto ec = writeToNewFileAtomic(job.path.data(), job.buff.data(), job.buff.size());
+				if(ec)
+					logErr("error writing %s", job.path.data());
+				else
+					logMsg("wrote %u bytes to %s", (uint)job.buff.size(), job.path.data());
+				std::lock_guard<std::mutex> lock{mutex};
+				if(auto f = findFileHash(job.path.data());
+					f)
+				{
+					f->lastError = ec;
+					// force the next writeIfChanged() to retry
+					if(ec)
+						f->hash = 0;
+				}
+			}
+		});
+}
+
+SaveFileWriter::FileHash *SaveFileWriter::findFileHash(const char *path)
+{
+	auto it = std::find_if(fileHashes.begin(), fileHashes.end(),
+		[&](const FileHash &f){ return !strcmp(f.path.data(), path); });
+	return it != fileHashes.end() ? &(*it) : nullptr;
+}
+
+bool SaveFileWriter::fileMatches(const char *path, const void *data, size_t size)
+{
+	FileIO file;
+	file.open(path, IO::AccessHint::ALL);
+	if(!file || file.size() != size)
+		return false;
+	auto fileData = file.mmapConst();
+	return fileData && !memcmp(fileData, data, size);
+}
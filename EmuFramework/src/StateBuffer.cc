@@ -0,0 +1,113 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/StateBuffer.hh>
+#include <algorithm>
+#include <cstring>
+
+void StateBuffer::reserve(size_t capacity)
+{
+	if(capacity <= capacity_)
+		return;
+	std::unique_ptr<uint8[]> newBuff{new uint8[capacity]};
+	if(size_)
+		memcpy(newBuff.get(), buff.get(), size_);
+	buff = std::move(newBuff);
+	capacity_ = capacity;
+}
+
+void StateBuffer::resize(size_t size)
+{
+	if(size > capacity_)
+		reserve(std::max(size, capacity_ * 2));
+	size_ = size;
+}
+
+void StateBuffer::assign(const void *data, size_t size)
+{
+	clear();
+	append(data, size);
+}
+
+void StateBuffer::append(const void *data, size_t size)
+{
+	auto offset = size_;
+	resize(size_ + size);
+	memcpy(buff.get() + offset, data, size);
+}
+
+void StateBufferStreamBuf::setForWrite(StateBuffer &buff)
+{
+	writeBuff = &buff;
+	buff.clear();
+	setg(nullptr, nullptr, nullptr);
+}
+
+void StateBufferStreamBuf::setForRead(const StateBuffer &buff)
+{
+	writeBuff = {};
+	auto data = (char_type*)buff.data();
+	setg(data, data, data + buff.size());
+}
+
+std::streamsize StateBufferStreamBuf::xsputn(const char_type *s, std::streamsize count)
+{
+	if(!writeBuff)
+		return 0;
+	writeBuff->append(s, count);
+	return count;
+}
+
+StateBufferStreamBuf::int_type StateBufferStreamBuf::overflow(int_type ch)
+{
+	if(!writeBuff)
+		return traits_type::eof();
+	if(traits_type::eq_int_type(ch, traits_type::eof()))
+		return traits_type::not_eof(ch);
+	char_type c = traits_type::to_char_type(ch);
+	writeBuff->append(&c, 1);
+	return ch;
+}
+
+StateBufferStreamBuf::pos_type StateBufferStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+	if(writeBuff)
+	{
+		// only the current end position is supported when writing
+		if(off != 0 && !(dir == std::ios_base::beg && off == (off_type)writeBuff->size()))
+			return pos_type(off_type(-1));
+		if(dir == std::ios_base::beg)
+			return pos_type(off);
+		return pos_type(off_type(writeBuff->size()));
+	}
+	off_type base = dir == std::ios_base::beg ? 0 :
+		dir == std::ios_base::cur ? gptr() - eback() : egptr() - eback();
+	off_type pos = base + off;
+	if(pos < 0 || pos > egptr() - eback())
+		return pos_type(off_type(-1));
+	setg(eback(), eback() + pos, egptr());
+	return pos_type(pos);
+}
+
+StateBufferStreamBuf::pos_type StateBufferStreamBuf::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+	if(writeBuff && off_type(pos) == 0)
+	{
+		// rewinding a write stream starts the state over
+		writeBuff->clear();
+		return pos;
+	}
+	return seekoff(off_type(pos), std::ios_base::beg, which);
+}
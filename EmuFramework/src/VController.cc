@@ -725,7 +725,7 @@ void VController::inputAction(uint action, uint vBtn)
 	if(isInKeyboardMode())
 	{
 		assert(vBtn < IG::size(kbMap));
-		EmuSystem::handleInputAction(action, kbMap[vBtn]);
+		inputQueue.push(IG::Time::now(), action, kbMap[vBtn]);
 	}
 	else
 	{
@@ -743,7 +743,7 @@ void VController::inputAction(uint action, uint vBtn)
 				turboActions.removeEvent(keyCode);
 			}
 		}
-		EmuSystem::handleInputAction(action, keyCode);
+		inputQueue.push(IG::Time::now(), action, keyCode);
 	}
 }
 
@@ -16,6 +16,7 @@
 	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
 
 #include <memory>
+#include <mutex>
 #include <imagine/base/Base.hh>
 #include <imagine/input/Input.hh>
 #include <imagine/gui/NavView.hh>
@@ -28,6 +29,11 @@
 #include <emuframework/EmuSystem.hh>
 #include <emuframework/MsgPopup.hh>
 #include <emuframework/Recent.hh>
+#include <emuframework/Rewind.hh>
+#include <emuframework/FrameTelemetry.hh>
+#include <emuframework/SaveFileWriter.hh>
+#include <emuframework/InputQueue.hh>
+#include <emuframework/InputLog.hh>
 
 enum AssetID { ASSET_ARROW, ASSET_CLOSE, ASSET_ACCEPT, ASSET_GAME_ICON, ASSET_MENU, ASSET_FAST_FORWARD };
 
@@ -69,6 +75,10 @@ extern DelegateFunc<void ()> onUpdateInputDevices;
 extern FS::PathString lastLoadPath;
 extern MsgPopup popup;
 extern EmuVideo emuVideo;
+extern RewindManager rewindManager;
+extern FrameTelemetry frameTelemetry;
+extern InputQueue inputQueue;
+extern InputLog inputLog;
 extern EmuInputView emuInputView;
 extern StaticArrayList<RecentGameInfo, RecentGameInfo::MAX_RECENT> recentGameList;
 static constexpr const char *strftimeFormat = "%x  %r";
@@ -89,6 +99,7 @@ void onMainMenuItemOptionChanged();
 void placeEmuViews();
 void placeElements();
 void runBenchmarkOneShot();
+void runBenchmarkOnDirectoryOneShot(const char *path);
 void onSelectFileFromPicker(Gfx::Renderer &r, const char* name, Input::Event e);
 void startGameFromMenu();
 void closeGame(bool allowAutosaveState = true);
@@ -98,6 +109,25 @@ Gfx::PixmapTexture &getAsset(Gfx::Renderer &r, AssetID assetID);
 ViewAttachParams emuViewAttachParams();
 View *makeView(ViewAttachParams attach, EmuApp::ViewID id);
 void updateAndDrawEmuVideo();
+void postDrawToEmuWindows();
+void startEmulationThread();
+void stopEmulationThread();
+bool emulationThreadIsActive();
+// queues frames to run, all but the last are skipped up to maxFrameSkip,
+// batchTime is when the last frame is due and spaces out queued input
+void postFramesToEmulationThread(uint frames, uint maxFrameSkip, bool fastForward, IG::Time batchTime, bool muteAudio = false);
+// holds the emulation thread between frames while the lock is owned
+std::unique_lock<std::mutex> lockEmulationThread();
+// runs a displayed frame, running ahead optionRunAheadFrames to hide the game's input lag
+void runFrameWithRunAhead(EmuVideo *video, bool renderAudio);
+// estimated seconds to run a displayed frame with the given run-ahead, 0 if unknown
+double runAheadFrameCost(uint frames);
+void resetRunAhead();
+// snapshots a state with the same contents EmuSystem::saveState() writes to a file,
+// unlike EmuSystem::saveStateToBuffer() which a core may override with its own format
+EmuSystem::Error saveStateFileToBuffer(StateBuffer &buff);
+bool isHeadlessLaunch(int argc, char** argv);
+int runHeadless(int argc, char** argv);
 
 static void addRecentGame()
 {
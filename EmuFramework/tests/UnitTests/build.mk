@@ -0,0 +1,24 @@
+ifndef inc_main
+inc_main := 1
+
+include $(IMAGINE_PATH)/make/imagineAppBase.mk
+
+EMUFRAMEWORK_PATH ?= $(projectPath)/../..
+
+# the code under test is built in directly instead of linking EmuFramework,
+# which needs an emulator core to implement EmuSystem
+VPATH += $(EMUFRAMEWORK_PATH)/src
+CPPFLAGS += -I$(EMUFRAMEWORK_PATH)/include
+
+SRC += main/main.cc main/RewindTest.cc main/RomLoaderTest.cc \
+Rewind.cc StateBuffer.cc RomLoader.cc
+
+include $(IMAGINE_PATH)/make/package/imagine.mk
+
+ifndef target
+target := EmuFrameworkUnitTests
+endif
+
+include $(IMAGINE_PATH)/make/imagineAppTarget.mk
+
+endif
@@ -0,0 +1,151 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/Rewind.hh>
+#include <emuframework/EmuSystem.hh>
+#include <algorithm>
+#include <vector>
+#include "test.hh"
+
+// stands in for a core's save state
+static std::vector<uint8> emuState{};
+
+EmuSystem::Error EmuSystem::saveStateToBuffer(StateBuffer &buff)
+{
+	buff.assign(emuState.data(), emuState.size());
+	return {};
+}
+
+EmuSystem::Error EmuSystem::loadStateFromBuffer(const StateBuffer &buff)
+{
+	emuState.assign(buff.data(), buff.data() + buff.size());
+	return {};
+}
+
+// Pushes deltas of chosen sizes straight into the ring, each filled with its
+// own byte value kept in the entry's stateSize, so entries the ring should
+// have dropped before overwriting show up as overlapping or corrupted
+class RingTestManager : public RewindManager
+{
+public:
+	void push(uint size, uint8 fill)
+	{
+		encodeBuff.resize(size);
+		std::fill_n(encodeBuff.data(), size, fill);
+		pushEntry(fill);
+	}
+
+	uint entryCount() const { return entries.size(); }
+
+	bool newestIs(uint size, uint8 fill) const
+	{
+		return entries.size() && entries.back().size == size && entries.back().stateSize == fill;
+	}
+
+	void checkEntries() const
+	{
+		for(auto it = entries.begin(); it != entries.end(); ++it)
+		{
+			auto &e = *it;
+			TEST_CHECK(e.offset + e.size <= ringSize);
+			TEST_CHECK(std::all_of(&ring[e.offset], &ring[e.offset + e.size],
+				[&](uint8 b){ return b == e.stateSize; }));
+			for(auto other = std::next(it); other != entries.end(); ++other)
+			{
+				TEST_CHECK(e.offset + e.size <= other->offset || other->offset + other->size <= e.offset);
+			}
+		}
+	}
+};
+
+static void testWrapEviction()
+{
+	// the write position wraps to 0 while the oldest entry sits past the end of the newest
+	RingTestManager rewind{};
+	rewind.setMemoryLimit(100);
+	const uint sizes[]{50, 40, 5, 30, 10, 15, 50};
+	uint8 fill = 1;
+	for(auto size : sizes)
+	{
+		rewind.push(size, fill);
+		TEST_CHECK(rewind.newestIs(size, fill));
+		rewind.checkEntries();
+		fill++;
+	}
+	rewind.deinit();
+}
+
+static void testMixedSizes()
+{
+	RingTestManager rewind{};
+	rewind.setMemoryLimit(256);
+	uint32 seed = 1;
+	for(uint i = 0; i < 2000; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		uint size = 1 + (seed >> 16) % 80;
+		uint8 fill = 1 + i % 255;
+		rewind.push(size, fill);
+		TEST_CHECK(rewind.newestIs(size, fill));
+		rewind.checkEntries();
+	}
+	// a delta bigger than the ring clears the history
+	rewind.push(257, 1);
+	TEST_CHECK(!rewind.entryCount());
+	rewind.deinit();
+}
+
+static void makeState(uint frame)
+{
+	// sizes vary so deltas also have to grow & shrink the state
+	emuState.resize(200 + (frame % 3) * 8);
+	for(size_t i = 0; i < emuState.size(); i++)
+	{
+		emuState[i] = i * 7 + (i % 13 == frame % 13 ? frame : 0);
+	}
+}
+
+static void testRewindRestoresHistory()
+{
+	RewindManager rewind{};
+	// small enough that the oldest states get dropped
+	rewind.setMemoryLimit(1024);
+	rewind.setInterval(1);
+	const uint frames = 100;
+	for(uint frame = 0; frame < frames; frame++)
+	{
+		makeState(frame);
+		rewind.onFramesRun(1);
+	}
+	auto snapshots = rewind.snapshots();
+	TEST_CHECK(snapshots > 1 && snapshots < frames);
+	// each step back restores the state captured one frame earlier
+	for(uint i = 0; i < snapshots; i++)
+	{
+		TEST_CHECK(rewind.rewind());
+		auto restored = emuState;
+		makeState(frames - 1 - i);
+		TEST_CHECK(restored == emuState);
+	}
+	TEST_CHECK(!rewind.rewind());
+	rewind.deinit();
+}
+
+void runRewindTests()
+{
+	testWrapEviction();
+	testMixedSizes();
+	testRewindRestoresHistory();
+}
@@ -0,0 +1,410 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/RomLoader.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/io/BufferMapIO.hh>
+#include <imagine/fs/FS.hh>
+#include <imagine/util/system/pagesize.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "test.hh"
+
+using Bytes = std::vector<uint8>;
+
+static const uint ALL_HASHES = RomLoader::HASH_CRC32 | RomLoader::HASH_MD5 | RomLoader::HASH_SHA1;
+
+// bitwise CRC32, independent of RomLoader's table version, for building UPS & BPS patches
+static uint32 crc32(const Bytes &data)
+{
+	uint32 crc = 0xFFFFFFFF;
+	for(size_t i = 0; i < data.size(); i++)
+	{
+		crc ^= data[i];
+		for(uint b = 0; b < 8; b++)
+		{
+			crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+		}
+	}
+	return ~crc;
+}
+
+static Bytes makeData(size_t size, uint mul)
+{
+	Bytes data(size);
+	for(size_t i = 0; i < size; i++)
+	{
+		data[i] = i * mul;
+	}
+	return data;
+}
+
+static void appendLE32(Bytes &out, uint32 val)
+{
+	for(uint i = 0; i < 4; i++)
+	{
+		out.push_back(val >> (i * 8));
+	}
+}
+
+static void appendVarInt(Bytes &out, size_t val)
+{
+	while(true)
+	{
+		uint8 x = val & 0x7f;
+		val >>= 7;
+		if(!val)
+		{
+			out.push_back(0x80 | x);
+			return;
+		}
+		out.push_back(x);
+		val--;
+	}
+}
+
+// ends a UPS or BPS patch with its source, target and own CRC32s
+static void appendCRCs(Bytes &patch, const Bytes &source, const Bytes &target)
+{
+	appendLE32(patch, crc32(source));
+	appendLE32(patch, crc32(target));
+	appendLE32(patch, crc32(patch));
+}
+
+static Bytes makeUPS(const Bytes &source, const Bytes &target)
+{
+	Bytes patch{'U', 'P', 'S', '1'};
+	appendVarInt(patch, source.size());
+	appendVarInt(patch, target.size());
+	auto xorAt = [&](size_t i) -> uint8
+		{
+			return (i < source.size() ? source[i] : 0) ^ target[i];
+		};
+	size_t lastEnd = 0;
+	for(size_t i = 0; i < target.size();)
+	{
+		if(!xorAt(i))
+		{
+			i++;
+			continue;
+		}
+		appendVarInt(patch, i - lastEnd);
+		for(; i < target.size() && xorAt(i); i++)
+		{
+			patch.push_back(xorAt(i));
+		}
+		patch.push_back(0);
+		lastEnd = ++i;
+	}
+	appendCRCs(patch, source, target);
+	return patch;
+}
+
+static bool writeFile(const char *path, const Bytes &data)
+{
+	FileIO io{};
+	if(io.create(path))
+		return false;
+	return io.write(data.data(), data.size()) == (ssize_t)data.size();
+}
+
+// loads source from memory, destSize defaults to leaving room for patches to grow it
+static Bytes loadBytes(RomLoader &loader, const Bytes &source, std::error_code &ec, size_t destSize = 0)
+{
+	BufferMapIO io{};
+	// an empty vector's null data would read as an unopened IO
+	static const uint8 emptyData{};
+	io.open(source.size() ? source.data() : &emptyData, source.size());
+	Bytes dest(destSize ? destSize : source.size() + 4096);
+	ec = loader.load(io, dest.data(), dest.size());
+	dest.resize(ec ? 0 : loader.size());
+	return dest;
+}
+
+// temporary directory holding a ROM's patch file
+class PatchDir
+{
+public:
+	PatchDir()
+	{
+		char tmpl[] = "/tmp/RomLoaderTest.XXXXXX";
+		if(mkdtemp(tmpl))
+			path = FS::makePathString(tmpl);
+		basePath = FS::makePathStringPrintf("%s/rom", path.data());
+	}
+
+	~PatchDir()
+	{
+		for(auto ext : {"ips", "ups", "bps"})
+		{
+			FS::remove(FS::makePathStringPrintf("%s.%s", basePath.data(), ext));
+		}
+		rmdir(path.data());
+	}
+
+	bool setPatch(const char *ext, const Bytes &patch)
+	{
+		return writeFile(FS::makePathStringPrintf("%s.%s", basePath.data(), ext).data(), patch);
+	}
+
+	FS::PathString basePath{};
+
+private:
+	FS::PathString path{};
+};
+
+static void testHashes()
+{
+	struct Vector
+	{
+		Bytes data;
+		uint32 crc32;
+		const char *md5;
+		const char *sha1;
+	};
+	const Vector vectors[]
+	{
+		{{}, 0, "d41d8cd98f00b204e9800998ecf8427e", "da39a3ee5e6b4b0d3255bfef95601890afd80709"},
+		{{'a', 'b', 'c'}, 0x352441c2, "900150983cd24fb0d6963f7d28e17f72", "a9993e364706816aba3e25717850c26c9cd0d89d"},
+		// crosses several read chunks
+		{Bytes(1000000, 'a'), 0xdc25bfbc, "7707d6ae4e027c70eea2a935c2296f21", "34aa973cd4c4daa4f61eeb2bdbad27316534016f"},
+	};
+	for(auto &v : vectors)
+	{
+		RomLoader loader{ALL_HASHES};
+		std::error_code ec{};
+		auto data = loadBytes(loader, v.data, ec, std::max(v.data.size(), (size_t)1));
+		TEST_CHECK(!ec);
+		TEST_CHECK(data == v.data);
+		TEST_CHECK(loader.hashes().crc32 == v.crc32);
+		TEST_CHECK(!strcmp(loader.hashes().md5String().data(), v.md5));
+		TEST_CHECK(!strcmp(loader.hashes().sha1String().data(), v.sha1));
+	}
+	TEST_CHECK(crc32(Bytes{'1', '2', '3', '4', '5', '6', '7', '8', '9'}) == 0xcbf43926);
+}
+
+// a hash range gives the same hashes as loading only that part of the image
+static void testHashRange()
+{
+	auto data = makeData(700000, 7);
+	const size_t offset = 512, size = 400000;
+	RomLoader loader{ALL_HASHES};
+	loader.setHashRange(offset, size);
+	std::error_code ec{};
+	TEST_CHECK(loadBytes(loader, data, ec) == data);
+	Bytes part{&data[offset], &data[offset + size]};
+	RomLoader partLoader{ALL_HASHES};
+	loadBytes(partLoader, part, ec);
+	TEST_CHECK(loader.hashes().crc32 == partLoader.hashes().crc32);
+	TEST_CHECK(loader.hashes().md5 == partLoader.hashes().md5);
+	TEST_CHECK(loader.hashes().sha1 == partLoader.hashes().sha1);
+	// without a range the whole image is hashed
+	RomLoader wholeLoader{ALL_HASHES};
+	loadBytes(wholeLoader, data, ec);
+	TEST_CHECK(!strcmp(wholeLoader.hashes().sha1String().data(), "eefb9a469163232b6f41c16c428826eb43542b00"));
+}
+
+static void testIPS()
+{
+	PatchDir dir{};
+	auto source = makeData(600000, 3);
+	auto expected = source;
+	Bytes patch{'P', 'A', 'T', 'C', 'H'};
+	// literal record straddling a read chunk boundary
+	patch.insert(patch.end(), {0x03, 0xFF, 0xFE, 0x00, 0x04, 'W', 'X', 'Y', 'Z'});
+	memcpy(&expected[0x3FFFE], "WXYZ", 4);
+	// RLE record
+	patch.insert(patch.end(), {0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x20, 0xAA});
+	std::fill_n(&expected[0x10], 0x20, 0xAA);
+	// later record overlapping the first wins
+	patch.insert(patch.end(), {0x03, 0xFF, 0xFF, 0x00, 0x01, 'q'});
+	expected[0x3FFFF] = 'q';
+	// record past the end grows the image
+	patch.insert(patch.end(), {0x09, 0x27, 0xC0, 0x00, 0x02, 0x11, 0x22});
+	expected.resize(600002);
+	expected[600000] = 0x11;
+	expected[600001] = 0x22;
+	patch.insert(patch.end(), {'E', 'O', 'F'});
+	TEST_CHECK(dir.setPatch("ips", patch));
+	RomLoader loader{ALL_HASHES};
+	TEST_CHECK(!loader.findPatch(dir.basePath.data()));
+	TEST_CHECK(loader.patchType() == RomLoader::PatchType::IPS);
+	std::error_code ec{};
+	TEST_CHECK(loadBytes(loader, source, ec) == expected);
+	TEST_CHECK(!ec);
+	TEST_CHECK(loader.sourceSize() == source.size());
+	TEST_CHECK(loader.hashes().crc32 == crc32(source));
+	// truncation size after EOF
+	patch.insert(patch.end(), {0x00, 0x01, 0x00});
+	TEST_CHECK(dir.setPatch("ips", patch));
+	RomLoader truncLoader{};
+	TEST_CHECK(!truncLoader.findPatch(dir.basePath.data()));
+	expected.resize(0x100);
+	TEST_CHECK(loadBytes(truncLoader, source, ec) == expected);
+	// a patch that doesn't fit the destination is an error
+	RomLoader bigLoader{};
+	TEST_CHECK(dir.setPatch("ips", {'P', 'A', 'T', 'C', 'H', 0x10, 0x00, 0x00, 0x00, 0x01, 0x00, 'E', 'O', 'F'}));
+	TEST_CHECK(!bigLoader.findPatch(dir.basePath.data()));
+	loadBytes(bigLoader, source, ec, source.size());
+	TEST_CHECK(ec);
+	// truncated records are rejected when parsed
+	RomLoader badLoader{};
+	TEST_CHECK(dir.setPatch("ips", {'P', 'A', 'T', 'C', 'H', 0x00, 0x00, 0x10, 0x00, 0x08, 0x01}));
+	TEST_CHECK(badLoader.findPatch(dir.basePath.data()));
+	TEST_CHECK(badLoader.patchType() == RomLoader::PatchType::NONE);
+}
+
+static void testUPS()
+{
+	auto source = makeData(300000, 5);
+	for(size_t targetSize : {source.size(), source.size() + 1000, source.size() - 1000})
+	{
+		PatchDir dir{};
+		auto target = makeData(targetSize, 5);
+		// scattered changes including runs across read chunks
+		for(size_t i = 17; i < targetSize; i += 70001)
+		{
+			for(size_t j = i; j < std::min(i + 300, targetSize); j++)
+			{
+				target[j] ^= 0x5A;
+			}
+		}
+		TEST_CHECK(dir.setPatch("ups", makeUPS(source, target)));
+		RomLoader loader{};
+		TEST_CHECK(!loader.findPatch(dir.basePath.data()));
+		TEST_CHECK(loader.patchType() == RomLoader::PatchType::UPS);
+		std::error_code ec{};
+		TEST_CHECK(loadBytes(loader, source, ec) == target);
+		TEST_CHECK(!ec);
+		// made for a different image
+		RomLoader wrongLoader{};
+		TEST_CHECK(!wrongLoader.findPatch(dir.basePath.data()));
+		loadBytes(wrongLoader, makeData(source.size(), 6), ec);
+		TEST_CHECK(ec);
+	}
+	// a corrupted patch fails its own CRC
+	PatchDir dir{};
+	auto patch = makeUPS(source, makeData(source.size(), 9));
+	patch[8] ^= 1;
+	TEST_CHECK(dir.setPatch("ups", patch));
+	RomLoader loader{};
+	TEST_CHECK(loader.findPatch(dir.basePath.data()));
+}
+
+static void appendBPSAction(Bytes &patch, uint type, size_t len)
+{
+	appendVarInt(patch, ((len - 1) << 2) | type);
+}
+
+static void appendBPSOffset(Bytes &patch, long relOffset)
+{
+	appendVarInt(patch, (std::labs(relOffset) << 1) | (relOffset < 0));
+}
+
+static void testBPS()
+{
+	PatchDir dir{};
+	auto source = makeData(1000, 11);
+	Bytes target{};
+	Bytes patch{'B', 'P', 'S', '1'};
+	Bytes actions{};
+	// SourceRead of the first 100 bytes
+	appendBPSAction(actions, 0, 100);
+	target.insert(target.end(), &source[0], &source[100]);
+	// TargetRead of new bytes
+	appendBPSAction(actions, 1, 4);
+	actions.insert(actions.end(), {'A', 'B', 'C', 'D'});
+	target.insert(target.end(), {'A', 'B', 'C', 'D'});
+	// TargetCopy overlapping its own output repeats "ABCD"
+	appendBPSAction(actions, 3, 10);
+	appendBPSOffset(actions, 100);
+	for(uint i = 0; i < 10; i++)
+	{
+		target.push_back(target[100 + i]);
+	}
+	// SourceCopy forward then back
+	appendBPSAction(actions, 2, 50);
+	appendBPSOffset(actions, 500);
+	target.insert(target.end(), &source[500], &source[550]);
+	appendBPSAction(actions, 2, 20);
+	appendBPSOffset(actions, -540);
+	target.insert(target.end(), &source[10], &source[30]);
+	appendVarInt(patch, source.size());
+	appendVarInt(patch, target.size());
+	appendVarInt(patch, 0); // no metadata
+	patch.insert(patch.end(), actions.begin(), actions.end());
+	appendCRCs(patch, source, target);
+	TEST_CHECK(dir.setPatch("bps", patch));
+	RomLoader loader{};
+	TEST_CHECK(!loader.findPatch(dir.basePath.data()));
+	TEST_CHECK(loader.patchType() == RomLoader::PatchType::BPS);
+	std::error_code ec{};
+	TEST_CHECK(loadBytes(loader, source, ec) == target);
+	TEST_CHECK(!ec);
+	// checking the source needs the whole image hashed
+	RomLoader rangeLoader{};
+	TEST_CHECK(!rangeLoader.findPatch(dir.basePath.data()));
+	rangeLoader.setHashRange(16, SIZE_MAX);
+	loadBytes(rangeLoader, source, ec);
+	TEST_CHECK(ec);
+	// made for a different image
+	RomLoader wrongLoader{};
+	TEST_CHECK(!wrongLoader.findPatch(dir.basePath.data()));
+	loadBytes(wrongLoader, makeData(source.size(), 12), ec);
+	TEST_CHECK(ec);
+}
+
+// loadMapped() from a memory-mapped file gives the same image and hashes as load()
+static void testLoadMapped()
+{
+	PatchDir dir{};
+	auto source = makeData(300000, 13);
+	auto romPath = FS::makePathStringPrintf("%s.bin", dir.basePath.data());
+	TEST_CHECK(writeFile(romPath.data(), source));
+	Bytes ips{'P', 'A', 'T', 'C', 'H', 0x00, 0x10, 0x00, 0x00, 0x03, 'x', 'y', 'z', 'E', 'O', 'F'};
+	TEST_CHECK(dir.setPatch("ips", ips));
+	auto expected = source;
+	memcpy(&expected[0x1000], "xyz", 3);
+	auto destSize = roundUpToPageSize(source.size() + 4096);
+	auto dest = (uint8*)mmap(nullptr, destSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	TEST_CHECK(dest != MAP_FAILED);
+	if(dest == MAP_FAILED)
+		return;
+	FileIO io{};
+	TEST_CHECK(!io.open(romPath.data(), IO::AccessHint::ALL));
+	RomLoader loader{ALL_HASHES};
+	TEST_CHECK(!loader.findPatch(dir.basePath.data()));
+	TEST_CHECK(!loader.loadMapped(io, dest, destSize));
+	TEST_CHECK(loader.size() == expected.size());
+	TEST_CHECK(!memcmp(dest, expected.data(), expected.size()));
+	TEST_CHECK(std::all_of(dest + expected.size(), dest + destSize, [](uint8 b){ return !b; }));
+	TEST_CHECK(loader.hashes().crc32 == crc32(source));
+	munmap(dest, destSize);
+	FS::remove(romPath);
+}
+
+void runRomLoaderTests()
+{
+	testHashes();
+	testHashRange();
+	testIPS();
+	testUPS();
+	testBPS();
+	testLoadMapped();
+}
@@ -0,0 +1,41 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "main"
+#include <imagine/base/Base.hh>
+#include "test.hh"
+
+uint testFailures = 0;
+
+static void runTests(const char *name, void(*tests)())
+{
+	auto failures = testFailures;
+	tests();
+	fprintf(stderr, "%s: %s\n", name, testFailures == failures ? "passed" : "FAILED");
+}
+
+namespace Base
+{
+
+// run with --headless so no window system is needed,
+// the exit status is non-zero if any check failed
+void onInit(int argc, char** argv)
+{
+	runTests("Rewind", runRewindTests);
+	runTests("RomLoader", runRomLoaderTests);
+	Base::exit(testFailures ? 1 : 0);
+}
+
+}
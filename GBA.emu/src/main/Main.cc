@@ -16,6 +16,7 @@
 #define LOGTAG "main"
 #include <emuframework/EmuApp.hh>
 #include <emuframework/EmuAppInlines.hh>
+#include <emuframework/RomLoader.hh>
 #include "internal.hh"
 #include "Cheats.hh"
 #include <vbam/gba/GBA.h>
@@ -108,6 +109,30 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 		return makeFileReadError();
 }
 
+EmuSystem::Error EmuSystem::saveStateToBuffer(StateBuffer &buff)
+{
+	// Uncompressed since rewind & run-ahead snapshot every frame. The buffer
+	// only grows until the state first fits, then it's reused as-is.
+	buff.resize(std::max(buff.capacity(), (size_t)0x80000));
+	int size;
+	while(!(size = CPUWriteRawState(gGba, (char*)buff.data(), buff.size())))
+	{
+		if(buff.size() >= 0x1000000)
+			return makeFileWriteError();
+		buff.resize(buff.size() * 2);
+	}
+	buff.resize(size);
+	return {};
+}
+
+EmuSystem::Error EmuSystem::loadStateFromBuffer(const StateBuffer &buff)
+{
+	if(CPUReadRawState(gGba, (const char*)buff.data(), buff.size()))
+		return {};
+	else
+		return makeFileReadError();
+}
+
 void EmuSystem::saveBackupMem()
 {
 	if(gameIsRunning())
@@ -130,54 +155,57 @@ void EmuSystem::closeSystem()
 	cheatsNumber = 0; // reset cheat list
 }
 
-static EmuSystem::Error applyGamePatches(const char *patchDir, const char *romName, u8 *rom, int &romSize)
+static EmuSystem::Error applyPPFPatch(const char *patchDir, const char *romName, u8 *rom, int &romSize)
 {
-	auto patchStr = FS::makePathStringPrintf("%s/%s.ips", patchDir, romName);
-	if(FS::exists(patchStr.data()))
-	{
-		logMsg("applying IPS patch: %s", patchStr.data());
-		if(!patchApplyIPS(patchStr.data(), &rom, &romSize))
-		{
-			return EmuSystem::makeError("Error applying IPS patch");
-		}
-		return {};
-	}
-	string_printf(patchStr, "%s/%s.ups", patchDir, romName);
+	// IPS, UPS & BPS patches are applied by RomLoader as the ROM streams in
+	auto patchStr = FS::makePathStringPrintf("%s/%s.ppf", patchDir, romName);
 	if(FS::exists(patchStr.data()))
 	{
-		logMsg("applying UPS patch: %s", patchStr.data());
-		if(!patchApplyUPS(patchStr.data(), &rom, &romSize))
-		{
-			return EmuSystem::makeError("Error applying UPS patch");
-		}
-		return {};
-	}
-	string_printf(patchStr, "%s/%s.ppf", patchDir, romName);
-	if(FS::exists(patchStr.data()))
-	{
-		logMsg("applying UPS patch: %s", patchStr.data());
+		logMsg("applying PPF patch: %s", patchStr.data());
 		if(!patchApplyPPF(patchStr.data(), &rom, &romSize))
 		{
 			return EmuSystem::makeError("Error applying PPF patch");
 		}
-		return {};
 	}
-	return {}; // no patch found
+	return {};
 }
 
 EmuSystem::Error EmuSystem::loadGame(IO &io, OnLoadProgressDelegate)
 {
-	int size = CPULoadRomWithIO(gGba, io);
+	// no hashes requested, game settings key on the header's game ID and
+	// hashing would page in the whole mapped ROM up front
+	RomLoader loader{};
+	auto patchBase = FS::makePathStringPrintf("%s/%s", EmuSystem::savePath(), EmuSystem::gameName().data());
+	if(auto ec = loader.findPatch(patchBase.data());
+		ec)
+	{
+		return makeError("Error reading patch: %s", ec.message().c_str());
+	}
+	std::error_code loadEc{};
+	auto loadRom =
+		[&](u8 *rom, int maxSize)
+		{
+			loadEc = loader.loadMapped(io, rom, maxSize);
+			return loadEc ? 0 : (int)loader.size();
+		};
+	int size = CPULoadRomData(gGba, [&loadRom](u8 *rom, int maxSize){ return loadRom(rom, maxSize); });
+	if(loadEc.value() == EINVAL || loadEc.value() == EFBIG)
+	{
+		return makeError("Error applying %s patch", loader.patchTypeName());
+	}
 	if(!size)
 	{
 		return makeFileReadError();
 	}
-	setGameSpecificSettings(gGba);
-	if(auto err = applyGamePatches(EmuSystem::savePath(), EmuSystem::gameName().data(), gGba.mem.rom, size);
-		err)
+	if(loader.patchType() == RomLoader::PatchType::NONE)
 	{
-		return err;
+		if(auto err = applyPPFPatch(EmuSystem::savePath(), EmuSystem::gameName().data(), gGba.mem.rom, size);
+			err)
+		{
+			return err;
+		}
 	}
+	setGameSpecificSettings(gGba);
 	CPUInit(gGba, 0, 0);
 	CPUReset(gGba);
 	auto saveStr = FS::makePathStringPrintf("%s/%s.sav", EmuSystem::savePath(), EmuSystem::gameName().data());
@@ -214,6 +242,7 @@ void systemOnWriteDataToSoundBuffer(const u16 * finalWave, int length)
 
 void EmuSystem::runFrame(EmuVideo *video, bool renderAudio)
 {
+	IG_TRACE_SPAN("EmuSystem::runFrame");
 	CPULoop(gGba, video, renderAudio);
 }
 
@@ -512,6 +512,76 @@ long utilGzMemTell(gzFile file)
   return memtell(file);
 }
 
+// Uncompressed in-memory state I/O, for snapshots taken every frame
+struct MemRawFile
+{
+  char *data;
+  int size;
+  int pos;
+  bool overflow;
+};
+
+static MemRawFile memRawFile;
+
+static int ZEXPORT memRawWrite(gzFile file, voidpc buf, unsigned len)
+{
+  auto &f = *(MemRawFile*)file;
+  if(f.overflow || len > (unsigned)(f.size - f.pos))
+  {
+    f.overflow = true;
+    return 0;
+  }
+  memcpy(f.data + f.pos, buf, len);
+  f.pos += len;
+  return len;
+}
+
+static int ZEXPORT memRawRead(gzFile file, voidp buf, unsigned len)
+{
+  auto &f = *(MemRawFile*)file;
+  if(len > (unsigned)(f.size - f.pos))
+  {
+    f.overflow = true;
+    len = f.size - f.pos;
+  }
+  memcpy(buf, f.data + f.pos, len);
+  f.pos += len;
+  return len;
+}
+
+static int ZEXPORT memRawClose(gzFile file)
+{
+  return 0;
+}
+
+static z_off_t ZEXPORT memRawSeek(gzFile file, z_off_t offset, int whence)
+{
+  auto &f = *(MemRawFile*)file;
+  z_off_t pos = whence == SEEK_CUR ? f.pos + offset : offset;
+  if(pos < 0 || pos > f.size)
+    return -1;
+  f.pos = pos;
+  return pos;
+}
+
+gzFile utilMemRawOpen(char *memory, int available)
+{
+  utilGzWriteFunc = memRawWrite;
+  utilGzReadFunc = memRawRead;
+  utilGzCloseFunc = memRawClose;
+  utilGzSeekFunc = memRawSeek;
+
+  memRawFile = {memory, available, 0, false};
+  return (gzFile)&memRawFile;
+}
+
+// bytes read or written so far, -1 if an access went past the end of the memory
+long utilMemRawTell(gzFile file)
+{
+  auto &f = *(MemRawFile*)file;
+  return f.overflow ? -1 : f.pos;
+}
+
 void utilGBAFindSave(const u8 *data, const int size)
 {
   u32 *p = (u32 *)data;
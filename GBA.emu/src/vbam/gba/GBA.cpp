@@ -995,6 +995,30 @@ bool CPUReadMemState(GBASys &gba, char *memory, int available)
   return res;
 }
 
+bool CPUReadRawState(GBASys &gba, const char *memory, int size)
+{
+  gzFile gzFile = utilMemRawOpen((char*)memory, size);
+
+  bool res = CPUReadState(gba, gzFile) && utilMemRawTell(gzFile) != -1;
+
+  utilGzClose(gzFile);
+
+  return res;
+}
+
+int CPUWriteRawState(GBASys &gba, char *memory, int available)
+{
+  gzFile gzFile = utilMemRawOpen(memory, available);
+
+  bool res = CPUWriteState(gba, gzFile);
+
+  long size = utilMemRawTell(gzFile);
+
+  utilGzClose(gzFile);
+
+  return res && size != -1 ? size : 0;
+}
+
 bool CPUReadState(GBASys &gba, const char * file)
 {
   gzFile gzFile = utilGzOpen(file, "rb");
@@ -1511,11 +1535,12 @@ int CPULoadRom(GBASys &gba, const char *szFile)
   return romSize;
 }
 
-int CPULoadRomWithIO(GBASys &gba, IO &io)
+int CPULoadRomData(GBASys &gba, DelegateFunc<int (u8 *rom, int maxSize)> readRom)
 {
 	preLoadRomSetup(gba);
-	u8 *whereToLoad = gba.mem.rom;
-	romSize = io.read(whereToLoad, romSize);
+	romSize = readRom(gba.mem.rom, romSize);
+	if(romSize <= 0)
+		return 0;
   postLoadRomSetup(gba);
   return romSize;
 }
@@ -10,6 +10,7 @@
 #include <imagine/util/ansiTypes.h>
 #include <imagine/logger/logger.h>
 #include <imagine/io/IO.hh>
+#include <imagine/util/DelegateFunc.hh>
 
 #define SAVE_GAME_VERSION_1 1
 #define SAVE_GAME_VERSION_2 2
@@ -205,7 +206,8 @@ struct GBAMem
 	IoMem ioMem;
 	u8 internalRAM[0x8000] __attribute__ ((aligned(4))) {0};
 	u8 workRAM[0x40000] __attribute__ ((aligned(4))) {0};
-	u8 rom[0x2000000] __attribute__ ((aligned(4)))
+	// page aligned so RomLoader::loadMapped() can move a ROM file's pages here
+	u8 rom[0x2000000] __attribute__ ((aligned(0x4000)))
 #ifndef __clang__
 	{0}
 #endif
@@ -1027,8 +1029,12 @@ extern bool CPUReadMemState(GBASys &gba, char *, int);
 extern bool CPUReadState(GBASys &gba, const char *);
 extern bool CPUWriteMemState(GBASys &gba, char *, int);
 extern bool CPUWriteState(GBASys &gba, const char *);
+// uncompressed states, writing returns the size or 0 if available is too small
+extern bool CPUReadRawState(GBASys &gba, const char *, int);
+extern int CPUWriteRawState(GBASys &gba, char *, int);
 extern int CPULoadRom(GBASys &gba, const char *);
-extern int CPULoadRomWithIO(GBASys &gba, IO &);
+// readRom fills up to maxSize bytes of rom and returns the size read, or <= 0 on error
+extern int CPULoadRomData(GBASys &gba, DelegateFunc<int (u8 *rom, int maxSize)> readRom);
 extern void doMirroring(GBASys &gba, bool);
 extern void CPUUpdateRegister(ARM7TDMI &cpu, u32, u16);
 extern void applyTimer(ARM7TDMI &cpu);
@@ -24,6 +24,7 @@
 #include "loadres.h"
 #include "file/file.h"
 #include <cstddef>
+#include <iosfwd>
 #include <string>
 #include <imagine/util/DelegateFunc.hh>
 
@@ -155,6 +156,19 @@ public:
 	  */
 	bool loadState(std::string const &filepath);
 
+	/**
+	  * Saves emulator state to 'stream', without writing save data or a state file.
+	  * @return success
+	  */
+	bool saveState(gambatte::PixelType const *videoBuf, std::ptrdiff_t pitch,
+	               std::ostream &stream);
+
+	/**
+	  * Loads emulator state from 'stream', without writing save data.
+	  * @return success
+	  */
+	bool loadState(std::istream &stream);
+
 	/**
 	  * Selects which state slot to save state to or load state from.
 	  * There are 10 such slots, numbered from 0 to 9 (periodically extended for all n).
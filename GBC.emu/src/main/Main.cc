@@ -22,6 +22,8 @@
 #include <main/Cheats.hh>
 #include <main/Palette.hh>
 #include "internal.hh"
+#include <istream>
+#include <ostream>
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2014\nRobert Broglia\nwww.explusalpha.com\n\n(c) 2011\nthe Gambatte Team\ngambatte.sourceforge.net";
 gambatte::GB gbEmu;
@@ -116,6 +118,28 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 		return {};
 }
 
+static StateBufferStreamBuf stateStreamBuf{};
+
+EmuSystem::Error EmuSystem::saveStateToBuffer(StateBuffer &buff)
+{
+	stateStreamBuf.setForWrite(buff);
+	std::ostream stream{&stateStreamBuf};
+	if(!gbEmu.saveState(/*screenBuff*/0, 160, stream))
+		return makeFileWriteError();
+	else
+		return {};
+}
+
+EmuSystem::Error EmuSystem::loadStateFromBuffer(const StateBuffer &buff)
+{
+	stateStreamBuf.setForRead(buff);
+	std::istream stream{&stateStreamBuf};
+	if(!gbEmu.loadState(stream))
+		return makeFileReadError();
+	else
+		return {};
+}
+
 void EmuSystem::saveBackupMem()
 {
 	logMsg("saving battery");
@@ -185,6 +209,7 @@ void EmuSystem::configAudioRate(double frameTime, int rate)
 
 void EmuSystem::runFrame(EmuVideo *video, bool renderAudio)
 {
+	IG_TRACE_SPAN("EmuSystem::runFrame");
 	alignas(std::max_align_t) uint8 snd[(35112+2064)*4];
 	size_t samples = 35112;
 	int frameSample;
@@ -223,6 +248,7 @@ void EmuSystem::runFrame(EmuVideo *video, bool renderAudio)
 			samples = 35112;
 		}
 		// video rendered in runFor()
+		IG_TRACE_SPAN("resample");
 		short destBuff[(Audio::maxRate()/54)*2];
 		uint destFrames = resampler->resample(destBuff, (const short*)snd, samples);
 		assert(Audio::pcmFormat.framesToBytes(destFrames) <= sizeof(destBuff));
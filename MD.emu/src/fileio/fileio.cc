@@ -19,26 +19,33 @@ int loadArchive(void *buff, uint bytes, const char *path, FS::FileString &nameIn
 	if(EmuApp::hasArchiveExtension(path))
 	{
 		std::error_code ec{};
-		for(auto &entry : FS::ArchiveIterator{path, ec})
+		auto index = FS::ArchiveIndex::open(path, ec);
+		if(!index)
 		{
-			if(entry.type() == FS::file_type::directory)
+			logErr("error opening archive:%s", path);
+			return -1;
+		}
+		for(auto &entry : index->entries())
+		{
+			if(entry.isDirectory)
 			{
 				continue;
 			}
-			auto name = entry.name();
+			auto name = entry.name.data();
 			logMsg("archive file entry:%s", name);
 			if(hasROMExtension(name))
 			{
 				string_copy(nameInArchive, name);
-				auto io = entry.moveIO();
+				// ZIP entries are read straight from the cached index without rescanning the archive
+				auto io = index->openSeekableEntry(entry);
+				if(!io)
+				{
+					logErr("error opening archive entry:%s", name);
+					return -1;
+				}
 				return io.read(buff, bytes);
 			}
 		}
-		if(ec)
-		{
-			logErr("error opening archive:%s", path);
-			return -1;
-		}
 		logErr("no recognized file extensions in archive:%s", path);
 		return -1;
 	}
@@ -45,5 +45,8 @@
 /* Function prototypes */
 EmuSystem::Error state_load(const unsigned char *buffer);
 int state_save(unsigned char *buffer);
+// raw state data without the compressed file framing, state must hold STATE_SIZE bytes
+EmuSystem::Error state_loadUncompressed(const unsigned char *state, uint size);
+int state_saveUncompressed(unsigned char *state);
 
 #endif
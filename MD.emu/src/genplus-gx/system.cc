@@ -31,6 +31,7 @@
 #ifndef NO_SCD
 #include <scd/scd.h>
 #include <scd/pcm.h>
+#include <imagine/audio/Resampler.hh>
 #endif
 
 /* Global variables */
@@ -50,6 +51,10 @@ static int pause_b;
 static EQSTATE eq;
 static int32 llp,rrp;
 static constexpr auto pixFmt = IG::PIXEL_FMT_RGB565;
+#ifndef NO_SCD
+static constexpr uint CDDA_RATE = 44100;
+static Audio::Resampler cddaResampler{};
+#endif
 
 /****************************************************************
  * Audio subsystem
@@ -66,7 +71,14 @@ int audio_init (int samplerate, float framerate)
   /* Default settings */
   snd.sample_rate = samplerate;
   snd.frame_rate  = framerate;
-  snd.cddaRatio = 44100./snd.sample_rate;
+
+#ifndef NO_SCD
+  /* CD audio tracks play at a fixed 44.1KHz */
+  if(samplerate != CDDA_RATE)
+    cddaResampler.init(CDDA_RATE, samplerate, 2);
+  else
+    cddaResampler.deinit();
+#endif
 
   /* Calculate the sound buffer size (for one frame) */
   snd.buffer_size = (int)(samplerate / framerate) + 32;
@@ -162,28 +174,25 @@ int audioUpdateAll(int16 *sb)
 	{
 		scd_pcm_update(cdPCMBuff, size, 1);
 	}
-	auto cddaRatio = snd.cddaRatio;
-	uint cddaFrames = round((float)size*cddaRatio);
-	int16 cddaBuff[cddaFrames*2];
+	int16 cddaBuff[size*2];
 	int16 *cdda = cddaBuff;
-	int16 cddaRemsampledBuff[size*2];
 	extern int readCDDA(void *dest, uint size);
-	bool doCDDA = hasSegaCD && readCDDA(cddaBuff, cddaFrames);
-	if(doCDDA && snd.sample_rate != 44100)
+	bool doCDDA = false;
+	if(hasSegaCD)
 	{
-		auto cddaPtr = (int32*)cddaBuff;
-		auto cddaResampledPtr = (int32*)cddaRemsampledBuff;
-		iterateTimes(size, i)
+		if(cddaResampler)
 		{
-			uint samplePos = round(i * cddaRatio);
-			if(samplePos > cddaFrames)
-			{
-				logMsg("resample pos %u too high", samplePos);
-				samplePos = cddaFrames-1;
-			}
-			cddaResampledPtr[i] = cddaPtr[samplePos];
+			// read just enough of the track for exactly size output frames
+			uint cddaFrames = cddaResampler.inputFramesNeeded(size);
+			int16 cddaTrackBuff[cddaFrames*2];
+			doCDDA = readCDDA(cddaTrackBuff, cddaFrames);
+			if(doCDDA)
+				cddaResampler.process(cddaTrackBuff, cddaFrames, cddaBuff, size);
+			else
+				cddaResampler.reset();
 		}
-		cdda = cddaRemsampledBuff;
+		else
+			doCDDA = readCDDA(cddaBuff, size);
 	}
 	#endif
 
@@ -17,6 +17,7 @@
 #include <emuframework/EmuApp.hh>
 #include <emuframework/EmuInput.hh>
 #include <emuframework/EmuAppInlines.hh>
+#include <emuframework/SaveFileWriter.hh>
 #include "internal.hh"
 #include "system.h"
 #include "loadrom.h"
@@ -79,12 +80,20 @@ EmuSystem::NameFilterFunc EmuSystem::defaultBenchmarkFsFilter = hasMDExtension;
 
 void EmuSystem::runFrame(EmuVideo *video, bool renderAudio)
 {
+	IG_TRACE_SPAN("EmuSystem::runFrame");
 	//logMsg("frame start");
 	RAMCheatUpdate();
-	system_frame(video);
+	{
+		IG_TRACE_SPAN("system_frame");
+		system_frame(video);
+	}
 
 	int16 audioBuff[snd.buffer_size * 2];
-	int frames = audio_update(audioBuff);
+	int frames;
+	{
+		IG_TRACE_SPAN("audio_update");
+		frames = audio_update(audioBuff);
+	}
 	if(renderAudio)
 	{
 		//logMsg("%d frames", frames);
@@ -172,6 +181,20 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 	return loadMDState(path);
 }
 
+EmuSystem::Error EmuSystem::saveStateToBuffer(StateBuffer &buff)
+{
+	// uncompressed since rewind & run-ahead snapshot every frame, StateBuffer only
+	// allocates until it fits the largest state
+	buff.resize(STATE_SIZE);
+	buff.resize(state_saveUncompressed(buff.data()));
+	return {};
+}
+
+EmuSystem::Error EmuSystem::loadStateFromBuffer(const StateBuffer &buff)
+{
+	return state_loadUncompressed(buff.data(), buff.size());
+}
+
 void EmuSystem::saveBackupMem() // for manually saving when not closing game
 {
 	if(!gameIsRunning())
@@ -181,21 +204,15 @@ void EmuSystem::saveBackupMem() // for manually saving when not closing game
 	{
 		logMsg("saving BRAM");
 		auto saveStr = sprintBRAMSaveFilename();
-		FileIO bramFile;
-		bramFile.create(saveStr.data());
-		if(!bramFile)
-			logMsg("error creating bram file");
-		else
+		char bramTemp[sizeof(bram) + 0x10000];
+		memcpy(bramTemp, bram, sizeof(bram));
+		char *sramTemp = &bramTemp[sizeof(bram)];
+		memcpy(sramTemp, sram.sram, 0x10000); // make a temp copy to byte-swap
+		for(uint i = 0; i < 0x10000; i += 2)
 		{
-			bramFile.write(bram, sizeof(bram));
-			char sramTemp[0x10000];
-			memcpy(sramTemp, sram.sram, 0x10000); // make a temp copy to byte-swap
-			for(uint i = 0; i < 0x10000; i += 2)
-			{
-				std::swap(sramTemp[i], sramTemp[i+1]);
-			}
-			bramFile.write(sramTemp, 0x10000);
+			std::swap(sramTemp[i], sramTemp[i+1]);
 		}
+		saveFileWriter.writeIfChanged(saveStr.data(), bramTemp, sizeof(bramTemp));
 	}
 	else
 	#endif
@@ -217,9 +234,7 @@ void EmuSystem::saveBackupMem() // for manually saving when not closing game
 			}
 			sramPtr = sramTemp;
 		}
-		auto ec = writeToNewFile(saveStr.data(), sramPtr, 0x10000);
-		if(ec)
-			logMsg("error creating sram file");
+		saveFileWriter.writeIfChanged(saveStr.data(), sramPtr, 0x10000);
 	}
 	writeCheatFile();
 }
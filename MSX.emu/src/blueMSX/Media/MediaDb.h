@@ -208,6 +208,8 @@ void mediaDbCreateCasdb();
 
 MediaType* mediaDbLookupRom(const void *buffer, int size);
 MediaType* mediaDbGuessRom(const void *buffer, int size);
+// like mediaDbGuessRom() with the SHA-1 already computed by romLoadWithSHA1()
+MediaType* mediaDbGuessRomWithSHA1(const void *buffer, int size, const unsigned char *sha1);
 MediaType* mediaDbLookupDisk(const void *buffer, int size);
 MediaType* mediaDbLookupCas(const void *buffer, int size);
 
@@ -139,6 +139,8 @@ int cartridgeInsert(int cartNo, RomType romType, const char* cart, const char* c
     int success = 1;
     UInt8* buf;
     int size;
+    UInt8 sha1[20];
+    int hasSha1 = 0;
     int slot  = cartridgeInfo.cart[cartNo].slot;
     int sslot = cartridgeInfo.cart[cartNo].sslot;
 
@@ -333,7 +335,8 @@ int cartridgeInsert(int cartNo, RomType romType, const char* cart, const char* c
             buf = romLoad("Machines/Shared Roms/nowindDos2.rom", cartZip, &size);
         }
         else {
-            buf = romLoad(cart, cartZip, &size);
+            buf = romLoadWithSHA1(cart, cartZip, &size, sha1);
+            hasSha1 = 1;
         }
         if (buf == NULL) {
             switch (romType) {
@@ -373,7 +376,7 @@ int cartridgeInsert(int cartNo, RomType romType, const char* cart, const char* c
         }
         
         if (romType == ROM_UNKNOWN) {
-            MediaType* mediaType = mediaDbGuessRom(buf, size);
+            MediaType* mediaType = mediaDbGuessRomWithSHA1(buf, size, hasSha1 ? sha1 : NULL);
             romType =  mediaDbGetRomType(mediaType);
         }
 
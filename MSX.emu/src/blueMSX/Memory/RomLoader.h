@@ -35,6 +35,8 @@ extern "C" {
 #endif
 
 UInt8* romLoad(const char *fileName, const char *fileInZipFile, int* size);
+// also returns the ROM's SHA-1, hashed while it was read
+UInt8* romLoadWithSHA1(const char *fileName, const char *fileInZipFile, int* size, UInt8 sha1[20]);
 
 #ifdef __cplusplus
 }
@@ -744,6 +744,7 @@ void RefreshScreen(int screenMode)
 
 void EmuSystem::runFrame(EmuVideo *video, bool renderAudio)
 {
+	IG_TRACE_SPAN("EmuSystem::runFrame");
 	// fast-forward during floppy access, but stop if access ends
 	if(unlikely(fdcActive && video))
 	{
@@ -41,6 +41,7 @@ extern "C" {
 #include <imagine/util/builtins.h>
 #include <imagine/util/algorithm.h>
 #include <imagine/logger/logger.h>
+#include "internal.hh"
 // throw_exception.hpp, Boost 1.50
 #define UUID_AA15E74A856F11E08B8D93F24824019B
 #define BOOST_THROW_EXCEPTION(x)
@@ -536,7 +537,8 @@ extern "C" void mediaDbSetDefaultRomType(RomType romType)
     romdbDefaultType = romType;
 }
 
-extern "C" MediaType* mediaDbLookupRom(const void *buffer, int size)
+// sha1 is the ROM's hash if its loader already computed it, otherwise null
+static MediaType* lookupRom(const void *buffer, int size, const unsigned char *sha1)
 {
     const char* romData = (const char*)buffer;
     static MediaType defaultColeco(ROM_COLECO);
@@ -550,10 +552,20 @@ extern "C" MediaType* mediaDbLookupRom(const void *buffer, int size)
     }*/
     static MediaType staticMediaType(ROM_UNKNOWN);
 
-    boost::uuids::detail::sha1 sha1;
-		sha1.process_bytes(buffer, size);
 		unsigned int digest[5];
-		sha1.get_digest(digest);
+		if(sha1)
+		{
+			iterateTimes(5, i)
+			{
+				digest[i] = (sha1[i*4] << 24) | (sha1[i*4+1] << 16) | (sha1[i*4+2] << 8) | sha1[i*4+3];
+			}
+		}
+		else
+		{
+			boost::uuids::detail::sha1 hasher;
+			hasher.process_bytes(buffer, size);
+			hasher.get_digest(digest);
+		}
 		logMsg("rom sha1 0x%X 0x%X 0x%X 0x%X 0x%X", digest[0], digest[1], digest[2], digest[3], digest[4]);
 
 		for(auto e : romDB)
@@ -599,7 +611,12 @@ extern "C" MediaType* mediaDbLookupRom(const void *buffer, int size)
     return mediaType;*/
 }
 
-extern "C" MediaType* mediaDbGuessRom(const void *buffer, int size)
+extern "C" MediaType* mediaDbLookupRom(const void *buffer, int size)
+{
+    return lookupRom(buffer, size, nullptr);
+}
+
+static MediaType* guessRom(const void *buffer, int size, const unsigned char *sha1)
 {
     static MediaType staticMediaType(ROM_UNKNOWN);
 
@@ -614,7 +631,7 @@ extern "C" MediaType* mediaDbGuessRom(const void *buffer, int size)
         return &staticMediaType;
     }
 
-    MediaType* mediaType = mediaDbLookupRom(buffer, size);
+    MediaType* mediaType = lookupRom(buffer, size, sha1);
     if (mediaType == NULL) {
         mediaType = &staticMediaType;
 //        printf("xx %d\n", romdbDefaultType);
@@ -750,3 +767,13 @@ extern "C" MediaType* mediaDbGuessRom(const void *buffer, int size)
     
     return mediaType;
 }
+
+extern "C" MediaType* mediaDbGuessRom(const void *buffer, int size)
+{
+    return guessRom(buffer, size, nullptr);
+}
+
+extern "C" MediaType* mediaDbGuessRomWithSHA1(const void *buffer, int size, const unsigned char *sha1)
+{
+    return guessRom(buffer, size, sha1);
+}
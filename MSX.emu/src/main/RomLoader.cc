@@ -14,14 +14,51 @@
 	along with MSX.emu.  If not, see <http://www.gnu.org/licenses/> */
 
 #include "RomLoader.h"
-#include "ziphelper.h"
+#include <emuframework/RomLoader.hh>
 #include <imagine/io/FileIO.hh>
 #include <imagine/fs/FS.hh>
+#include <imagine/fs/ArchiveFS.hh>
 #include <imagine/logger/logger.h>
+#include <imagine/util/string.h>
 #include <string.h>
 #include "internal.hh"
 
-UInt8 *romLoad(const char *filename, const char *filenameInArchive, int *size)
+static UInt8 *loadRomIO(IO &io, int *size, UInt8 *sha1)
+{
+	int fileSize = io.size();
+	auto buff = (UInt8*)malloc(fileSize);
+	if(!buff)
+		return nullptr;
+	RomLoader loader{sha1 ? RomLoader::HASH_SHA1 : 0};
+	if(auto ec = loader.load(io, buff, fileSize);
+		ec || loader.size() != (size_t)fileSize)
+	{
+		logErr("error reading ROM");
+		free(buff);
+		return nullptr;
+	}
+	if(sha1)
+		memcpy(sha1, loader.hashes().sha1.data(), 20);
+	*size = fileSize;
+	return buff;
+}
+
+static UInt8 *loadRomFromArchive(const char *archivePath, const char *filenameInArchive, int *size, UInt8 *sha1)
+{
+	std::error_code ec{};
+	for(auto &entry : FS::ArchiveIterator{archivePath, ec})
+	{
+		if(entry.type() == FS::file_type::directory || !string_equal(entry.name(), filenameInArchive))
+		{
+			continue;
+		}
+		auto io = entry.moveIO();
+		return loadRomIO(io, size, sha1);
+	}
+	return nullptr;
+}
+
+static UInt8 *loadRom(const char *filename, const char *filenameInArchive, int *size, UInt8 *sha1)
 {
 	if(!filename || !strlen(filename))
 		return nullptr;
@@ -33,7 +70,7 @@ UInt8 *romLoad(const char *filename, const char *filenameInArchive, int *size)
 	{
 		for(const auto &path : searchPath)
 		{
-			auto buff = (UInt8*)zipLoadFile(path->data(), filenameInArchive, size);
+			auto buff = loadRomFromArchive(path->data(), filenameInArchive, size, sha1);
 			if(buff)
 				return buff;
 		}
@@ -46,14 +83,21 @@ UInt8 *romLoad(const char *filename, const char *filenameInArchive, int *size)
 			file.open(path->data(), IO::AccessHint::ALL);
 			if(!file)
 				continue;
-			int fileSize = file.size();
-			auto buff = (UInt8*)malloc(fileSize);
-			file.read(buff, fileSize);
-			*size = fileSize;
-			return buff;
+			auto buff = loadRomIO(file, size, sha1);
+			if(buff)
+				return buff;
 		}
 	}
 	logErr("can't load ROM");
 	return nullptr;
 }
 
+UInt8 *romLoad(const char *filename, const char *filenameInArchive, int *size)
+{
+	return loadRom(filename, filenameInArchive, size, nullptr);
+}
+
+UInt8 *romLoadWithSHA1(const char *filename, const char *filenameInArchive, int *size, UInt8 sha1[20])
+{
+	return loadRom(filename, filenameInArchive, size, sha1);
+}
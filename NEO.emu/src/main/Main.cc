@@ -358,13 +358,20 @@ CLINK void screen_update()
 
 void EmuSystem::runFrame(EmuVideo *video, bool renderAudio)
 {
+	IG_TRACE_SPAN("EmuSystem::runFrame");
 	//logMsg("run frame %d", (int)processGfx);
 	emuVideo = video;
 	skip_this_frame = !video;
 	if(video)
 		IG::fillData(screenBuff, (uint16)current_pc_pal[4095]);
-	main_frame();
-	YM2610Update_stream(audioFramesPerVideoFrame);
+	{
+		IG_TRACE_SPAN("main_frame");
+		main_frame();
+	}
+	{
+		IG_TRACE_SPAN("YM2610Update_stream");
+		YM2610Update_stream(audioFramesPerVideoFrame);
+	}
 	if(renderAudio)
 	{
 		writeSound(play_buffer, audioFramesPerVideoFrame);
@@ -25,42 +25,41 @@ extern "C"
 	#include <gngeo/unzip.h>
 }
 
-struct PKZIP : public FS::ArchiveIterator {};
+struct PKZIP
+{
+	std::shared_ptr<FS::ArchiveIndex> index;
+};
 
 struct ZFILE
 {
-	ArchiveIO io;
-	FS::ArchiveIterator *arch;
+	GenericIO io;
 };
 
-ZFILE *gn_unzip_fopen(PKZIP *archPtr, const char *filename, uint32_t fileCRC)
+ZFILE *gn_unzip_fopen(PKZIP *zip, const char *filename, uint32_t fileCRC)
 {
-	auto &arch = *archPtr;
-	arch.rewind();
-	for(auto &entry : arch)
+	auto &index = *zip->index;
+	int loadByName = fileCRC == (uint32_t)-1 || !gn_strictROMChecking();
+	auto entry = loadByName ? index.find(filename) : nullptr;
+	if(!entry)
+		entry = index.findCRC(fileCRC);
+	if(!entry)
+	{
+		logMsg("file:%s crc32:0x%X not found in archive", filename, fileCRC);
+		return nullptr;
+	}
+	//logMsg("opened archive entry file:%s crc32:0x%X", entry->name.c_str(), entry->crc32);
+	auto io = index.openEntry(*entry);
+	if(!io)
 	{
-		if(entry.type() == FS::file_type::directory)
-		{
-			continue;
-		}
-		auto name = entry.name();
-		auto crc = entry.crc32();
-		//logMsg("archive file entry:%s crc32:0x%X", name, crc);
-		int loadByName = fileCRC == (uint32_t)-1 || !gn_strictROMChecking();
-		if((loadByName && (string_equal(name, filename))) || crc == fileCRC)
-		{
-			//logMsg("opened archive entry file:%s crc32:0x%X", name, crc);
-			return new ZFILE{entry.moveIO(), archPtr};
-		}
+		logErr("error opening archive entry:%s", entry->name.c_str());
+		return nullptr;
 	}
-	logMsg("file:%s crc32:0x%X not found in archive", filename, fileCRC);
-	return nullptr;
+	return new ZFILE{std::move(io)};
 }
 
 void gn_unzip_fclose(ZFILE *z)
 {
 	//logMsg("done with archive entry");
-	*z->arch = z->io.releaseArchive();
 	delete z;
 }
 
@@ -73,23 +72,23 @@ int gn_unzip_fread(ZFILE *z, uint8_t *data, unsigned int size)
 PKZIP *gn_open_zip(const char *path)
 {
 	std::error_code ec{};
-	auto arch = std::make_unique<FS::ArchiveIterator>(path, ec);
-	if(ec)
+	auto index = FS::ArchiveIndex::open(path, ec);
+	if(!index)
 	{
 		logErr("error opening archive:%s", path);
 		return nullptr;
 	}
-	return static_cast<PKZIP*>(arch.release());
+	return new PKZIP{std::move(index)};
 }
 
-void gn_close_zip(PKZIP *archPtr)
+void gn_close_zip(PKZIP *zip)
 {
-	delete archPtr;
+	delete zip;
 }
 
-uint8_t *gn_unzip_file_malloc(PKZIP *archPtr, const char *filename, uint32_t fileCRC, unsigned int *outlen)
+uint8_t *gn_unzip_file_malloc(PKZIP *zip, const char *filename, uint32_t fileCRC, unsigned int *outlen)
 {
-	auto z = gn_unzip_fopen(archPtr, filename, fileCRC);
+	auto z = gn_unzip_fopen(zip, filename, fileCRC);
 	if(!z)
 	{
 		return nullptr;
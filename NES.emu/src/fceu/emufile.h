@@ -356,6 +356,8 @@ protected:
 public:
 
 	EMUFILE_IO(IO &io);
+	// takes ownership of data allocated with new[]
+	EMUFILE_IO(char *data, size_t size);
 
 	~EMUFILE_IO() {
 	}
@@ -37,6 +37,13 @@ struct FCEUFILE {
 	//the size of the file
 	int size;
 
+	//CRC32 & MD5 of the iNES PRG & CHR data, computed while the file was read.
+	//iNESLoad() uses them when they cover exactly the bytes it would hash
+	bool hasROMHashes = false;
+	uint32 romHashOffset = 0, romHashSize = 0;
+	uint32 romCRC32 = 0;
+	uint8 romMD5[16]{};
+
 	//whether the file is contained in an archive
 	bool isArchive() { return archiveCount > 0; }
 
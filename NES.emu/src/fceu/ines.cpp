@@ -809,21 +809,30 @@ int iNESLoad(const char *name, FCEUFILE *fp, int OverwriteVidMode) {
 
 	SetupCartPRGMapping(0, ROM, ROM_size << 14, 0);
 
+	uint64 romDataOffset = FCEU_ftell(fp);
 	FCEU_fread(ROM, 0x4000, (round) ? ROM_size : not_round_size, fp);
 
 	if (VROM_size)
 		FCEU_fread(VROM, 0x2000, VROM_size, fp);
 
-	md5_starts(&md5);
-	md5_update(&md5, ROM, ROM_size << 14);
-
-	iNESGameCRC32 = CalcCRC32(0, ROM, ROM_size << 14);
-
-	if (VROM_size) {
-		iNESGameCRC32 = CalcCRC32(iNESGameCRC32, VROM, VROM_size << 13);
-		md5_update(&md5, VROM, VROM_size << 13);
+	// hashes from loading only match if the file held the whole unpadded image
+	if (fp->hasROMHashes && (round || not_round_size == ROM_size)
+		&& fp->romHashOffset == romDataOffset
+		&& fp->romHashSize == (ROM_size << 14) + (VROM_size << 13)) {
+		iNESGameCRC32 = fp->romCRC32;
+		memcpy(iNESCart.MD5, fp->romMD5, sizeof(iNESCart.MD5));
+	} else {
+		md5_starts(&md5);
+		md5_update(&md5, ROM, ROM_size << 14);
+
+		iNESGameCRC32 = CalcCRC32(0, ROM, ROM_size << 14);
+
+		if (VROM_size) {
+			iNESGameCRC32 = CalcCRC32(iNESGameCRC32, VROM, VROM_size << 13);
+			md5_update(&md5, VROM, VROM_size << 13);
+		}
+		md5_finish(&md5, iNESCart.MD5);
 	}
-	md5_finish(&md5, iNESCart.MD5);
 	memcpy(&GameInfo->MD5, &iNESCart.MD5, sizeof(iNESCart.MD5));
 
 	iNESCart.CRC32 = iNESGameCRC32;
@@ -274,6 +274,11 @@ EMUFILE_IO::EMUFILE_IO(IO &srcIO)
 	}
 }
 
+EMUFILE_IO::EMUFILE_IO(char *data, size_t size)
+{
+	io.open(data, size, [data](BufferMapIO &){ delete[] data; });
+}
+
 void EMUFILE_IO::truncate(s32 length)
 {
 	io.truncate(length);
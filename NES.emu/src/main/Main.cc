@@ -16,9 +16,11 @@
 #define LOGTAG "main"
 #include <emuframework/EmuApp.hh>
 #include <emuframework/EmuAppInlines.hh>
+#include <emuframework/RomLoader.hh>
 #include "internal.hh"
 #include <fceu/driver.h>
 #include <fceu/state.h>
+#include <fceu/emufile.h>
 #include <fceu/fceu.h>
 #include <fceu/ppu.h>
 #include <fceu/fds.h>
@@ -26,6 +28,7 @@
 #include <fceu/cheat.h>
 #include <fceu/video.h>
 #include <fceu/sound.h>
+#include <zlib.h>
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2014\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nFCEUX Team\nfceux.com";
 bool EmuSystem::hasCheats = true;
@@ -138,6 +141,29 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 		return {};
 }
 
+// keeps its capacity between in-memory states
+static std::vector<u8> memStateData{};
+
+EmuSystem::Error EmuSystem::saveStateToBuffer(StateBuffer &buff)
+{
+	EMUFILE_MEMORY file{&memStateData};
+	file.set_len(0);
+	if(!FCEUSS_SaveMS(&file, Z_NO_COMPRESSION))
+		return EmuSystem::makeFileWriteError();
+	buff.assign(memStateData.data(), file.size());
+	return {};
+}
+
+EmuSystem::Error EmuSystem::loadStateFromBuffer(const StateBuffer &buff)
+{
+	memStateData.resize(buff.size());
+	memcpy(memStateData.data(), buff.data(), buff.size());
+	EMUFILE_MEMORY file{&memStateData};
+	if(!FCEUSS_LoadFP(&file, SSLOADPARAM_NOBACKUP))
+		return EmuSystem::makeFileReadError();
+	return {};
+}
+
 void EmuSystem::saveBackupMem() // for manually saving when not closing game
 {
 	if(gameIsRunning())
@@ -269,11 +295,59 @@ static int regionFromName(const char *name)
 	return 0; // NTSC
 }
 
+// Reads the game into memory while hashing the PRG & CHR data of an iNES
+// image, so iNESLoad() can skip its own pass over them
+static EMUFILE_IO *readGame(IO &io, FCEUFILE &file)
+{
+	if(io.mmapConst())
+		return new EMUFILE_IO(io);
+	auto size = io.size();
+	constexpr size_t headerSize = 16;
+	auto data = new char[size]();
+	if(size < headerSize || io.read(data, headerSize) != (ssize_t)headerSize)
+	{
+		delete[] data;
+		return nullptr;
+	}
+	auto header = (const uint8*)data;
+	bool isINES = !memcmp(header, "NES\x1a", 4);
+	RomLoader loader{isINES ? RomLoader::HASH_CRC32 | RomLoader::HASH_MD5 : 0};
+	size_t hashOffset{}, hashSize{};
+	if(isINES)
+	{
+		bool iNES2 = (header[7] & 0x0C) == 0x08;
+		size_t prgBanks = header[4] | (iNES2 ? (header[9] & 0x0F) << 8 : 0);
+		size_t chrBanks = header[5] | (iNES2 ? (header[9] & 0xF0) << 4 : 0);
+		hashOffset = (header[6] & 4) ? 512 : 0; // skip the trainer
+		hashSize = prgBanks * 0x4000 + chrBanks * 0x2000;
+		loader.setHashRange(hashOffset, hashSize);
+	}
+	if(loader.load(io, data + headerSize, size - headerSize) || loader.size() != size - headerSize)
+	{
+		delete[] data;
+		return nullptr;
+	}
+	if(hashSize)
+	{
+		file.hasROMHashes = true;
+		file.romHashOffset = headerSize + hashOffset;
+		file.romHashSize = std::min(hashSize, loader.size() - std::min(hashOffset, loader.size()));
+		file.romCRC32 = loader.hashes().crc32;
+		memcpy(file.romMD5, loader.hashes().md5.data(), sizeof(file.romMD5));
+	}
+	return new EMUFILE_IO(data, size);
+}
+
 EmuSystem::Error EmuSystem::loadGame(IO &io, OnLoadProgressDelegate)
 {
 	setDirOverrides();
-	auto ioStream = new EMUFILE_IO(io);
 	auto file = new FCEUFILE();
+	auto ioStream = readGame(io, *file);
+	if(!ioStream)
+	{
+		delete file;
+		return makeFileReadError();
+	}
 	file->filename = fullGamePath();
 	file->logicalPath = fullGamePath();
 	file->fullFilename = fullGamePath();
@@ -340,6 +414,7 @@ void FCEUD_emulateSound(bool renderAudio)
 
 void EmuSystem::runFrame(EmuVideo *video, bool renderAudio)
 {
+	IG_TRACE_SPAN("EmuSystem::runFrame");
 	FCEUI_Emulate(
 		[&video](uint8 *buf)
 		{
@@ -22,6 +22,7 @@
 #include "interrupt.h"
 #include <emuframework/EmuApp.hh>
 #include <emuframework/EmuAppInlines.hh>
+#include <emuframework/SaveFileWriter.hh>
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2014\nRobert Broglia\nwww.explusalpha.com\n\n(c) 2004\nthe NeoPop Team\nwww.nih.at";
 uint32 frameskip_active = 0;
@@ -98,8 +99,13 @@ bool system_io_flash_write(uchar* buffer, uint32 len)
 		return 0;
 	auto saveStr = sprintSaveFilename();
 	logMsg("writing flash %s", saveStr.data());
-	auto ec = writeToNewFile(saveStr.data(), buffer, len);
-	return !ec;
+	if(auto ec = saveFileWriter.writeIfChanged(saveStr.data(), buffer, len);
+		ec)
+	{
+		logErr("previous flash write failed: %s", ec.message().c_str());
+		return 0;
+	}
+	return 1;
 }
 
 void EmuSystem::saveBackupMem()
@@ -170,6 +176,7 @@ void system_VBL(void)
 
 void EmuSystem::runFrame(EmuVideo *video, bool renderAudio)
 {
+	IG_TRACE_SPAN("EmuSystem::runFrame");
 	emuVideo = video;
 	frameskip_active = video ? 0 : 1;
 
@@ -22,6 +22,52 @@
 #include <mednafen/memory.h>
 #include <mednafen/MemoryStream.h>
 
+// Read-only Stream over an archive entry, ZIP entries decompress as they're read
+class ArchiveEntryStream : public Stream
+{
+public:
+	ArchiveEntryStream(GenericIO io): io{std::move(io)} {}
+
+	uint64 attributes() override
+	{
+		return ATTRIBUTE_READABLE | ATTRIBUTE_SEEKABLE;
+	}
+
+	uint64 read(void *data, uint64 count, bool error_on_eos) override
+	{
+		auto bytesRead = io.read(data, count);
+		if(bytesRead < 0)
+			throw MDFN_Error(0, "Error reading archive");
+		if(error_on_eos && (uint64)bytesRead != count)
+			throw MDFN_Error(0, "Unexpected end of archive entry");
+		return bytesRead;
+	}
+
+	void write(const void *data, uint64 count) override
+	{
+		throw MDFN_Error(0, "Write to read-only archive entry");
+	}
+
+	void truncate(uint64 length) override
+	{
+		throw MDFN_Error(0, "Truncate of read-only archive entry");
+	}
+
+	void seek(int64 offset, int whence) override
+	{
+		if(io.seek(offset, whence) < 0)
+			throw MDFN_Error(0, "Error seeking archive entry");
+	}
+
+	uint64 tell() override { return io.tell(); }
+	uint64 size() override { return io.size(); }
+	void flush() override {}
+	void close() override { io.close(); }
+
+private:
+	GenericIO io;
+};
+
 static bool hasKnownExtension(const char *name, const FileExtensionSpecStruct *extSpec)
 {
 	while(extSpec->extension)
@@ -39,31 +85,32 @@ MDFNFILE::MDFNFILE(const char *path, const FileExtensionSpecStruct *known_ext, c
 	if(EmuApp::hasArchiveExtension(path))
 	{
 		std::error_code ec{};
-		for(auto &entry : FS::ArchiveIterator{path, ec})
+		auto index = FS::ArchiveIndex::open(path, ec);
+		if(!index)
 		{
-			if(entry.type() == FS::file_type::directory)
+			throw MDFN_Error(0, "Error opening archive");
+		}
+		for(auto &entry : index->entries())
+		{
+			if(entry.isDirectory)
 			{
 				continue;
 			}
-			auto name = entry.name();
+			auto name = entry.name.data();
 			logMsg("archive file entry:%s", name);
 			if(hasKnownExtension(name, known_ext))
 			{
-				auto io = entry.moveIO();
-				str = std::make_unique<MemoryStream>(io.size(), true);
-				if(io.read(str->map(), str->map_size()) != (int)str->map_size())
+				auto io = index->openSeekableEntry(entry);
+				if(!io)
 				{
 					throw MDFN_Error(0, "Error reading archive");
 				}
+				str = std::make_unique<ArchiveEntryStream>(std::move(io));
 				auto extStr = strrchr(path, '.');
 				f_ext = strdup(extStr ? extStr + 1 : "");
 				return; // success
 			}
 		}
-		if(ec)
-		{
-			throw MDFN_Error(0, "Error opening archive");
-		}
 		throw MDFN_Error(0, "No recognized file extensions in archive");
 	}
 	else
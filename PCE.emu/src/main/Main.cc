@@ -25,6 +25,7 @@
 #include <mednafen/pce_fast/vdc.h>
 #include <mednafen/pce_fast/pcecd_drive.h>
 #include <mednafen/MemoryStream.h>
+#include <mednafen/state.h>
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2014\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nMednafen Team\nmednafen.sourceforge.net";
 FS::PathString sysCardPath{};
@@ -371,6 +372,7 @@ void MDFND_commitVideoFrame(EmulateSpecStruct *espec)
 
 void EmuSystem::runFrame(EmuVideo *video, bool renderAudio)
 {
+	IG_TRACE_SPAN("EmuSystem::runFrame");
 	uint maxFrames = Audio::maxRate()/54;
 	int16 audioBuff[maxFrames*2];
 	EmulateSpecStruct espec{};
@@ -390,7 +392,10 @@ void EmuSystem::runFrame(EmuVideo *video, bool renderAudio)
 	espec.surface = &mSurface;
 	int32 lineWidth[242];
 	espec.LineWidths = lineWidth;
-	emuSys->Emulate(&espec);
+	{
+		IG_TRACE_SPAN("Emulate");
+		emuSys->Emulate(&espec);
+	}
 	if(renderAudio)
 	{
 		assert((uint)espec.SoundBufSize <= EmuSystem::pcmFormat.bytesToFrames(sizeof(audioBuff)));
@@ -420,6 +425,96 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 		return {};
 }
 
+// Mednafen stream over a StateBuffer, either writing to it or reading from it
+class StateBufferStream : public Stream
+{
+public:
+	StateBufferStream(StateBuffer &buff): writeBuff{&buff}, readBuff{&buff}
+	{
+		buff.clear();
+	}
+	StateBufferStream(const StateBuffer &buff): readBuff{&buff} {}
+
+	uint64 attributes() override
+	{
+		return ATTRIBUTE_READABLE | ATTRIBUTE_SEEKABLE | (writeBuff ? ATTRIBUTE_WRITEABLE : 0);
+	}
+
+	uint64 read(void *data, uint64 count, bool error_on_eos) override
+	{
+		if(pos + count > readBuff->size())
+		{
+			if(error_on_eos)
+				throw MDFN_Error(0, "Unexpected end of state data");
+			count = readBuff->size() - pos;
+		}
+		memcpy(data, readBuff->data() + pos, count);
+		pos += count;
+		return count;
+	}
+
+	void write(const void *data, uint64 count) override
+	{
+		if(!writeBuff)
+			throw MDFN_Error(0, "Write to read-only state buffer");
+		if(pos + count > writeBuff->size())
+			writeBuff->resize(pos + count);
+		memcpy(writeBuff->data() + pos, data, count);
+		pos += count;
+	}
+
+	void truncate(uint64 length) override
+	{
+		if(writeBuff && length < writeBuff->size())
+			writeBuff->resize(length);
+	}
+
+	void seek(int64 offset, int whence) override
+	{
+		int64 base = whence == SEEK_CUR ? pos : whence == SEEK_END ? readBuff->size() : 0;
+		pos = std::clamp(base + offset, (int64)0, (int64)readBuff->size());
+	}
+
+	uint64 tell() override { return pos; }
+	uint64 size() override { return readBuff->size(); }
+	void flush() override {}
+	void close() override {}
+
+private:
+	StateBuffer *writeBuff{};
+	const StateBuffer *readBuff{};
+	uint64 pos = 0;
+};
+
+EmuSystem::Error EmuSystem::saveStateToBuffer(StateBuffer &buff)
+{
+	try
+	{
+		StateBufferStream stream{buff};
+		// data-only states skip headers and are only valid for this build, fine for in-memory use
+		MDFNSS_SaveSM(&stream, true);
+	}
+	catch(std::exception &e)
+	{
+		return EmuSystem::makeError("%s", e.what());
+	}
+	return {};
+}
+
+EmuSystem::Error EmuSystem::loadStateFromBuffer(const StateBuffer &buff)
+{
+	try
+	{
+		StateBufferStream stream{buff};
+		MDFNSS_LoadSM(&stream, true);
+	}
+	catch(std::exception &e)
+	{
+		return EmuSystem::makeError("%s", e.what());
+	}
+	return {};
+}
+
 void EmuApp::onCustomizeNavView(EmuApp::NavView &view)
 {
 	const Gfx::LGradientStopDesc navViewGrad[] =
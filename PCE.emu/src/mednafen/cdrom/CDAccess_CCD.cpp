@@ -441,5 +441,5 @@ bool CDAccess_CCD::Read_Sector(uint8 *buf, int32 lba, uint32 size)
 
 void CDAccess_CCD::HintReadSector(uint32 lba, int32 count)
 {
- img_stream.advise(lba * 2352, 2352 * count, IO::Advice::WILLNEED);
+ img_stream.prefetch(lba * 2352, 2352 * count);
 }
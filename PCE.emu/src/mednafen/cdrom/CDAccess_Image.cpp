@@ -1002,6 +1002,8 @@ void CDAccess_Image::ImageOpenBinary(const std::string& path, bool isIso)
 
 void CDAccess_Image::Cleanup(void)
 {
+ WaitReadAhead();
+
  for(int32 track = 0; track < 100; track++)
  {
   CDRFILE_TRACK_INFO *this_track = &Tracks[track];
@@ -1022,6 +1024,84 @@ void CDAccess_Image::Cleanup(void)
  }
 }
 
+void CDAccess_Image::ReadTrackData(CDRFILE_TRACK_INFO *track, uint8 *dest, uint32 size, long pos)
+{
+ FileIO *fp = track->fp.get();
+
+ for(auto &ra : ReadAhead)
+ {
+  if(ra.pending.load(std::memory_order_acquire) || ra.fp != fp || pos < ra.pos || (pos + size) > (ra.pos + ra.bytes))
+   continue;
+
+  memcpy(dest, &ra.data[pos - ra.pos], size);
+
+  // Once into the second half of this buffer, start filling the other with what follows it
+  if(pos >= (ra.pos + ra.bytes / 2))
+   StartReadAhead(fp, ra.pos + ra.bytes);
+  return;
+ }
+
+ fp->readAtPos(dest, size, pos);
+ StartReadAhead(fp, pos + size);
+}
+
+void CDAccess_Image::StartReadAhead(FileIO *fp, long pos)
+{
+ ReadAheadBuffer *freeBuffer = nullptr;
+
+ for(auto &ra : ReadAhead)
+ {
+  bool pending = ra.pending.load(std::memory_order_acquire);
+
+  // Forget a failed read so the same position can be tried again
+  if(!pending && ra.failed)
+  {
+   ra.fp = nullptr;
+   ra.failed = false;
+  }
+
+  uint32 extent = pending ? ReadAheadBuffer::Size : ra.bytes;
+
+  // Already buffered, on its way, or tried and found at the end of the file
+  if(ra.fp == fp && pos >= ra.pos && (pos == ra.pos || pos < (ra.pos + extent)))
+   return;
+
+  // Don't replace the buffer holding the data just read
+  if(!pending && !(ra.fp == fp && (pos - 1) >= ra.pos && (pos - 1) < (ra.pos + ra.bytes)))
+   freeBuffer = &ra;
+ }
+
+ if(!freeBuffer)
+  return;
+
+ auto &ra = *freeBuffer;
+ ra.fp = fp;
+ ra.pos = pos;
+ ra.bytes = 0;
+ ra.pending.store(true, std::memory_order_relaxed);
+ fp->readAsync(ra.data.get(), ReadAheadBuffer::Size, pos,
+  [this, &ra](ssize_t bytesRead, std::error_code ec)
+  {
+   ra.bytes = std::max(bytesRead, (ssize_t)0);
+   ra.failed = bytesRead < 0 || ec;
+   {
+    std::lock_guard<std::mutex> lock{ReadAheadMutex};
+    ra.pending.store(false, std::memory_order_release);
+   }
+   ReadAheadCond.notify_all();
+  });
+}
+
+void CDAccess_Image::WaitReadAhead()
+{
+ for(auto &ra : ReadAhead)
+ {
+  std::unique_lock<std::mutex> lock{ReadAheadMutex};
+  ReadAheadCond.wait(lock, [&ra](){ return !ra.pending.load(std::memory_order_acquire); });
+  ra.fp = nullptr;
+ }
+}
+
 CDAccess_Image::CDAccess_Image(const std::string& path, bool image_memcache) : NumTracks(0), FirstTrack(0), LastTrack(0), total_sectors(0)
 {
 	 //memset(Tracks, 0, sizeof(Tracks));
@@ -1166,7 +1246,7 @@ bool CDAccess_Image::Read_Raw_Sector(uint8 *buf, int32 lba)
 		switch(ct->DIFormat)
 		{
  case DI_FORMAT_AUDIO:
-	ct->fp->readAtPos(buf, 2352, SeekPos);
+	ReadTrackData(ct, buf, 2352, SeekPos);
 	SeekPos += 2352;
 
 	if(ct->RawAudioMSBFirst)
@@ -1174,7 +1254,7 @@ bool CDAccess_Image::Read_Raw_Sector(uint8 *buf, int32 lba)
 	break;
 
  case DI_FORMAT_MODE1:
-	ct->fp->readAtPos(buf + 12 + 3 + 1, 2048, SeekPos);
+	ReadTrackData(ct, buf + 12 + 3 + 1, 2048, SeekPos);
 	SeekPos += 2048;
 	encode_mode1_sector(lba + 150, buf);
 	break;
@@ -1182,12 +1262,12 @@ bool CDAccess_Image::Read_Raw_Sector(uint8 *buf, int32 lba)
  case DI_FORMAT_MODE1_RAW:
  case DI_FORMAT_MODE2_RAW:
  case DI_FORMAT_CDI_RAW:
-	ct->fp->readAtPos(buf, 2352, SeekPos);
+	ReadTrackData(ct, buf, 2352, SeekPos);
 	SeekPos += 2352;
 	break;
 
  case DI_FORMAT_MODE2:
-	ct->fp->readAtPos(buf + 16, 2336, SeekPos);
+	ReadTrackData(ct, buf + 16, 2336, SeekPos);
 	SeekPos += 2336;
 	encode_mode2_sector(lba + 150, buf);
 	break;
@@ -1196,13 +1276,13 @@ bool CDAccess_Image::Read_Raw_Sector(uint8 *buf, int32 lba)
  // FIXME: M2F1, M2F2, does sub-header come before or after user data(standards say before, but I wonder
  // about cdrdao...).
  case DI_FORMAT_MODE2_FORM1:
-	ct->fp->readAtPos(buf + 24, 2048, SeekPos);
+	ReadTrackData(ct, buf + 24, 2048, SeekPos);
 	SeekPos += 2048;
 	//encode_mode2_form1_sector(lba + 150, buf);
 	break;
 
  case DI_FORMAT_MODE2_FORM2:
-	ct->fp->readAtPos(buf + 24, 2324, SeekPos);
+	ReadTrackData(ct, buf + 24, 2324, SeekPos);
 	SeekPos += 2324;
 	//encode_mode2_form2_sector(lba + 150, buf);
 	break;
@@ -1210,7 +1290,7 @@ bool CDAccess_Image::Read_Raw_Sector(uint8 *buf, int32 lba)
 		}
 
 		if(ct->SubchannelMode)
-			ct->fp->readAtPos(buf + 2352, 96, SeekPos);
+			ReadTrackData(ct, buf + 2352, 96, SeekPos);
 	 }
 	} // end if audible part of audio track read.
 	return true;
@@ -1280,7 +1360,7 @@ bool CDAccess_Image::Read_Sector(uint8 *buf, int32 lba, uint32 size)
 			MDFN_printf("skipping cdda sector read\n");
 			return false;
 		}
-		ct->fp->readAtPos(buf, 2352, SeekPos);
+		ReadTrackData(ct, buf, 2352, SeekPos);
 
 		if(ct->RawAudioMSBFirst)
 		 Endian_A16_Swap(buf, 588 * 2);
@@ -1292,7 +1372,7 @@ bool CDAccess_Image::Read_Sector(uint8 *buf, int32 lba, uint32 size)
 			MDFN_printf("skipping data sector read\n");
 			return false;
 		}
-		ct->fp->readAtPos(buf, 2048, SeekPos);
+		ReadTrackData(ct, buf, 2048, SeekPos);
 		break;
 
 	case DI_FORMAT_MODE1_RAW:
@@ -1302,7 +1382,7 @@ bool CDAccess_Image::Read_Sector(uint8 *buf, int32 lba, uint32 size)
 			return false;
 		}
 		SeekPos += 12 + 3 + 1;
-		ct->fp->readAtPos(buf, 2048, SeekPos);
+		ReadTrackData(ct, buf, 2048, SeekPos);
 		break;
 			}
 
@@ -1349,7 +1429,9 @@ void CDAccess_Image::HintReadSector(uint32 lba, int32 count)
 				if(ct->SubchannelMode)
 				 SeekPos += 96 * (lba - ct->LBA);
 
-				ct->fp->advise(SeekPos, 2352 * count, IO::Advice::WILLNEED);
+				int32 SectorSize = DI_Size_Table[ct->DIFormat] + (ct->SubchannelMode ? 96 : 0);
+
+				ct->fp->prefetch(SeekPos, SectorSize * std::min<int32>(count, ct->LBA + ct->sectors - lba));
 			}
 		}
 	 }
@@ -3,6 +3,10 @@
 
 #include <map>
 #include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
 #include <imagine/io/FileIO.hh>
 
 class Stream;
@@ -103,6 +107,26 @@ class CDAccess_Image : public CDAccess
 
  void ParseTOCFileLineInfo(CDRFILE_TRACK_INFO *track, const int tracknum, const std::string &filename, const char *binoffset, const char *msfoffset, const char *length, bool image_memcache, std::map<std::string, std::shared_ptr<FileIO>> &toc_streamcache);
  uint32 GetSectorCount(CDRFILE_TRACK_INFO *track);
+
+ // Binary track data is read ahead into these in turn with IO::readAsync(),
+ // so sequential sector reads copy from memory instead of waiting on the file
+ struct ReadAheadBuffer
+ {
+  static constexpr uint32 Size = 64 * 1024;
+  std::unique_ptr<uint8[]> data{new uint8[Size]};
+  FileIO *fp{};
+  long pos = 0;
+  uint32 bytes = 0;	// valid once pending is false
+  bool failed = false;	// valid once pending is false
+  std::atomic_bool pending{};
+ };
+ std::array<ReadAheadBuffer, 2> ReadAhead;
+ std::mutex ReadAheadMutex;
+ std::condition_variable ReadAheadCond;	// signaled as each read completes
+
+ void ReadTrackData(CDRFILE_TRACK_INFO *track, uint8 *dest, uint32 size, long pos);
+ void StartReadAhead(FileIO *fp, long pos);
+ void WaitReadAhead();
 };
 
 
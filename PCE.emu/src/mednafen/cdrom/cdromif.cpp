@@ -129,6 +129,7 @@ class CDIF_MT : public CDIF
  int32 ra_lba;
  int32 ra_count;
  int32 last_read_lba;
+ int32 prefetch_lba;	// start of the range last handed to HintReadSector()
 };
 
 
@@ -268,6 +269,7 @@ int CDIF_MT::ReadThreadStart()
  ra_lba = 0;
  ra_count = 0;
  last_read_lba = LBA_Read_Maximum + 1;
+ prefetch_lba = LBA_Read_Maximum + 1;
 
  try
  {
@@ -282,6 +284,7 @@ int CDIF_MT::ReadThreadStart()
   ra_lba = 0;
   ra_count = 0;
   last_read_lba = LBA_Read_Maximum + 1;
+  prefetch_lba = LBA_Read_Maximum + 1;
   std::fill(SectorBuffers, SectorBuffers + SBSize, CDIF_Sector_Buffer());
  }
  catch(std::exception &e)
@@ -311,6 +314,7 @@ int CDIF_MT::ReadThreadStart()
                           static const int max_ra = 16;
 			  static const int initial_ra = 1;
 			  static const int speedmult_ra = 2;
+			  static const int32 prefetch_sectors = 150;	// 2 seconds at 1x speed
 			  int32 new_lba = msg.args[0];
 
 			  assert((unsigned int)max_ra < (SBSize / 4));
@@ -331,6 +335,14 @@ int CDIF_MT::ReadThreadStart()
 			  }
 
 			  last_read_lba = new_lba;
+
+			  // Have the image's pages read in the background ahead of the sector read-ahead
+			  // above, on a seek or once reading gets halfway through the last hinted range.
+			  if(new_lba < prefetch_lba || new_lba >= (prefetch_lba + prefetch_sectors / 2))
+			  {
+			   disc_cdaccess->HintReadSector(new_lba, prefetch_sectors);
+			   prefetch_lba = new_lba;
+			  }
 			 }
 			 break;
    }
@@ -1,6 +1,7 @@
 #define LOGTAG "main"
 #include <emuframework/EmuApp.hh>
 #include <emuframework/EmuAppInlines.hh>
+#include <emuframework/RomLoader.hh>
 #include "internal.hh"
 
 #include <snes9x.h>
@@ -11,6 +12,7 @@
 #ifndef SNES9X_VERSION_1_4
 #include <apu/apu.h>
 #include <controls.h>
+#include <stream.h>
 #else
 #include <apu.h>
 #include <soundux.h>
@@ -138,6 +140,41 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 		return EmuSystem::makeFileReadError();
 }
 
+#ifndef SNES9X_VERSION_1_4
+static size_t freezeToBuffer(StateBuffer &buff)
+{
+	buff.resize(buff.capacity());
+	memStream stream{buff.data(), buff.size()};
+	S9xFreezeToStream(&stream);
+	return stream.pos();
+}
+
+EmuSystem::Error EmuSystem::saveStateToBuffer(StateBuffer &buff)
+{
+	auto size = buff.capacity() ? freezeToBuffer(buff) : 0;
+	if(size == buff.size())
+	{
+		// state may have been truncated, re-size to the exact state size
+		auto freezeSize = S9xFreezeSize();
+		if(freezeSize > size)
+		{
+			buff.reserve(freezeSize);
+			size = freezeToBuffer(buff);
+		}
+	}
+	buff.resize(size);
+	return {};
+}
+
+EmuSystem::Error EmuSystem::loadStateFromBuffer(const StateBuffer &buff)
+{
+	if(S9xUnfreezeGameMem(buff.data(), buff.size()) != SUCCESS)
+		return EmuSystem::makeFileReadError();
+	IPPU.RenderThisFrame = TRUE;
+	return {};
+}
+#endif
+
 void EmuSystem::saveBackupMem() // for manually saving when not closing game
 {
 	if(gameIsRunning())
@@ -191,6 +228,19 @@ EmuSystem::Error EmuSystem::loadGame(IO &io, OnLoadProgressDelegate)
 		bcase 2: Settings.ForcePAL = 1;
 		bcase 3: Settings.ForceNTSC = Settings.ForcePAL = 1;
 	}
+	#ifndef SNES9X_VERSION_1_4
+	// Snes9x applies its own patches in LoadROMInPlace()
+	RomLoader loader{};
+	if(auto ec = loader.loadMapped(io, Memory.ROM, CMemory::MAX_ROM_SIZE);
+		ec)
+	{
+		return makeFileReadError();
+	}
+	if(!Memory.LoadROMInPlace(loader.size()))
+	{
+		return makeError("Error loading game");
+	}
+	#else
 	auto buffView = io.constBufferView();
 	if(!buffView)
 	{
@@ -200,6 +250,7 @@ EmuSystem::Error EmuSystem::loadGame(IO &io, OnLoadProgressDelegate)
 	{
 		return makeError("Error loading game");
 	}
+	#endif
 	setupSNESInput();
 	auto saveStr = sprintSRAMFilename();
 	Memory.LoadSRAM(saveStr.data());
@@ -245,6 +296,7 @@ static void mixSamples(int frames, bool renderAudio)
 
 void EmuSystem::runFrame(EmuVideo *video, bool renderAudio)
 {
+	IG_TRACE_SPAN("EmuSystem::runFrame");
 	if(unlikely(snesActiveInputPort != SNES_JOYPAD))
 	{
 		if(doubleClickFrames)
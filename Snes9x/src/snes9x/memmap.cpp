@@ -206,6 +206,7 @@
 
 #include <ctype.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 
 #include "snes9x.h"
 #include "memmap.h"
@@ -1081,7 +1082,10 @@ bool8 CMemory::Init (void)
     RAM	 = (uint8 *) malloc(0x20000);
     SRAM = (uint8 *) malloc(0x20000);
     VRAM = (uint8 *) malloc(0x10000);
-    ROM  = (uint8 *) malloc(MAX_ROM_SIZE + 0x200 + 0x8000);
+    // page aligned so RomLoader::loadMapped() can move a ROM file's pages in
+    ROM  = (uint8 *) mmap(NULL, ROM_ALLOC_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ROM == MAP_FAILED)
+        ROM = NULL;
 
 	IPPU.TileCache[TILE_2BIT]       = (uint8 *) malloc(MAX_2BIT_TILES * 64);
 	IPPU.TileCache[TILE_4BIT]       = (uint8 *) malloc(MAX_4BIT_TILES * 64);
@@ -1122,7 +1126,7 @@ bool8 CMemory::Init (void)
 	memset(RAM, 0,  0x20000);
 	memset(SRAM, 0, 0x20000);
 	memset(VRAM, 0, 0x10000);
-	memset(ROM, 0,  MAX_ROM_SIZE + 0x200 + 0x8000);
+	// ROM comes from mmap() already zeroed
 
 	memset(IPPU.TileCache[TILE_2BIT], 0,       MAX_2BIT_TILES * 64);
 	memset(IPPU.TileCache[TILE_4BIT], 0,       MAX_4BIT_TILES * 64);
@@ -1189,7 +1193,7 @@ void CMemory::Deinit (void)
 	if (ROM)
 	{
 		ROM -= 0x8000;
-		free(ROM);
+		munmap(ROM, ROM_ALLOC_SIZE);
 		ROM = NULL;
 	}
 
@@ -1552,8 +1556,17 @@ bool8 CMemory::LoadROMMem (const uint8 *source, uint32 sourceSize)
         return FALSE;
 
     memset(ROM,0, MAX_ROM_SIZE);
-    memset(&Multi, 0,sizeof(Multi));
     memcpy(ROM,source,sourceSize);
+    return LoadROMInPlace(sourceSize);
+}
+
+// ROM already holds the image, zeroed past it up to MAX_ROM_SIZE
+bool8 CMemory::LoadROMInPlace (uint32 sourceSize)
+{
+    if(sourceSize > MAX_ROM_SIZE)
+        return FALSE;
+
+    memset(&Multi, 0,sizeof(Multi));
 
     int32 romSize = HeaderRemove(sourceSize, ROM);
     if (!Settings.NoPatch)
@@ -200,6 +200,8 @@ struct CMemory
 {
 	enum
 	{ MAX_ROM_SIZE = 0x800000 };
+	// FillRAM area before ROM, copier header space after
+	static constexpr size_t ROM_ALLOC_SIZE = MAX_ROM_SIZE + 0x200 + 0x8000;
 
 	enum file_formats
 	{ FILE_ZIP, FILE_JMA, FILE_DEFAULT };
@@ -287,6 +289,7 @@ struct CMemory
 	uint32	FileLoader (uint8 *, const char *, uint32);
     uint32  MemLoader (uint8 *, const char*, uint32);
     bool8   LoadROMMem (const uint8 *, uint32);
+    bool8   LoadROMInPlace (uint32);
 	bool8	LoadROM (const char *);
     bool8	LoadROMInt (int32);
     bool8   LoadMultiCartMem (const uint8 *, uint32, const uint8 *, uint32, const uint8 *, uint32);
@@ -0,0 +1,71 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/config/defs.hh>
+#include <vector>
+
+namespace Audio
+{
+
+// Polyphase windowed-sinc resampler for interleaved S16 frames. The filter
+// dot products are written with vector types so they compile to SSE2/AVX
+// or NEON depending on the target.
+class Resampler
+{
+public:
+	enum class Quality : uint8
+	{
+		LOW, // 8 taps, nearest phase
+		MEDIUM, // 16 taps, interpolated phases
+		HIGH, // 32 taps, interpolated phases
+	};
+
+	static constexpr uint MAX_CHANNELS = 2;
+
+	Resampler() {}
+	bool init(double inRate, double outRate, uint channels, Quality quality = Quality::MEDIUM);
+	void deinit();
+	// clears the filter history without changing the rates
+	void reset();
+	// scales the output rate, values over 1 produce more output frames
+	void setRatioAdjust(double adjust);
+	// input frames needed before process() can return exactly outFrames frames
+	uint inputFramesNeeded(uint outFrames) const;
+	uint maxOutputFrames(uint inFrames) const;
+	// consumes all input frames and returns the number of frames written to out,
+	// frames not returned due to maxOutFrames are produced by the next call
+	uint process(const int16 *in, uint inFrames, int16 *out, uint maxOutFrames);
+	uint channels() const { return channels_; }
+	Quality quality() const { return quality_; }
+	explicit operator bool() const { return taps; }
+
+private:
+	std::vector<float> coeffs{}; // taps for each of PHASES + 1 phases
+	std::vector<float> hist[MAX_CHANNELS]{};
+	uint histFrames = 0;
+	uint taps = 0;
+	uint channels_ = 0;
+	double baseStep = 1; // input frames per output frame
+	double step = 1;
+	double pos = 0; // position of the next output frame in the history
+	Quality quality_ = Quality::MEDIUM;
+
+	void appendInput(const int16 *in, uint inFrames);
+	float filter(const float *data, double frac) const;
+};
+
+}
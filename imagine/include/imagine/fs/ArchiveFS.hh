@@ -18,7 +18,12 @@
 #include <imagine/config/defs.hh>
 #include <imagine/util/operators.hh>
 #include <imagine/io/ArchiveIO.hh>
+#include <imagine/io/FileIO.hh>
+#include <memory>
+#include <string>
 #include <system_error>
+#include <unordered_map>
+#include <vector>
 
 namespace FS
 {
@@ -60,8 +65,62 @@ static ArchiveIterator end(const ArchiveIterator &)
 	return {};
 }
 
-ArchiveIO fileFromArchive(const char *archivePath, const char *filePath);
-static ArchiveIO fileFromArchive(PathString archivePath, PathString filePath)
+// Entry list of an archive file, built once and cached by path so repeated
+// lookups don't rescan the archive. ZIP entries are read from the central
+// directory and opened by seeking straight to their data: stored entries
+// come back as a window over the mapped archive and deflated ones inflate
+// as they're read, seeking back from the nearest saved restart point.
+// Other formats and ZIP compression methods are listed
+// through libarchive and opened by scanning to the entry.
+class ArchiveIndex : public std::enable_shared_from_this<ArchiveIndex>
+{
+public:
+	struct Entry
+	{
+		std::string name;
+		uint64_t size;
+		uint64_t compressedSize;
+		uint64_t headerOffset; // ZIP local header
+		uint32 crc32;
+		uint16 method; // ZIP compression method, NO_METHOD if not indexed directly
+		bool isDirectory;
+	};
+
+	static constexpr uint16 NO_METHOD = 0xFFFF;
+
+	// returns the cached index if the file is unchanged
+	static std::shared_ptr<ArchiveIndex> open(const char *path, std::error_code &result);
+	static void clearCache();
+	const Entry *find(const char *name) const;
+	const Entry *findCRC(uint32 crc) const;
+	const std::vector<Entry> &entries() const { return entry; }
+	// ZIP stored & deflated entries can seek, others only read forward
+	GenericIO openEntry(const Entry &e);
+	// like openEntry() but entries that can't seek are decompressed into memory
+	GenericIO openSeekableEntry(const Entry &e);
+	// memory for decompressed blocks kept for seeking, shared by all open deflated entries
+	static void setBlockCacheLimit(size_t bytes);
+	static size_t blockCacheLimit();
+	const char *path() const { return path_.data(); }
+
+private:
+	PathString path_{};
+	FileIO file{};
+	std::vector<Entry> entry{};
+	std::unordered_map<std::string, uint32> nameMap{};
+	std::unordered_map<uint32, uint32> crcMap{};
+	std::uintmax_t fileSize = 0;
+	file_time_type fileTime{};
+
+	ArchiveIndex() {}
+	std::error_code init(const char *path);
+	bool readZipDirectory();
+	std::error_code readArchiveEntries();
+	GenericIO openByScan(const Entry &e);
+};
+
+GenericIO fileFromArchive(const char *archivePath, const char *filePath);
+static GenericIO fileFromArchive(PathString archivePath, PathString filePath)
 {
 	return fileFromArchive(archivePath.data(), filePath.data());
 }
@@ -36,10 +36,14 @@ public:
 		return open(buff, size, {});
 	}
 
+	// takes ownership of pages from mmap(), unmapped on close
+	std::error_code openMmap(void *buff, size_t size);
+	std::error_code moveMappingTo(void *addr) final;
 	void close() final;
 
 protected:
 	OnCloseDelegate onClose{};
+	bool isMmap = false;
 
 	// no copying outside of class
 	BufferMapIO(const BufferMapIO &) = default;
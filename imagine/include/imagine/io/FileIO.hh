@@ -43,5 +43,8 @@ static AssetIO openAppAssetIO(std::array<char, S> name, IO::AccessHint access, c
 }
 
 std::error_code writeToNewFile(const char *path, void *data, size_t size);
+// writes and syncs a temporary file, then renames it over path so a crash
+// leaves either the old or the new contents
+std::error_code writeToNewFileAtomic(const char *path, const void *data, size_t size);
 ssize_t readFromFile(const char *path, void *data, size_t size);
 std::error_code writeIOToNewFile(IO &io, const char *path);
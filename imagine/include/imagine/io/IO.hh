@@ -18,6 +18,7 @@
 #include <imagine/config/defs.hh>
 #include <imagine/util/bits.h>
 #include <imagine/util/BufferView.hh>
+#include <imagine/util/DelegateFunc.hh>
 #include <memory>
 #include <algorithm>
 #include <system_error>
@@ -38,6 +39,8 @@ public:
 	};
 
 	using SeekMode = int;
+	// bytesRead is -1 on error
+	using ReadAsyncDelegate = DelegateFunc<void (ssize_t bytesRead, std::error_code ec)>;
 };
 
 template <class IO>
@@ -118,6 +121,11 @@ public:
 	virtual ssize_t read(void *buff, size_t bytes, std::error_code *ecOut) = 0;
 	virtual ssize_t readAtPos(void *buff, size_t bytes, off_t offset, std::error_code *ecOut);
 	virtual const char *mmapConst() { return nullptr; };
+	// Moves the pages of a memory-mapped file to addr, replacing anything
+	// mapped from there to the page-rounded size, and closes the IO. The
+	// pages are writable & copy-on-write, so only the ones written cost
+	// memory. Returns ENOTSUP if the data isn't mapped from a file.
+	virtual std::error_code moveMappingTo(void *addr) { return {ENOTSUP, std::system_category()}; };
 
 	// writing
 	virtual ssize_t write(const void *buff, size_t bytes, std::error_code *ecOut) = 0;
@@ -132,6 +140,13 @@ public:
 	virtual size_t size() = 0;
 	virtual bool eof() = 0;
 	virtual void advise(off_t offset, size_t bytes, Advice advice) {}
+	// starts reading the range into the OS cache in the background so
+	// later reads don't block on the device, returns immediately
+	virtual void prefetch(off_t offset, size_t bytes) {}
+	// Reads at offset without blocking the caller and then calls onComplete
+	// from another thread. The IO and buff must stay valid until then, and
+	// an IO without its own readAtPos() can't be used meanwhile.
+	virtual void readAsync(void *buff, size_t bytes, off_t offset, ReadAsyncDelegate onComplete);
 	virtual explicit operator bool() = 0;
 };
 
@@ -157,6 +172,7 @@ public:
 	ssize_t read(void *buff, size_t bytes, std::error_code *ecOut);
 	ssize_t readAtPos(void *buff, size_t bytes, off_t offset, std::error_code *ecOut);
 	const char *mmapConst();
+	std::error_code moveMappingTo(void *addr);
 	ssize_t write(const void *buff, size_t bytes, std::error_code *ecOut);
 	std::error_code truncate(off_t offset);
 	off_t seek(off_t offset, IO::SeekMode mode, std::error_code *ecOut);
@@ -165,6 +181,8 @@ public:
 	size_t size();
 	bool eof();
 	void advise(off_t offset, size_t bytes, IO::Advice advice);
+	void prefetch(off_t offset, size_t bytes);
+	void readAsync(void *buff, size_t bytes, off_t offset, IO::ReadAsyncDelegate onComplete);
 	explicit operator bool();
 
 protected:
@@ -37,6 +37,7 @@ public:
 	explicit operator bool() override;
 	#if defined __linux__ || defined __APPLE__
 	void advise(off_t offset, size_t bytes, Advice advice) override;
+	void prefetch(off_t offset, size_t bytes) override;
 	#endif
 
 protected:
@@ -55,6 +55,7 @@ public:
 	ssize_t read(void *buff, size_t bytes, std::error_code *ecOut);
 	ssize_t readAtPos(void *buff, size_t bytes, off_t offset, std::error_code *ecOut);
 	const char *mmapConst();
+	std::error_code moveMappingTo(void *addr);
 	ssize_t write(const void *buff, size_t bytes, std::error_code *ecOut);
 	std::error_code truncate(off_t offset);
 	off_t seek(off_t offset, IO::SeekMode mode, std::error_code *ecOut);
@@ -63,6 +64,8 @@ public:
 	size_t size();
 	bool eof();
 	void advise(off_t offset, size_t bytes, IO::Advice advice);
+	void prefetch(off_t offset, size_t bytes);
+	void readAsync(void *buff, size_t bytes, off_t offset, IO::ReadAsyncDelegate onComplete);
 	explicit operator bool();
 
 protected:
@@ -50,6 +50,8 @@ public:
 	size_t size() final;
 	bool eof() final;
 	void advise(off_t offset, size_t bytes, Advice advice) final;
+	void prefetch(off_t offset, size_t bytes) final;
+	void readAsync(void *buff, size_t bytes, off_t offset, ReadAsyncDelegate onComplete) final;
 	explicit operator bool() final;
 
 protected:
@@ -0,0 +1,75 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/config/defs.hh>
+#include <system_error>
+#include <cstdint>
+
+// Scoped timing spans recorded into a per-thread ring and written out as
+// Chrome trace_event JSON, which chrome://tracing and the Perfetto UI both
+// open. Built in with imagineTrace := 1 (CONFIG_TRACE), otherwise the macros
+// expand to nothing. Recording starts disabled, see setEnabled().
+// Span names must be string literals, only the pointer is kept.
+
+#define IG_TRACE_CONCAT2(a, b) a##b
+#define IG_TRACE_CONCAT(a, b) IG_TRACE_CONCAT2(a, b)
+
+#ifdef CONFIG_TRACE
+#define IG_TRACE_SPAN(name) ::Trace::Span IG_TRACE_CONCAT(traceSpan_, __LINE__){name}
+#define IG_TRACE_THREAD_NAME(name) ::Trace::setThreadName(name)
+#else
+#define IG_TRACE_SPAN(name) do {} while(0)
+#define IG_TRACE_THREAD_NAME(name) do {} while(0)
+#endif
+
+namespace Trace
+{
+
+#ifdef CONFIG_TRACE
+static constexpr bool isSupported = true;
+
+class Span
+{
+public:
+	Span(const char *name);
+	~Span();
+
+private:
+	const char *name;
+	uint64_t start;
+};
+
+void setEnabled(bool on);
+bool isEnabled();
+// names the calling thread's track, the string is copied
+void setThreadName(const char *name);
+// recording is paused while the rings are read
+std::error_code writeJSON(const char *path);
+// disables recording and frees all recorded events,
+// call once other threads are no longer inside a span
+void deinit();
+#else
+static constexpr bool isSupported = false;
+
+static void setEnabled(bool on) {}
+static bool isEnabled() { return false; }
+static void setThreadName(const char *name) {}
+static std::error_code writeJSON(const char *path) { return {ENOTSUP, std::system_category()}; }
+static void deinit() {}
+#endif
+
+}
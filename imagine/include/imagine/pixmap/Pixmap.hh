@@ -19,6 +19,7 @@
 #include <imagine/pixmap/PixelFormat.hh>
 #include <imagine/util/rectangle2.h>
 #include <imagine/util/DelegateFunc.hh>
+#include <imagine/logger/Trace.hh>
 
 namespace IG
 {
@@ -90,6 +91,7 @@ public:
 		{
 			return;
 		}
+		IG_TRACE_SPAN("Pixmap::writeTransformed");
 		auto srcBytesPerPixel = pixmap.format().bytesPerPixel();
 		switch(format().bytesPerPixel())
 		{
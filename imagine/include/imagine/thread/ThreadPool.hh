@@ -0,0 +1,112 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/config/defs.hh>
+#include <imagine/thread/Thread.hh>
+#include <imagine/util/DelegateFunc.hh>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace IG
+{
+
+// Task pool with one deque per worker thread. A worker runs its own newest
+// task first and steals the oldest task of another worker when out of work.
+// Threads waiting on a TaskGroup run queued tasks until none are left and
+// only then block, so tasks may spawn and wait on other tasks. Tasks still
+// queued at deinit() are run before the workers exit. Tasks are
+// DelegateFuncs, capture a pointer to any state bigger than two pointers.
+class ThreadPool
+{
+public:
+	using TaskDelegate = DelegateFunc<void ()>;
+	using RangeDelegate = DelegateFunc<void (uint begin, uint end)>;
+
+	class TaskGroup
+	{
+	public:
+		TaskGroup(ThreadPool &pool): pool{pool} {}
+		~TaskGroup() { wait(); }
+		TaskGroup(const TaskGroup&) = delete;
+		void run(TaskDelegate task);
+		// returns once every task run in this group completes
+		void wait();
+
+	private:
+		friend class ThreadPool;
+		ThreadPool &pool;
+		std::atomic_uint pending{};
+		std::mutex doneMutex{};
+		std::condition_variable doneCond{};
+
+		void taskDone();
+	};
+
+	ThreadPool() {}
+	~ThreadPool();
+	ThreadPool(const ThreadPool&) = delete;
+	// 0 threads makes one less than the CPU count since the waiting thread
+	// also runs tasks, pinThreads binds each worker to one CPU where supported
+	bool init(uint threads = 0, bool pinThreads = false);
+	void deinit();
+	uint threads() const { return workers; }
+	explicit operator bool() const { return workers; }
+	void run(TaskDelegate task, TaskGroup *group = nullptr);
+	// calls func(begin, end) on sub-ranges of at least grainSize indices spread
+	// over the pool and the calling thread, returns when the whole range is done
+	template<class Func>
+	void parallelFor(uint begin, uint end, Func &&func, uint grainSize = 1)
+	{
+		auto funcPtr = &func;
+		runParallelFor(begin, end, [funcPtr](uint b, uint e){ (*funcPtr)(b, e); }, grainSize);
+	}
+
+	// app-wide pool with default settings, created on first use
+	static ThreadPool &shared();
+
+private:
+	struct Task
+	{
+		TaskDelegate func{};
+		TaskGroup *group{};
+	};
+
+	struct Worker
+	{
+		std::mutex mutex{};
+		std::deque<Task> tasks{};
+		std::unique_ptr<IG::thread> thread{};
+	};
+
+	std::unique_ptr<Worker[]> worker{};
+	uint workers = 0;
+	std::atomic_uint queuedTasks{};
+	std::atomic_uint nextSubmitWorker{};
+	std::mutex sleepMutex{};
+	std::condition_variable sleepCond{};
+	bool quit = false;
+
+	void runParallelFor(uint begin, uint end, RangeDelegate func, uint grainSize);
+	bool runQueuedTask(uint firstWorker);
+	void workerLoop(uint idx, bool pin);
+	static void runTask(Task &task);
+};
+
+}
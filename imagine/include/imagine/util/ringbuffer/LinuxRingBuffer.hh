@@ -20,40 +20,73 @@
 #include <sys/mman.h>
 #include <unistd.h>
 #include <imagine/util/system/pagesize.h>
+#include <imagine/logger/logger.h>
 #ifdef __ANDROID__
 #include <sys/syscall.h>
 #endif
 
-template <class COUNT = std::atomic_uint, class SIZE = unsigned int>
-class StaticLinuxRingBuffer
+// Maps the buffer's pages twice back to back so any span starting in the
+// first copy is contiguous in memory
+class LinuxMirroredMemory
 {
 public:
-	constexpr StaticLinuxRingBuffer() {}
+	static constexpr bool isMirrored = true;
 
-	bool init(SIZE size)
+	static char *map(size_t size, size_t &allocSize)
 	{
-		deinit();
-		buffSize = size;
-		allocBuffSize = roundUpToPageSize(size);
-		logMsg("allocating ring buffer with size %d (%d rounded up)", size, allocBuffSize);
-		auto addr = mmap(nullptr, allocBuffSize*2, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+		allocSize = roundUpToPageSize(size);
+		logMsg("allocating ring buffer with size %zu (%zu rounded up)", size, allocSize);
+		auto addr = mmap(nullptr, allocSize*2, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
 		if(addr == MAP_FAILED)
 		{
 			logErr("error in mmap");
-			deinit();
-			return false;
+			return nullptr;
+		}
+		auto buff = (char*)addr;
+		// undocumented mremap feature that mirrors/aliases mappings when old_size == 0
+		auto mirror = mremap(buff, 0, allocSize, MREMAP_MAYMOVE | MREMAP_FIXED, buff + allocSize);
+		if(mirror == MAP_FAILED)
+		{
+			logErr("error in mremap");
+			unmap(buff, allocSize);
+			return nullptr;
 		}
-		buff = (char*)addr;
+		return buff;
+	}
+
+	static void unmap(char *buff, size_t allocSize)
+	{
+		if(munmap(buff, allocSize*2) == -1)
 		{
-			// undocumented mremap feature that mirrors/aliases mappings when old_size == 0
-			auto mirror = mremap(buff, 0, allocBuffSize, MREMAP_MAYMOVE | MREMAP_FIXED, buff + allocBuffSize);
-			if(mirror == MAP_FAILED)
-			{
-				logErr("error in mremap");
-				deinit();
-				return false;
-			}
+			logWarn("error in unmap");
 		}
+	}
+
+private:
+	#ifdef __ANDROID__
+	// Bionic is missing extended mremap with new_address parameter
+	static void *mremap(void *old_address, size_t old_size, size_t new_size, int flags, void *new_address)
+	{
+		return (void*)syscall(__NR_mremap, old_address, old_size, new_size, flags, new_address);
+	}
+	#endif
+};
+
+template <class COUNT = std::atomic_uint, class SIZE = unsigned int>
+class StaticLinuxRingBuffer
+{
+public:
+	constexpr StaticLinuxRingBuffer() {}
+
+	bool init(SIZE size)
+	{
+		deinit();
+		size_t allocSize;
+		buff = LinuxMirroredMemory::map(size, allocSize);
+		if(!buff)
+			return false;
+		buffSize = size;
+		allocBuffSize = allocSize;
 		reset();
 		return true;
 	}
@@ -62,10 +95,7 @@ public:
 	{
 		if(buff)
 		{
-			if(munmap(buff, allocBuffSize*2) == -1)
-			{
-				logWarn("error in unmap");
-			}
+			LinuxMirroredMemory::unmap(buff, allocBuffSize);
 			buff = nullptr;
 		}
 		buffSize = 0;
@@ -151,14 +181,6 @@ private:
 	SIZE buffSize{};
 	SIZE allocBuffSize{};
 
-	#ifdef __ANDROID__
-	// Bionic is missing extended mremap with new_address parameter
-	static void *mremap(void *old_address, size_t old_size, size_t new_size, int flags, void *new_address)
-	{
-		return (void*)syscall(__NR_mremap, old_address, old_size, new_size, flags, new_address);
-	}
-	#endif
-
 	char *wrapPtr(char *ptr) const
 	{
 		if(ptr >= &buff[allocBuffSize])
@@ -18,49 +18,71 @@
 #include <atomic>
 #include <mach/mach.h>
 #include <mach/vm_map.h>
+#include <imagine/logger/logger.h>
 
-template <class COUNT = std::atomic_uint, class SIZE = unsigned int>
-class StaticMachRingBuffer
+// Maps the buffer's pages twice back to back so any span starting in the
+// first copy is contiguous in memory
+class MachMirroredMemory
 {
 public:
-	constexpr StaticMachRingBuffer() {}
+	static constexpr bool isMirrored = true;
 
-	bool init(SIZE size)
+	static char *map(size_t size, size_t &allocSize)
 	{
-		deinit();
-		buffSize = size;
-		allocBuffSize = round_page(size);
+		allocSize = round_page(size);
 		vm_address_t addr;
-		logMsg("allocating ring buffer with size %d (%d rounded up)", size, allocBuffSize);
-		if(vm_allocate(mach_task_self(), &addr, allocBuffSize*2, VM_FLAGS_ANYWHERE) != KERN_SUCCESS)
+		logMsg("allocating ring buffer with size %zu (%zu rounded up)", size, allocSize);
+		if(vm_allocate(mach_task_self(), &addr, allocSize*2, VM_FLAGS_ANYWHERE) != KERN_SUCCESS)
 		{
 			logErr("error in vm_allocate");
-			deinit();
-			return false;
+			return nullptr;
 		}
-		buff = (char*)addr;
+		#ifdef __ARM_ARCH_6K__
+		// VM_FLAGS_OVERWRITE isn't supported on iOS <= 4.2.1 (the max deployment target for ARMv6)
+		// so deallocate the 2nd half of the buffer first. This introduces a race condition but the
+		// chance of it causing a problem is very low.
+		if(vm_deallocate(mach_task_self(), addr+allocSize, allocSize) != KERN_SUCCESS)
+		{
+			logWarn("error in vm_deallocate for 2nd half, buffer may not stay in sync");
+		}
+		#endif
+		vm_prot_t currProtect, maxProtect;
+		vm_address_t mirrorAddr = addr + allocSize;
+		if(vm_remap(mach_task_self(), &mirrorAddr, allocSize, 0,
+			VM_FLAGS_FIXED | VM_FLAGS_OVERWRITE, mach_task_self(), addr,
+			0, &currProtect, &maxProtect, VM_INHERIT_COPY) != KERN_SUCCESS)
+		{
+			logErr("error in vm_remap");
+			unmap((char*)addr, allocSize);
+			return nullptr;
+		}
+		return (char*)addr;
+	}
+
+	static void unmap(char *buff, size_t allocSize)
+	{
+		if(vm_deallocate(mach_task_self(), (vm_address_t)buff, allocSize*2) != KERN_SUCCESS)
 		{
-			#ifdef __ARM_ARCH_6K__
-			// VM_FLAGS_OVERWRITE isn't supported on iOS <= 4.2.1 (the max deployment target for ARMv6)
-			// so deallocate the 2nd half of the buffer first. This introduces a race condition but the
-			// chance of it causing a problem is very low.
-			if(vm_deallocate(mach_task_self(), addr+allocBuffSize, allocBuffSize) != KERN_SUCCESS)
-			{
-				logWarn("error in vm_deallocate for 2nd half, buffer may not stay in sync");
-			}
-			#endif
-
-			vm_prot_t currProtect, maxProtect;
-			vm_address_t mirrorAddr = addr + allocBuffSize;
-			if(vm_remap(mach_task_self(), &mirrorAddr, allocBuffSize, 0,
-				VM_FLAGS_FIXED | VM_FLAGS_OVERWRITE, mach_task_self(), addr,
-				0, &currProtect, &maxProtect, VM_INHERIT_COPY) != KERN_SUCCESS)
-			{
-				logErr("error in vm_remap");
-				deinit();
-				return false;
-			}
+			logWarn("error in vm_deallocate");
 		}
+	}
+};
+
+template <class COUNT = std::atomic_uint, class SIZE = unsigned int>
+class StaticMachRingBuffer
+{
+public:
+	constexpr StaticMachRingBuffer() {}
+
+	bool init(SIZE size)
+	{
+		deinit();
+		size_t allocSize;
+		buff = MachMirroredMemory::map(size, allocSize);
+		if(!buff)
+			return false;
+		buffSize = size;
+		allocBuffSize = allocSize;
 		reset();
 		return true;
 	}
@@ -69,10 +91,7 @@ public:
 	{
 		if(buff)
 		{
-			if(vm_deallocate(mach_task_self(), (vm_address_t)buff, allocBuffSize*2) != KERN_SUCCESS)
-			{
-				logWarn("error in vm_deallocate");
-			}
+			MachMirroredMemory::unmap(buff, allocBuffSize);
 			buff = nullptr;
 		}
 		buffSize = 0;
@@ -0,0 +1,240 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/util/ringbuffer/RingBuffer.hh>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+
+// Lock-free ring for passing PCM data from one producer thread to one
+// consumer thread, usually the app and an audio callback. Each side owns
+// its own position, storing it with release and loading the other side's
+// with acquire, so no read-modify-write atomics are needed. MEMORY provides
+// the storage, a mirrored mapping (LinuxMirroredMemory/MachMirroredMemory)
+// makes every span contiguous while plain memory splits copies in two.
+template <class MEMORY = MallocRingBufferMemory>
+class StaticPcmRingBuffer
+{
+public:
+	// fill level telemetry, written by one side each
+	struct Stats
+	{
+		size_t minFill; // lowest fill seen by the consumer
+		size_t maxFill; // highest fill seen by the producer
+		uint shortReads; // reads that wanted more than was buffered
+	};
+
+	constexpr StaticPcmRingBuffer() {}
+
+	bool init(size_t size)
+	{
+		deinit();
+		size_t allocSize;
+		buff = MEMORY::map(size, allocSize);
+		if(!buff)
+			return false;
+		capacity = size;
+		wrapSize = allocSize;
+		reset();
+		return true;
+	}
+
+	void deinit()
+	{
+		if(buff)
+		{
+			MEMORY::unmap(buff, wrapSize);
+			buff = nullptr;
+		}
+		capacity = wrapSize = 0;
+		reset();
+	}
+
+	// not thread-safe, both sides must be idle
+	void reset()
+	{
+		writePos.store(0, std::memory_order_relaxed);
+		readPos.store(0, std::memory_order_relaxed);
+		resetStats();
+	}
+
+	size_t size() const
+	{
+		return capacity;
+	}
+
+	// producer side
+
+	size_t freeSpace() const
+	{
+		return capacity - used(writePos.load(std::memory_order_relaxed), readPos.load(std::memory_order_acquire));
+	}
+
+	size_t freeContiguousSpace() const
+	{
+		auto w = writePos.load(std::memory_order_relaxed);
+		auto free = capacity - used(w, readPos.load(std::memory_order_acquire));
+		return MEMORY::isMirrored ? free : std::min(free, wrapSize - offset(w));
+	}
+
+	size_t write(const void *data, size_t size)
+	{
+		auto w = writePos.load(std::memory_order_relaxed);
+		auto fill = used(w, readPos.load(std::memory_order_acquire));
+		size = std::min(size, capacity - fill);
+		copyIn(offset(w), (const char*)data, size);
+		publishWrite(w, size, fill);
+		return size;
+	}
+
+	char *writeAddr() const
+	{
+		return &buff[offset(writePos.load(std::memory_order_relaxed))];
+	}
+
+	void commitWrite(size_t size)
+	{
+		auto w = writePos.load(std::memory_order_relaxed);
+		auto fill = used(w, readPos.load(std::memory_order_acquire));
+		assert(size <= capacity - fill);
+		publishWrite(w, size, fill);
+	}
+
+	// consumer side
+
+	size_t writtenSize() const
+	{
+		return used(writePos.load(std::memory_order_acquire), readPos.load(std::memory_order_relaxed));
+	}
+
+	size_t read(void *data, size_t size)
+	{
+		auto r = readPos.load(std::memory_order_relaxed);
+		auto fill = used(writePos.load(std::memory_order_acquire), r);
+		noteRead(size, fill);
+		size = std::min(size, fill);
+		copyOut((char*)data, offset(r), size);
+		readPos.store(advance(r, size), std::memory_order_release);
+		return size;
+	}
+
+	char *readAddr() const
+	{
+		return &buff[offset(readPos.load(std::memory_order_relaxed))];
+	}
+
+	void commitRead(size_t size)
+	{
+		auto r = readPos.load(std::memory_order_relaxed);
+		auto fill = used(writePos.load(std::memory_order_acquire), r);
+		noteRead(size, fill);
+		assert(size <= fill);
+		readPos.store(advance(r, size), std::memory_order_release);
+	}
+
+	// given an address inside the ring buffer, return the address
+	// after moving the pointer forward, wrapping as needed
+	char *advanceAddr(char *ptr, size_t size) const
+	{
+		ptr += size;
+		if(ptr >= &buff[wrapSize])
+			ptr -= wrapSize;
+		return ptr;
+	}
+
+	Stats stats() const
+	{
+		return {minFill.load(std::memory_order_relaxed), maxFill.load(std::memory_order_relaxed),
+			shortReads.load(std::memory_order_relaxed)};
+	}
+
+	void resetStats()
+	{
+		minFill.store(capacity, std::memory_order_relaxed);
+		maxFill.store(0, std::memory_order_relaxed);
+		shortReads.store(0, std::memory_order_relaxed);
+	}
+
+private:
+	char *buff{};
+	// positions run over [0, wrapSize * 2) so a full and an empty ring differ
+	std::atomic<size_t> writePos{}, readPos{};
+	std::atomic<size_t> minFill{}, maxFill{};
+	std::atomic_uint shortReads{};
+	size_t capacity = 0;
+	size_t wrapSize = 0;
+
+	size_t used(size_t w, size_t r) const
+	{
+		return w >= r ? w - r : w + wrapSize * 2 - r;
+	}
+
+	size_t offset(size_t pos) const
+	{
+		return pos >= wrapSize ? pos - wrapSize : pos;
+	}
+
+	size_t advance(size_t pos, size_t size) const
+	{
+		pos += size;
+		return pos >= wrapSize * 2 ? pos - wrapSize * 2 : pos;
+	}
+
+	void publishWrite(size_t w, size_t size, size_t fill)
+	{
+		writePos.store(advance(w, size), std::memory_order_release);
+		if(fill + size > maxFill.load(std::memory_order_relaxed))
+			maxFill.store(fill + size, std::memory_order_relaxed);
+	}
+
+	void noteRead(size_t size, size_t fill)
+	{
+		if(fill < minFill.load(std::memory_order_relaxed))
+			minFill.store(fill, std::memory_order_relaxed);
+		if(size > fill)
+			shortReads.store(shortReads.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+
+	void copyIn(size_t off, const char *data, size_t size)
+	{
+		auto firstSize = MEMORY::isMirrored ? size : std::min(size, wrapSize - off);
+		memcpy(&buff[off], data, firstSize);
+		if(firstSize != size)
+			memcpy(buff, data + firstSize, size - firstSize);
+	}
+
+	void copyOut(char *data, size_t off, size_t size) const
+	{
+		auto firstSize = MEMORY::isMirrored ? size : std::min(size, wrapSize - off);
+		memcpy(data, &buff[off], firstSize);
+		if(firstSize != size)
+			memcpy(data + firstSize, buff, size - firstSize);
+	}
+};
+
+template <class MEMORY = MallocRingBufferMemory>
+class PcmRingBuffer : public StaticPcmRingBuffer<MEMORY>
+{
+public:
+	using StaticPcmRingBuffer<MEMORY>::StaticPcmRingBuffer;
+
+	~PcmRingBuffer()
+	{
+		StaticPcmRingBuffer<MEMORY>::deinit();
+	}
+};
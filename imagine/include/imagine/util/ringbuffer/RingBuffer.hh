@@ -18,6 +18,26 @@
 #include <imagine/util/algorithm.h>
 #include <atomic>
 #include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+// Plain heap memory without mirroring, spans crossing the end are split
+class MallocRingBufferMemory
+{
+public:
+	static constexpr bool isMirrored = false;
+
+	static char *map(size_t size, size_t &allocSize)
+	{
+		allocSize = size;
+		return (char*)malloc(size);
+	}
+
+	static void unmap(char *buff, size_t)
+	{
+		free(buff);
+	}
+};
 
 template <class COUNT = std::atomic_uint, class SIZE = unsigned int>
 class StaticRingBuffer
@@ -73,14 +93,11 @@ public:
 		if(size > freeSpace())
 			size = freeSpace();
 
-		char *writePos = end;
-		iterateTimes(size, i)
-		{
-			//logMsg("addr %p", writePos);
-			*writePos = ((char*)buff)[i];
-			writePos = advanceAddr(writePos, 1);
-		}
-		end = writePos;
+		// at most two copies, up to the end of the buffer and then from its start
+		auto firstSize = std::min(size, freeContiguousSpace());
+		memcpy(end, buff, firstSize);
+		memcpy(this->buff, (const char*)buff + firstSize, size - firstSize);
+		end = advanceAddr(end, size);
 		written += size;
 
 		assert((SIZE)written <= buffSize);
@@ -106,14 +123,10 @@ public:
 		if(size > (SIZE)written)
 			size = written;
 
-		char *readPos = start;
-		iterateTimes(size, i)
-		{
-			//logMsg("addr %p", readPos);
-			((char*)buff)[i] = *readPos;
-			readPos = advanceAddr(readPos, 1);
-		}
-		start = readPos;
+		auto firstSize = std::min(size, (SIZE)(((uintptr_t)this->buff + buffSize) - (uintptr_t)start));
+		memcpy(buff, start, firstSize);
+		memcpy((char*)buff + firstSize, this->buff, size - firstSize);
+		start = advanceAddr(start, size);
 		written -= size;
 
 		//logMsg("read %d bytes", (int)size);
@@ -0,0 +1,283 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "Resampler"
+#include <imagine/audio/Resampler.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/algorithm.h>
+#include <imagine/util/math/int.hh>
+#include <imagine/util/math/math.hh>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Audio
+{
+
+static constexpr uint PHASES = 256;
+// allows decimating by up to 32:1 at the highest quality
+static constexpr uint MAX_TAPS = 1024;
+
+#if defined __AVX__
+static constexpr uint VEC_FLOATS = 8;
+#else
+static constexpr uint VEC_FLOATS = 4;
+#endif
+// maps to SSE/AVX registers on x86 and NEON on ARM, tap counts are always
+// a multiple of 8 so no scalar tail is needed
+typedef float FloatVec __attribute__((vector_size(VEC_FLOATS * sizeof(float))));
+
+struct QualityParams
+{
+	uint taps;
+	double beta; // Kaiser window shape
+	double rolloff; // pass band as a fraction of the lower Nyquist frequency
+};
+
+static QualityParams qualityParams(Resampler::Quality quality)
+{
+	switch(quality)
+	{
+		case Resampler::Quality::LOW: return {8, 5., .85};
+		case Resampler::Quality::MEDIUM: return {16, 7., .9};
+		default: return {32, 9., .95};
+	}
+}
+
+static FloatVec loadVec(const float *data)
+{
+	FloatVec v;
+	memcpy(&v, data, sizeof(v));
+	return v;
+}
+
+static float sumVec(FloatVec v)
+{
+	float sum = 0;
+	iterateTimes(VEC_FLOATS, i)
+	{
+		sum += v[i];
+	}
+	return sum;
+}
+
+static double besselI0(double x)
+{
+	double sum = 1, term = 1;
+	for(uint k = 1; k < 64; k++)
+	{
+		auto t = x / (2. * k);
+		term *= t * t;
+		sum += term;
+		if(term < sum * 1e-12)
+			break;
+	}
+	return sum;
+}
+
+static double sinc(double x)
+{
+	if(std::abs(x) < 1e-9)
+		return 1.;
+	return std::sin(M_PI * x) / (M_PI * x);
+}
+
+bool Resampler::init(double inRate, double outRate, uint channels, Quality quality)
+{
+	if(inRate <= 0 || outRate <= 0 || !channels || channels > MAX_CHANNELS)
+	{
+		logErr("invalid config: %f -> %fHz, %u channels", inRate, outRate, channels);
+		deinit();
+		return false;
+	}
+	auto params = qualityParams(quality);
+	// when decimating the cutoff moves down and the filter gets longer to keep its shape
+	double scale = std::min(1., outRate / inRate);
+	uint neededTaps = IG::alignRoundedUp((uint)std::ceil(params.taps / scale), 8);
+	if(neededTaps > MAX_TAPS)
+	{
+		// a shorter filter would no longer reject the aliased band
+		logErr("unsupported ratio: %f -> %fHz needs %u taps, max is %u", inRate, outRate, neededTaps, MAX_TAPS);
+		deinit();
+		return false;
+	}
+	taps = neededTaps;
+	double cutoff = params.rolloff * scale;
+	channels_ = channels;
+	quality_ = quality;
+	baseStep = step = inRate / outRate;
+	coeffs.resize((PHASES + 1) * taps);
+	double halfTaps = taps / 2;
+	double beta = params.beta;
+	double i0Beta = besselI0(beta);
+	iterateTimes(PHASES + 1, p)
+	{
+		auto phaseCoeffs = &coeffs[p * taps];
+		double frac = p / (double)PHASES;
+		double sum = 0;
+		iterateTimes(taps, k)
+		{
+			double x = (double)k - (halfTaps - 1) - frac;
+			double w = x / halfTaps;
+			double window = besselI0(beta * std::sqrt(std::max(0., 1. - w * w))) / i0Beta;
+			double c = cutoff * sinc(cutoff * x) * window;
+			phaseCoeffs[k] = c;
+			sum += c;
+		}
+		// unity gain at DC for every phase
+		iterateTimes(taps, k)
+		{
+			phaseCoeffs[k] /= sum;
+		}
+	}
+	reset();
+	logMsg("%.1f -> %.1fHz, %u channels, %u taps", inRate, outRate, channels, taps);
+	return true;
+}
+
+void Resampler::deinit()
+{
+	coeffs = {};
+	for(auto &h : hist)
+	{
+		h = {};
+	}
+	taps = 0;
+	channels_ = 0;
+	histFrames = 0;
+	pos = 0;
+}
+
+void Resampler::reset()
+{
+	if(!taps)
+		return;
+	// pre-fill so the first output frame lines up with the first input frame
+	histFrames = taps / 2 - 1;
+	iterateTimes(channels_, c)
+	{
+		if(hist[c].size() < histFrames)
+			hist[c].resize(histFrames);
+		std::fill_n(hist[c].data(), histFrames, 0.f);
+	}
+	pos = 0;
+}
+
+void Resampler::setRatioAdjust(double adjust)
+{
+	if(adjust <= 0)
+		return;
+	step = baseStep / adjust;
+}
+
+uint Resampler::inputFramesNeeded(uint outFrames) const
+{
+	if(!outFrames || !taps)
+		return 0;
+	// step forward the same way process() does so the result is exact
+	double p = pos;
+	iterateTimes(outFrames - 1, i)
+	{
+		p += step;
+	}
+	uint needed = (uint)p + taps;
+	return needed > histFrames ? needed - histFrames : 0;
+}
+
+uint Resampler::maxOutputFrames(uint inFrames) const
+{
+	return std::ceil((histFrames + inFrames - pos) / step) + 1;
+}
+
+void Resampler::appendInput(const int16 *in, uint inFrames)
+{
+	iterateTimes(channels_, c)
+	{
+		if(hist[c].size() < histFrames + inFrames)
+			hist[c].resize(histFrames + inFrames);
+		auto dest = &hist[c][histFrames];
+		auto src = &in[c];
+		iterateTimes(inFrames, i)
+		{
+			dest[i] = *src;
+			src += channels_;
+		}
+	}
+	histFrames += inFrames;
+}
+
+float Resampler::filter(const float *data, double frac) const
+{
+	double phasePos = frac * PHASES;
+	if(quality_ == Quality::LOW)
+	{
+		auto c = &coeffs[std::lround(phasePos) * taps];
+		FloatVec sum{};
+		for(uint i = 0; i < taps; i += VEC_FLOATS)
+		{
+			sum += loadVec(&data[i]) * loadVec(&c[i]);
+		}
+		return sumVec(sum);
+	}
+	uint p = phasePos;
+	float t = phasePos - p;
+	auto c0 = &coeffs[p * taps];
+	auto c1 = c0 + taps;
+	FloatVec sum0{}, sum1{};
+	for(uint i = 0; i < taps; i += VEC_FLOATS)
+	{
+		auto d = loadVec(&data[i]);
+		sum0 += d * loadVec(&c0[i]);
+		sum1 += d * loadVec(&c1[i]);
+	}
+	return sumVec(sum0) * (1.f - t) + sumVec(sum1) * t;
+}
+
+uint Resampler::process(const int16 *in, uint inFrames, int16 *out, uint maxOutFrames)
+{
+	if(!taps)
+		return 0;
+	if(inFrames)
+		appendInput(in, inFrames);
+	uint outFrames = 0;
+	while(outFrames < maxOutFrames)
+	{
+		uint start = pos;
+		if(start + taps > histFrames)
+			break;
+		double frac = pos - start;
+		iterateTimes(channels_, c)
+		{
+			auto sample = std::lrint(filter(&hist[c][start], frac));
+			*out++ = IG::clamp(sample, -32768l, 32767l);
+		}
+		outFrames++;
+		pos += step;
+	}
+	// drop history that no future output frame will read
+	uint consumed = std::min((uint)pos, histFrames);
+	if(consumed)
+	{
+		iterateTimes(channels_, c)
+		{
+			memmove(hist[c].data(), &hist[c][consumed], (histFrames - consumed) * sizeof(float));
+		}
+		histFrames -= consumed;
+		pos -= consumed;
+	}
+	return outFrames;
+}
+
+}
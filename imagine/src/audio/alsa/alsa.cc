@@ -23,8 +23,10 @@
 #include <alsa/asoundlib.h>
 #include <sys/time.h>
 #include <math.h>
+#include <algorithm>
 #include <imagine/audio/Audio.hh>
 #include <imagine/logger/logger.h>
+#include <imagine/logger/Trace.hh>
 #include <imagine/base/Base.hh>
 #include "alsautils.h"
 
@@ -33,8 +35,12 @@ namespace Audio
 
 PcmFormat pcmFormat;
 static snd_pcm_t *pcmHnd{};
-static snd_pcm_uframes_t bufferSize, periodSize;
+static snd_pcm_uframes_t bufferSize, periodSize, startThreshold;
 static bool useMmap;
+// mirrors SND_PCM_STATE_RUNNING so writes don't have to query the PCM state,
+// updated on start/pause/drop, after commits reach the start threshold, and on recovery
+static bool isRunning;
+static snd_pcm_sframes_t lastFramesFree;
 static uint wantedLatency = 100000;
 
 int maxRate()
@@ -86,16 +92,38 @@ int frameDelay()
 	return delay;
 }
 
+// only called after an ALSA call fails, so the write path never has to poll the PCM state
+static bool recoverPcm(int err)
+{
+	if(snd_pcm_recover(pcmHnd, err, 1) < 0)
+	{
+		logErr("unable to recover from error: %s", alsaPcmWriteErrorToString(err));
+		isRunning = false;
+		return false;
+	}
+	// recovery leaves the PCM prepared, the next commit past the start threshold restarts it
+	isRunning = false;
+	logMsg("recovered from error: %s", alsaPcmWriteErrorToString(err));
+	return true;
+}
+
 int framesFree()
 {
 	if(unlikely(!isOpen()))
 		return 0;
 	auto frames = snd_pcm_avail_update(pcmHnd);
-	if(frames < 0)
+	if(unlikely(frames < 0))
 	{
-		logWarn("error %d getting frames free", (int)frames);
-		frames = 0;
+		if(!recoverPcm(frames))
+			return 0;
+		frames = snd_pcm_avail_update(pcmHnd);
+		if(frames < 0)
+		{
+			logWarn("error %d getting frames free", (int)frames);
+			return 0;
+		}
 	}
+	lastFramesFree = frames;
 	return frames;
 }
 
@@ -105,6 +133,7 @@ void pausePcm()
 		return;
 	logMsg("pausing playback");
 	snd_pcm_pause(pcmHnd, 1);
+	isRunning = false;
 }
 
 void resumePcm()
@@ -124,7 +153,11 @@ void resumePcm()
 		bcase SND_PCM_STATE_SUSPENDED:
 			logMsg("resuming PCM");
 			snd_pcm_resume(pcmHnd);
+		bdefault:
+			isRunning = state == SND_PCM_STATE_RUNNING;
+			return;
 	}
+	isRunning = true;
 }
 
 void clearPcm()
@@ -134,134 +167,125 @@ void clearPcm()
 	logMsg("clearing queued samples");
 	snd_pcm_drop(pcmHnd);
 	snd_pcm_prepare(pcmHnd);
+	isRunning = false;
 }
 
-class AlsaMmapContext : public BufferContext
+// ALSA starts a prepared PCM by itself once the queued frames reach the start threshold
+static void updateRunningAfterWrite(snd_pcm_uframes_t frames)
 {
-public:
-	const snd_pcm_channel_area_t *areas = nullptr;
-	snd_pcm_uframes_t offset = 0;
-	snd_pcm_t *pcmHnd = nullptr;
+	lastFramesFree -= std::min((snd_pcm_sframes_t)frames, lastFramesFree);
+	if(!isRunning && bufferSize - lastFramesFree >= startThreshold)
+		isRunning = true;
+}
 
-	constexpr AlsaMmapContext() {}
+static snd_pcm_uframes_t mmapOffset = 0;
 
-	CallResult begin(snd_pcm_t *pcmHnd, snd_pcm_uframes_t *frames)
+// maps up to wantedFrames of the device ring, which may be less if it wraps
+static BufferContext beginMmap(uint wantedFrames)
+{
+	// also updates the ring pointers, which snd_pcm_mmap_begin() requires
+	snd_pcm_uframes_t frames = std::min(wantedFrames, (uint)framesFree());
+	if(!frames)
+		return {};
+	const snd_pcm_channel_area_t *areas;
+	if(int err = snd_pcm_mmap_begin(pcmHnd, &areas, &mmapOffset, &frames);
+		err < 0)
 	{
-		this->pcmHnd = pcmHnd;
-		snd_pcm_uframes_t wantedFrames = *frames;
-		if(snd_pcm_mmap_begin(pcmHnd, &areas, &offset, frames) != 0)
-		{
-			logErr("error in snd_pcm_mmap_begin");
-			return INVALID_PARAMETER;
-		}
-		if(*frames == 0)
+		logErr("error in snd_pcm_mmap_begin: %s", snd_strerror(err));
+		recoverPcm(err);
+		return {};
+	}
+	if(!frames)
+	{
+		snd_pcm_mmap_commit(pcmHnd, mmapOffset, 0);
+		return {};
+	}
+	// interleaved access uses a single area stepping one frame at a time
+	return {(char*)areas->addr + areas->first / 8 + mmapOffset * (areas->step / 8), frames};
+}
+
+static bool commitMmap(snd_pcm_uframes_t frames)
+{
+	auto ret = snd_pcm_mmap_commit(pcmHnd, mmapOffset, frames);
+	if(ret != (snd_pcm_sframes_t)frames)
+	{
+		if(ret < 0)
 		{
-			//logWarn("unexpected 0 samples returned for MMAP");
-			snd_pcm_mmap_commit(pcmHnd, offset, 0);
-			return INVALID_PARAMETER;
+			logWarn("error committing %d frames: %s", (int)frames, alsaPcmWriteErrorToString(ret));
+			recoverPcm(ret);
 		}
-
-		if(wantedFrames != *frames)
+		else
 		{
-			//logMsg("got %d frames out of %d from mmap", (int)*frames, (int)wantedFrames);
+			logWarn("only %ld of %d frames committed", ret, (int)frames);
+			updateRunningAfterWrite(ret);
 		}
-		data = (char*)areas->addr + offset * (areas->step / 8);
-		this->frames = *frames;
-
-		return OK;
+		return false;
 	}
+	updateRunningAfterWrite(frames);
+	return true;
+}
 
-	CallResult commitBytes(uint bytesWritten)
+BufferContext getPlayBuffer(uint wantedFrames)
+{
+	if(unlikely(!isOpen() || !useMmap))
+		return {};
+	auto buff = beginMmap(wantedFrames);
+	if(buff && buff.frames < wantedFrames)
 	{
-		return commit(pcmFormat.bytesToFrames(bytesWritten));
+		logDMsg("buffer has only %d/%d contiguous frames free", (int)buff.frames, wantedFrames);
 	}
+	return buff;
+}
 
-	CallResult commit(snd_pcm_uframes_t framesWritten)
-	{
-		auto ret = snd_pcm_mmap_commit(pcmHnd, offset, framesWritten);
-		if(ret < 0 || ret != (snd_pcm_sframes_t)framesWritten)
-		{
-			logMsg("error in snd_pcm_mmap_commit");
-			return INVALID_PARAMETER;
-		}
-		return OK;
-	}
-};
+void commitPlayBuffer(BufferContext buffer, uint frames)
+{
+	assert(frames <= buffer.frames);
+	commitMmap(frames);
+}
 
 void writePcm(const void *samples, uint framesToWrite)
 {
+	IG_TRACE_SPAN("Audio::writePcm");
 	if(unlikely(!isOpen()))
 		return;
-
 	auto framesFreeOnHW = framesFree();
-
-	// verify PCM state
-	switch((int)snd_pcm_state(pcmHnd))
-	{
-		bcase SND_PCM_STATE_XRUN:
-			snd_pcm_recover(pcmHnd, -EPIPE, 0);
-			framesFreeOnHW = framesFree();
-			logMsg("recovered from xrun, %d frames free", framesFreeOnHW);
-		bcase SND_PCM_STATE_PAUSED:
-			logMsg("unpausing PCM");
-			snd_pcm_pause(pcmHnd, 0);
-		bcase SND_PCM_STATE_SUSPENDED:
-			logMsg("resuming PCM");
-			snd_pcm_resume(pcmHnd);
-	}
-
-	//logMsg("writing %d frames, %d free", framesToWrite, framesFreeOnHW);
-
-	/*{
-		static uint framesToWriteAvg = 0, writeCount = 0;
-		framesToWriteAvg += framesToWrite;
-		writeCount++;
-		if(writeCount == 120)
-		{
-			logMsg("avg frames: %f, %d free", framesToWriteAvg / (double)120., framesFree());
-			framesToWriteAvg = 0;
-			writeCount = 0;
-		}
-	}*/
-
 	if(framesFreeOnHW < (int)framesToWrite)
 	{
 		logWarn("sending %d frames but only %d free", framesToWrite, framesFreeOnHW);
 		framesToWrite = framesFreeOnHW;
 	}
-	snd_pcm_sframes_t written;
 	if(useMmap)
 	{
-		written = snd_pcm_mmap_writei(pcmHnd, samples, framesToWrite);
-		/*AlsaMmapContext ctx;
-		//logMsg("starting mmap loop");
-		auto samplePtr = (char*)samples;
-		for(snd_pcm_uframes_t frames; framesToWrite; framesToWrite -= frames)
+		auto samplePtr = (const char*)samples;
+		// a write crossing the end of the device ring takes two transfers
+		while(framesToWrite)
 		{
-			frames = framesToWrite;
-			if(ctx.begin(pcmHnd, &frames) != OK)
+			auto buff = beginMmap(framesToWrite);
+			if(!buff)
 				return;
-			assert(frames <= framesToWrite);
-
-			memcpy(ctx.data, samples, pcmFormat.framesToBytes(frames));
-			samplePtr += pcmFormat.framesToBytes(frames);
-
-			if(ctx.commit(frames) != OK)
+			auto bytes = pcmFormat.framesToBytes(buff.frames);
+			memcpy(buff.data, samplePtr, bytes);
+			if(!commitMmap(buff.frames))
 				return;
-		}*/
+			samplePtr += bytes;
+			framesToWrite -= buff.frames;
+		}
 	}
 	else
 	{
-		written = snd_pcm_writei(pcmHnd, samples, framesToWrite);
-	}
-	if(written != (snd_pcm_sframes_t)framesToWrite)
-	{
-		if(written < 0)
+		auto written = snd_pcm_writei(pcmHnd, samples, framesToWrite);
+		if(written != (snd_pcm_sframes_t)framesToWrite)
 		{
-			logWarn("error writing %d frames: %s", framesToWrite, alsaPcmWriteErrorToString(written));
+			if(written < 0)
+			{
+				logWarn("error writing %d frames: %s", framesToWrite, alsaPcmWriteErrorToString(written));
+				recoverPcm(written);
+				return;
+			}
+			else
+				logWarn("only %ld of %d frames written", written, framesToWrite);
 		}
-		else
-			logWarn("only %ld of %d frames written", written, framesToWrite);
+		updateRunningAfterWrite(written);
 	}
 }
 
@@ -291,11 +315,19 @@ static int setupPcm(const PcmFormat &format, snd_pcm_access_t access)
 		logErr("Error getting pcm buffer/period size parameters");
 		return err;
 	}
-	else
+	snd_pcm_sw_params_t *swParams;
+	snd_pcm_sw_params_alloca(&swParams);
+	if((err = snd_pcm_sw_params_current(pcmHnd, swParams)) < 0 ||
+		(err = snd_pcm_sw_params_get_start_threshold(swParams, &startThreshold)) < 0)
 	{
-		logMsg("buffer size %u, period size %u, mmap %d", (uint)bufferSize, (uint)periodSize, useMmap);
-		return 0;
+		logErr("Error getting pcm start threshold");
+		return err;
 	}
+	isRunning = false;
+	lastFramesFree = bufferSize;
+	logMsg("buffer size %u, period size %u, start threshold %u, mmap %d",
+		(uint)bufferSize, (uint)periodSize, (uint)startThreshold, useMmap);
+	return 0;
 }
 
 static std::error_code openAlsaPcm(const PcmFormat &format)
@@ -359,6 +391,7 @@ static void closeAlsaPcm()
 		logDMsg("closing pcm");
 		snd_pcm_close(pcmHnd);
 		pcmHnd = nullptr;
+		isRunning = false;
 	}
 }
 
@@ -390,7 +423,7 @@ bool isOpen()
 
 bool isPlaying()
 {
-	return isOpen() && snd_pcm_state(pcmHnd) == SND_PCM_STATE_RUNNING;
+	return isOpen() && isRunning;
 }
 
 }
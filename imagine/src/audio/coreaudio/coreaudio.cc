@@ -16,7 +16,9 @@
 #define LOGTAG "CoreAudio"
 #include <imagine/audio/Audio.hh>
 #include <imagine/logger/logger.h>
+#include <imagine/logger/Trace.hh>
 #include <imagine/util/ringbuffer/MachRingBuffer.hh>
+#include <imagine/util/ringbuffer/PcmRingBuffer.hh>
 #include <imagine/util/utility.h>
 #include <imagine/util/algorithm.h>
 #include <AudioUnit/AudioUnit.h>
@@ -30,7 +32,7 @@ static uint wantedLatency = 100000;
 static AudioComponentInstance outputUnit{};
 static AudioStreamBasicDescription streamFormat;
 static bool isPlaying_ = false, isOpen_ = false, hadUnderrun = false;
-static StaticMachRingBuffer<> rBuff;
+static StaticPcmRingBuffer<MachMirroredMemory> rBuff;
 
 int maxRate()
 {
@@ -161,6 +163,9 @@ void closePcm()
 	}
 	AudioOutputUnitStop(outputUnit);
 	AudioUnitUninitialize(outputUnit);
+	auto stats = rBuff.stats();
+	logMsg("ring buffer fill min:%zu max:%zu of %zu bytes, %u short reads",
+		stats.minFill, stats.maxFill, rBuff.size(), stats.shortReads);
 	rBuff.deinit();
 	isPlaying_ = false;
 	isOpen_ = false;
@@ -219,6 +224,7 @@ void clearPcm()
 
 void writePcm(const void *samples, uint framesToWrite)
 {
+	IG_TRACE_SPAN("Audio::writePcm");
 	if(unlikely(!isOpen()))
 		return;
 
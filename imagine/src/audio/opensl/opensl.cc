@@ -16,13 +16,15 @@
 #define LOGTAG "OpenSL"
 #include <imagine/audio/Audio.hh>
 #include <imagine/logger/logger.h>
+#include <imagine/logger/Trace.hh>
 #include <imagine/util/algorithm.h>
 #include <imagine/util/math/int.hh>
 #include "../../base/android/android.hh"
 #include <SLES/OpenSLES.h>
 #include <SLES/OpenSLES_Android.h>
 #include <imagine/util/ringbuffer/LinuxRingBuffer.hh>
-using RingBufferType = StaticLinuxRingBuffer<>;
+#include <imagine/util/ringbuffer/PcmRingBuffer.hh>
+using RingBufferType = StaticPcmRingBuffer<LinuxMirroredMemory>;
 
 namespace Audio
 {
@@ -192,6 +194,9 @@ void closePcm()
 		slBuffQI = nullptr;
 		(*player)->Destroy(player);
 		player = nullptr;
+		auto stats = rBuff.stats();
+		logMsg("ring buffer fill min:%zu max:%zu of %zu bytes, %u short reads",
+			stats.minFill, stats.maxFill, rBuff.size(), stats.shortReads);
 		rBuff.deinit();
 		reachedEndOfPlayback = false;
 		unqueuedBytes = 0;
@@ -314,6 +319,7 @@ void commitPlayBuffer(BufferContext buffer, uint frames)
 
 void writePcm(const void *samples, uint framesToWrite)
 {
+	IG_TRACE_SPAN("Audio::writePcm");
 	if(unlikely(!isOpen()))
 		return;
 	uint bytes = pcmFormat.framesToBytes(framesToWrite);
@@ -8,6 +8,10 @@ ifeq ($(pulseAudioMainLoop), glib)
  include $(IMAGINE_PATH)/make/package/pulseaudio-glib.mk
 else
  include $(IMAGINE_PATH)/make/package/pulseaudio.mk
+ # the server pulls samples from a ring buffer on the main loop thread
+ ifeq ($(pulseAudioPullMode), 1)
+  configDefs += CONFIG_AUDIO_PULSEAUDIO_PULL
+ endif
 endif
 
 SRC += audio/pulseaudio/pulseaudio.cc
@@ -16,14 +16,21 @@
 #define LOGTAG "PulseAudio"
 #include <imagine/audio/Audio.hh>
 #include <imagine/logger/logger.h>
+#include <imagine/logger/Trace.hh>
 #include <imagine/base/Base.hh>
 #include <imagine/util/ScopeGuard.hh>
 #include <pulse/pulseaudio.h>
+#include <algorithm>
+#include <cstring>
 #ifdef CONFIG_AUDIO_PULSEAUDIO_GLIB
 #include <pulse/glib-mainloop.h>
 #else
 #include <pulse/thread-mainloop.h>
 #endif
+#ifdef CONFIG_AUDIO_PULSEAUDIO_PULL
+#include <imagine/util/ringbuffer/LinuxRingBuffer.hh>
+#include <imagine/util/ringbuffer/PcmRingBuffer.hh>
+#endif
 
 namespace Audio
 {
@@ -33,6 +40,17 @@ static uint wantedLatency = 100000;
 static pa_context* context{};
 static pa_stream* stream{};
 static bool isCorked = true;
+// buffer sizing driven by the measured stream latency
+static uint requestedTLength = 0;
+static double avgLatencyUSecs = 0;
+static uint writesSinceLatencyCheck = 0;
+static bool underflowed = false;
+static constexpr uint LATENCY_CHECK_WRITES = 60;
+#ifdef CONFIG_AUDIO_PULSEAUDIO_PULL
+// the server pulls from this ring in its write callback, so writing
+// samples never has to lock the main loop
+static StaticPcmRingBuffer<LinuxMirroredMemory> rBuff{};
+#endif
 
 #ifdef CONFIG_AUDIO_PULSEAUDIO_GLIB
 static pa_glib_mainloop* mainloop{};
@@ -145,9 +163,44 @@ static pa_sample_format_t pcmFormatToPA(const SampleFormat &format)
 	}
 }
 
+static pa_buffer_attr makeBufferAttr(uint tlength)
+{
+	pa_buffer_attr attr{};
+	attr.maxlength = -1;
+	attr.tlength = tlength;
+	attr.prebuf = -1;
+	// have the server ask for data in quarter buffer steps so the fill stays near tlength
+	attr.minreq = tlength / 4;
+	attr.fragsize = -1;
+	return attr;
+}
+
+// call with main loop locked
+static void setTLength(uint tlength)
+{
+	tlength = std::max(tlength, pcmFormat.uSecsToBytes(5000));
+	if(tlength == requestedTLength)
+		return;
+	logMsg("requesting target fill bytes: %u (was %u)", tlength, requestedTLength);
+	requestedTLength = tlength;
+	auto attr = makeBufferAttr(tlength);
+	if(auto op = pa_stream_set_buffer_attr(stream, &attr, nullptr, nullptr);
+		op)
+	{
+		pa_operation_unref(op);
+	}
+}
+
 void setHintOutputLatency(uint us)
 {
 	wantedLatency = us;
+	if(isOpen())
+	{
+		lockMainLoop();
+		avgLatencyUSecs = 0;
+		setTLength(pcmFormat.uSecsToBytes(us));
+		unlockMainLoop();
+	}
 }
 
 uint hintOutputLatency()
@@ -155,6 +208,48 @@ uint hintOutputLatency()
 	return wantedLatency;
 }
 
+// call with main loop locked
+static bool streamLatency(pa_usec_t &latency)
+{
+	int negative = 0;
+	if(pa_stream_get_latency(stream, &latency, &negative) < 0)
+	{
+		// no timing info received yet
+		return false;
+	}
+	if(negative)
+		latency = 0;
+	return true;
+}
+
+// call with main loop locked, shrinks the requested buffer when the server
+// adds latency on top of it and grows it back after an underflow
+static void updateLatency()
+{
+	if(underflowed)
+	{
+		underflowed = false;
+		avgLatencyUSecs = 0;
+		writesSinceLatencyCheck = 0;
+		uint maxTLength = pcmFormat.uSecsToBytes(wantedLatency) * 2;
+		logMsg("underflow, growing buffer");
+		setTLength(std::min(requestedTLength + requestedTLength / 4, maxTLength));
+		return;
+	}
+	pa_usec_t latency;
+	if(!streamLatency(latency))
+		return;
+	avgLatencyUSecs = avgLatencyUSecs ? avgLatencyUSecs * .9 + latency * .1 : latency;
+	if(++writesSinceLatencyCheck < LATENCY_CHECK_WRITES)
+		return;
+	writesSinceLatencyCheck = 0;
+	if(avgLatencyUSecs > wantedLatency * 1.25)
+	{
+		// scale the request by how far off the measured latency is
+		setTLength(requestedTLength * (wantedLatency / avgLatencyUSecs));
+	}
+}
+
 int frameDelay()
 {
 	if(unlikely(!isOpen()))
@@ -162,26 +257,28 @@ int frameDelay()
 	pa_usec_t delay;
 	iterateMainLoop();
 	lockMainLoop();
-	int err = pa_stream_get_latency(stream, &delay, nullptr);
+	bool hasLatency = streamLatency(delay);
 	unlockMainLoop();
-	if(err)
-	{
-		// TODO: check exact error like PA_ERR_NODATA
-		logErr("error getting stream latency");
-		return 0;
-	}
-	return pcmFormat.uSecsToFrames(delay);
+	int frames = hasLatency ? pcmFormat.uSecsToFrames(delay) : 0;
+	#ifdef CONFIG_AUDIO_PULSEAUDIO_PULL
+	frames += pcmFormat.bytesToFrames(rBuff.writtenSize());
+	#endif
+	return frames;
 }
 
 int framesFree()
 {
 	if(unlikely(!isOpen()))
 		return 0;
+	#ifdef CONFIG_AUDIO_PULSEAUDIO_PULL
+	return pcmFormat.bytesToFrames(rBuff.freeSpace());
+	#else
 	iterateMainLoop();
 	lockMainLoop();
 	auto bytes = pa_stream_writable_size(stream);
 	unlockMainLoop();
 	return pcmFormat.bytesToFrames(bytes);
+	#endif
 }
 
 void pausePcm()
@@ -214,44 +311,140 @@ void clearPcm()
 	logMsg("clearing queued samples");
 	lockMainLoop();
 	pa_stream_flush(stream, nullptr, nullptr);
+	#ifdef CONFIG_AUDIO_PULSEAUDIO_PULL
+	// the write callback can't run while the main loop is locked
+	rBuff.reset();
+	#endif
 	unlockMainLoop();
 	iterateMainLoop();
 }
 
-void writePcm(const void *samples, uint framesToWrite)
+// call with main loop locked, returns a buffer owned by the server
+static BufferContext beginWrite(size_t wantedBytes)
 {
-	if(unlikely(!isOpen()))
+	auto bytes = std::min(wantedBytes, pa_stream_writable_size(stream));
+	if(!bytes)
+		return {};
+	void *data;
+	if(pa_stream_begin_write(stream, &data, &bytes) < 0 || !data)
+	{
+		logErr("error in pa_stream_begin_write");
+		return {};
+	}
+	return {data, (uframes)pcmFormat.bytesToFrames(bytes)};
+}
+
+// call with main loop locked
+static void commitWrite(BufferContext buffer, uint frames)
+{
+	if(!frames)
+	{
+		pa_stream_cancel_write(stream);
 		return;
+	}
+	auto bytes = pcmFormat.framesToBytes(frames);
+	if(pa_stream_write(stream, buffer.data, bytes, nullptr, 0, PA_SEEK_RELATIVE) < 0)
+	{
+		logWarn("error writing %d bytes", (int)bytes);
+	}
+}
 
-	iterateMainLoop();
-	lockMainLoop(); // TODO: locking here is sub-optimal, writes should be async using a ring-buffer
-	auto bytesFreeOnHW = pa_stream_writable_size(stream);
-	auto framesFreeOnHW = pcmFormat.bytesToFrames(bytesFreeOnHW);
-	auto bytesToWrite = pcmFormat.framesToBytes(framesToWrite);
-	//logMsg("writing %d frames, %d free", framesToWrite, framesFreeOnHW);
-	/*{
-		static uint framesToWriteAvg = 0, writeCount = 0;
-		framesToWriteAvg += framesToWrite;
-		writeCount++;
-		if(writeCount == 120)
+#ifdef CONFIG_AUDIO_PULSEAUDIO_PULL
+// runs on the main loop, fills the server's request from the ring
+static void pullCallback(pa_stream *, size_t bytes, void *)
+{
+	while(bytes)
+	{
+		auto buff = beginWrite(bytes);
+		if(!buff)
+			return;
+		auto buffBytes = pcmFormat.framesToBytes(buff.frames);
+		auto read = rBuff.read(buff.data, buffBytes);
+		if(read != buffBytes)
 		{
-			logMsg("avg frames: %f, %d free", framesToWriteAvg / (double)120., framesFree());
-			framesToWriteAvg = 0;
-			writeCount = 0;
+			// keep the stream running with silence like a callback based device would
+			memset((char*)buff.data + read, pcmFormat.sample.isSigned ? 0 : 0x80, buffBytes - read);
 		}
-	}*/
+		commitWrite(buff, buff.frames);
+		bytes -= std::min(bytes, (size_t)buffBytes);
+	}
+}
+#endif
+
+BufferContext getPlayBuffer(uint wantedFrames)
+{
+	if(unlikely(!isOpen()))
+		return {};
+	#ifdef CONFIG_AUDIO_PULSEAUDIO_PULL
+	auto frames = std::min(wantedFrames, pcmFormat.bytesToFrames(rBuff.freeContiguousSpace()));
+	if(!frames)
+		return {};
+	return {rBuff.writeAddr(), frames};
+	#else
+	iterateMainLoop();
+	lockMainLoop();
+	auto buff = beginWrite(pcmFormat.framesToBytes(wantedFrames));
+	unlockMainLoop();
+	if(buff && buff.frames < wantedFrames)
+	{
+		logDMsg("buffer has only %d/%d frames free", (int)buff.frames, wantedFrames);
+	}
+	return buff;
+	#endif
+}
+
+void commitPlayBuffer(BufferContext buffer, uint frames)
+{
+	assert(frames <= buffer.frames);
+	#ifdef CONFIG_AUDIO_PULSEAUDIO_PULL
+	rBuff.commitWrite(pcmFormat.framesToBytes(frames));
+	#else
+	lockMainLoop();
+	commitWrite(buffer, frames);
+	updateLatency();
+	unlockMainLoop();
+	iterateMainLoop();
+	#endif
+}
+
+void writePcm(const void *samples, uint framesToWrite)
+{
+	IG_TRACE_SPAN("Audio::writePcm");
+	if(unlikely(!isOpen()))
+		return;
+	#ifdef CONFIG_AUDIO_PULSEAUDIO_PULL
+	auto bytes = pcmFormat.framesToBytes(framesToWrite);
+	if(auto written = rBuff.write(samples, bytes);
+		written != bytes)
+	{
+		logWarn("sending %d frames but only %d free", framesToWrite, pcmFormat.bytesToFrames(written));
+	}
+	#else
+	iterateMainLoop();
+	lockMainLoop();
+	auto framesFreeOnHW = pcmFormat.bytesToFrames(pa_stream_writable_size(stream));
 	if(framesFreeOnHW < framesToWrite)
 	{
 		logWarn("sending %d frames but only %d free", framesToWrite, framesFreeOnHW);
-		bytesToWrite = bytesFreeOnHW;
+		framesToWrite = framesFreeOnHW;
 	}
-	int err = pa_stream_write(stream, samples, bytesToWrite, nullptr, 0, PA_SEEK_RELATIVE);
-	unlockMainLoop();
-	if(err < 0)
+	auto samplePtr = (const char*)samples;
+	// the server may hand out less memory than asked for in one go
+	while(framesToWrite)
 	{
-		logWarn("error writing %d bytes", bytesToWrite);
+		auto buff = beginWrite(pcmFormat.framesToBytes(framesToWrite));
+		if(!buff)
+			break;
+		auto bytes = pcmFormat.framesToBytes(buff.frames);
+		memcpy(buff.data, samplePtr, bytes);
+		commitWrite(buff, buff.frames);
+		samplePtr += bytes;
+		framesToWrite -= buff.frames;
 	}
+	updateLatency();
+	unlockMainLoop();
 	iterateMainLoop();
+	#endif
 }
 
 static std::error_code init()
@@ -358,13 +551,25 @@ std::error_code openPcm(const PcmFormat &format)
 				break;
 			}
 		}, &finalState);
-	pa_buffer_attr bufferAttr {0};
-	bufferAttr.maxlength = -1;
-	bufferAttr.tlength = format.uSecsToBytes(wantedLatency);
-	bufferAttr.prebuf = -1;
-	bufferAttr.minreq = -1;
+	requestedTLength = format.uSecsToBytes(wantedLatency);
+	avgLatencyUSecs = 0;
+	writesSinceLatencyCheck = 0;
+	underflowed = false;
+	#ifdef CONFIG_AUDIO_PULSEAUDIO_PULL
+	// the ring holds most of the wanted latency, the server only keeps enough to ride out scheduling
+	rBuff.init(requestedTLength);
+	requestedTLength /= 4;
+	pa_stream_set_write_callback(stream, pullCallback, nullptr);
+	#endif
+	auto bufferAttr = makeBufferAttr(requestedTLength);
+	pa_stream_set_underflow_callback(stream,
+		[](pa_stream *, void *)
+		{
+			underflowed = true;
+		}, nullptr);
+	// timing updates let pa_stream_get_latency() answer without a server round trip
 	if(pa_stream_connect_playback(stream, nullptr, &bufferAttr,
-		pa_stream_flags_t(PA_STREAM_ADJUST_LATENCY /*| PA_STREAM_AUTO_TIMING_UPDATE | PA_STREAM_INTERPOLATE_TIMING*/),
+		pa_stream_flags_t(PA_STREAM_ADJUST_LATENCY | PA_STREAM_AUTO_TIMING_UPDATE | PA_STREAM_INTERPOLATE_TIMING),
 		nullptr, nullptr) < 0)
 	{
 		logErr("error connecting playback stream");
@@ -383,7 +588,7 @@ std::error_code openPcm(const PcmFormat &format)
 	unlockMainLoop();
 	assert(serverAttr);
 	isCorked = false;
-	logMsg("opened stream with target fill bytes: %d", serverAttr->tlength);
+	logMsg("opened stream with target fill bytes: %d, request bytes: %d", serverAttr->tlength, serverAttr->minreq);
 	return {};
 }
 
@@ -401,6 +606,12 @@ void closePcm()
 	iterateMainLoop();
 	isCorked = true;
 	stream = nullptr;
+	#ifdef CONFIG_AUDIO_PULSEAUDIO_PULL
+	auto stats = rBuff.stats();
+	logMsg("ring buffer fill min:%zu max:%zu of %zu bytes, %u short reads",
+		stats.minFill, stats.maxFill, rBuff.size(), stats.shortReads);
+	rBuff.deinit();
+	#endif
 }
 
 bool isOpen()
@@ -1,3 +1,5 @@
+SRC += audio/Resampler.cc
+
 ifdef config_audioModule
  ifneq ($(config_audioModule), none)
   include $(imagineSrcDir)/audio/$(config_audioModule)/build.mk
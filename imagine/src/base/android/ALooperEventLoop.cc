@@ -15,12 +15,14 @@
 
 #include <imagine/base/EventLoop.hh>
 #include <imagine/logger/logger.h>
+#include <imagine/logger/Trace.hh>
 
 namespace Base
 {
 
 static int pollEventCallback(int fd, int events, void *data)
 {
+	IG_TRACE_SPAN("EventLoop::dispatchFD");
 	auto &callback = *((PollEventDelegate*)data);
 	callback(fd, events);
 	return 1;
@@ -16,6 +16,7 @@
 #define LOGTAG "Screen"
 #include <imagine/base/Base.hh>
 #include <imagine/logger/logger.h>
+#include <imagine/logger/Trace.hh>
 #include <imagine/time/Time.hh>
 #include <imagine/util/utility.h>
 #include <imagine/util/algorithm.h>
@@ -107,6 +108,7 @@ bool Screen::isPosted()
 
 void Screen::frameUpdate(FrameTimeBase timestamp)
 {
+	IG_TRACE_SPAN("Screen::frameUpdate");
 	assert(timestamp);
 	assert(isActive);
 	framePosted = false;
@@ -16,6 +16,7 @@
 #define LOGTAG "Window"
 #include <imagine/base/Base.hh>
 #include <imagine/logger/logger.h>
+#include <imagine/logger/Trace.hh>
 #include "windowPrivate.hh"
 #include <imagine/input/Input.hh>
 
@@ -212,6 +213,7 @@ void Window::dispatchOnDraw()
 {
 	if(!needsDraw())
 		return;
+	IG_TRACE_SPAN("Window::draw");
 	setNeedsDraw(false);
 	DrawParams params;
 	if(unlikely(surfaceChange.flags))
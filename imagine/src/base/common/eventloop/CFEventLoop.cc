@@ -15,6 +15,7 @@
 
 #include <imagine/base/EventLoop.hh>
 #include <imagine/logger/logger.h>
+#include <imagine/logger/Trace.hh>
 
 namespace Base
 {
@@ -27,6 +28,7 @@ CFFDEventSource::CFFDEventSource(int fd)
 		[](CFFileDescriptorRef fdRef, CFOptionFlags callbackEventTypes, void *info_)
 		{
 			//logMsg("got fd events: 0x%X", (int)callbackEventTypes);
+			IG_TRACE_SPAN("EventLoop::dispatchFD");
 			auto &info = *((CFFDEventSourceInfo*)info_);
 			auto fd = CFFileDescriptorGetNativeDescriptor(fdRef);
 			info.callback(fd, callbackEventTypes);
@@ -17,6 +17,7 @@
 #include <imagine/base/Base.hh>
 #include <imagine/base/EventLoop.hh>
 #include <imagine/logger/logger.h>
+#include <imagine/logger/Trace.hh>
 #include <imagine/util/string.h>
 #include <imagine/util/ScopeGuard.hh>
 #include <glib-unix.h>
@@ -77,6 +78,7 @@ bool FDEventSource::addToEventLoop(EventLoop loop, PollEventDelegate callback, u
 		nullptr,
 		[](GSource *source, GSourceFunc, gpointer userData)
 		{
+			IG_TRACE_SPAN("EventLoop::dispatchFD");
 			auto s = (GSource2*)source;
 			auto pollFD = (GPollFD*)userData;
 			//logMsg("events for source:%p", source);
@@ -105,6 +107,7 @@ void FDEventSource::addXServerToEventLoop(EventLoop loop)
 		[](GSource *, GSourceFunc, gpointer)
 		{
 			//logMsg("events for X fd");
+			IG_TRACE_SPAN("EventLoop::dispatchX11");
 			x11FDHandler();
 			return (gboolean)TRUE;
 		},
@@ -38,6 +38,18 @@ bool DRMFrameTimer::init(EventLoop loop)
 		logErr("error creating frame timer, DRM/DRI access is required");
 		return false;
 	}
+	{
+		// virtual GPUs may open fine but have no CRTC to deliver vblank events
+		drmVBlank vbl{};
+		vbl.request.type = DRM_VBLANK_RELATIVE;
+		if(drmWaitVBlank(fd, &vbl))
+		{
+			logErr("error creating frame timer, DRM device has no vblank source");
+			close(fd);
+			fd = -1;
+			return false;
+		}
+	}
 	fdSrc = {fd, loop,
 		[this](int fd, int event)
 		{
@@ -0,0 +1,122 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "FrameTimer"
+#include <imagine/base/Screen.hh>
+#include <imagine/time/Time.hh>
+#include <imagine/logger/logger.h>
+#include "SimulatedFrameTimer.hh"
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace Base
+{
+
+bool SimulatedFrameTimer::init(EventLoop loop, double rate)
+{
+	if(fd >= 0)
+		return true;
+	if(rate <= 0)
+		rate = 60.;
+	fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if(fd == -1)
+	{
+		logErr("error creating timerfd: %s", strerror(errno));
+		return false;
+	}
+	periodNSecs = 1000000000. / rate;
+	baseTime = IG::Time::now().nSecs();
+	requested = false;
+	logMsg("using simulated vsync at %.2fHz", rate);
+	fdSrc = {fd, loop,
+		[this](int fd, int event)
+		{
+			uint64_t expirations;
+			if(read(fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+				return 1; // disarmed by cancel() after the fd became ready
+			requested = false;
+			// report the deadline, not the wake-up time, and drop any frames missed
+			auto timestamp = gridTime(frameIndex(IG::Time::now().nSecs()));
+			iterateTimes(Screen::screens(), i)
+			{
+				auto s = Screen::screen(i);
+				if(s->isPosted())
+				{
+					s->frameUpdate(timestamp);
+					s->prevFrameTimestamp = timestamp;
+				}
+			}
+			return 1;
+		}};
+	return true;
+}
+
+void SimulatedFrameTimer::deinit()
+{
+	if(fd < 0)
+		return;
+	fdSrc.removeFromEventLoop();
+	close(fd);
+	fd = -1;
+	requested = false;
+}
+
+void SimulatedFrameTimer::scheduleVSync()
+{
+	assert(fd != -1);
+	if(requested)
+		return;
+	requested = true;
+	auto nextTime = gridTime(frameIndex(IG::Time::now().nSecs()) + 1);
+	struct itimerspec newTime{};
+	newTime.it_value.tv_sec = nextTime / 1000000000;
+	newTime.it_value.tv_nsec = nextTime % 1000000000;
+	if(timerfd_settime(fd, TFD_TIMER_ABSTIME, &newTime, nullptr) != 0)
+	{
+		logErr("error in timerfd_settime: %s", strerror(errno));
+		requested = false;
+	}
+}
+
+void SimulatedFrameTimer::cancel()
+{
+	if(!requested)
+		return;
+	requested = false;
+	struct itimerspec disarm{};
+	timerfd_settime(fd, 0, &disarm, nullptr);
+}
+
+uint64_t SimulatedFrameTimer::gridTime(uint64_t frames) const
+{
+	// computed from the base each time so rounding never accumulates
+	return baseTime + (uint64_t)(frames * periodNSecs);
+}
+
+uint64_t SimulatedFrameTimer::frameIndex(uint64_t now) const
+{
+	// index of the last grid point at or before now
+	if(now <= baseTime)
+		return 0;
+	auto frames = (uint64_t)((now - baseTime) / periodNSecs);
+	// guard against the division rounding up past now
+	while(frames && gridTime(frames) > now)
+		frames--;
+	return frames;
+}
+
+}
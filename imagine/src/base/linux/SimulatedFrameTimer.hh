@@ -0,0 +1,53 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/base/EventLoop.hh>
+#include <cstdint>
+
+namespace Base
+{
+
+// Frame timer for hosts without a vblank source (VMs, containers, Xvfb).
+// A timerfd is armed on absolute deadlines along a fixed grid of
+// base + n * period, so timestamps never accumulate wake-up latency and a
+// late wake-up reports the most recent grid point it passed.
+class SimulatedFrameTimer
+{
+private:
+	Base::FDEventSource fdSrc;
+	int fd = -1;
+	bool requested = false;
+	uint64_t baseTime = 0; // nanoseconds, CLOCK_MONOTONIC like IG::Time
+	double periodNSecs = 0;
+
+	uint64_t gridTime(uint64_t frames) const;
+	uint64_t frameIndex(uint64_t now) const;
+
+public:
+	constexpr SimulatedFrameTimer() {}
+	bool init(EventLoop loop, double rate);
+	void deinit();
+	void scheduleVSync();
+	void cancel();
+
+	explicit operator bool() const
+	{
+		return fd >= 0;
+	}
+};
+
+}
@@ -8,6 +8,7 @@ LDLIBS += -lpthread
 
 SRC += base/linux/linux.cc \
  base/linux/DRMFrameTimer.cc \
+ base/linux/SimulatedFrameTimer.cc \
  base/common/timer/TimerFD.cc \
  base/common/PosixPipe.cc \
  util/string/glibc.c
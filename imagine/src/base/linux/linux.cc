@@ -206,6 +206,13 @@ void exitWithErrorMessageVPrintf(int exitVal, const char *format, va_list args)
 
 }
 
+// "--headless" as the first argument skips window system & input setup
+// so the app can run on hosts without a display server
+static bool isHeadlessLaunch(int argc, char** argv)
+{
+	return argc > 1 && string_equal(argv[1], "--headless");
+}
+
 int main(int argc, char** argv)
 {
 	using namespace Base;
@@ -213,13 +220,15 @@ int main(int argc, char** argv)
 	engineInit();
 	appPath = FS::makeAppPathFromLaunchCommand(argv[0]);
 	auto eventLoop = EventLoop::makeForThread();
+	bool headless = isHeadlessLaunch(argc, argv);
 	#ifdef CONFIG_BASE_X11
 	FDEventSource x11Src;
-	if(initWindowSystem(eventLoop, x11Src) != OK)
+	if(!headless && initWindowSystem(eventLoop, x11Src) != OK)
 		return -1;
 	#endif
 	#ifdef CONFIG_INPUT_EVDEV
-	Input::initEvdev(eventLoop);
+	if(!headless)
+		Input::initEvdev(eventLoop);
 	#endif
 	onInit(argc, argv);
 	eventLoop.run();
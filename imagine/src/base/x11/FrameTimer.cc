@@ -22,11 +22,14 @@
 #include <imagine/thread/Thread.hh>
 #include <imagine/logger/logger.h>
 #include <imagine/util/algorithm.h>
+#include <imagine/util/string.h>
 #include <sys/eventfd.h>
 #include <sys/timerfd.h>
 #include <semaphore.h>
+#include <cstring>
 #include "internal.hh"
 #include "../linux/DRMFrameTimer.hh"
+#include "../linux/SimulatedFrameTimer.hh"
 
 // for fbdev vsync
 #include <unistd.h>
@@ -94,12 +97,36 @@ static DRMFrameTimer frameTimer{};
 #else
 static SGIFrameTimer frameTimer{};
 #endif
+static SimulatedFrameTimer simulatedFrameTimer{};
+static bool useSimulatedFrameTimer = false;
+
+static double simulatedFrameRate()
+{
+	if(const char *rateStr = getenv("IMAGINE_FRAME_RATE");
+		rateStr)
+	{
+		auto rate = strtod(rateStr, nullptr);
+		if(rate > 0)
+			return rate;
+		logWarn("ignoring invalid IMAGINE_FRAME_RATE:%s", rateStr);
+	}
+	return mainScreen().frameRate();
+}
 
 void initFrameTimer(EventLoop loop)
 {
-	if(frameTimer)
+	if(frameTimer || simulatedFrameTimer)
 		return;
-	if(!frameTimer.init(loop))
+	// IMAGINE_FRAME_TIMER=simulated skips the hardware timer, otherwise
+	// it's only used when no vblank source is available
+	const char *timerType = getenv("IMAGINE_FRAME_TIMER");
+	useSimulatedFrameTimer = timerType && string_equal(timerType, "simulated");
+	if(!useSimulatedFrameTimer && !frameTimer.init(loop))
+	{
+		logWarn("no vblank source, falling back to simulated vsync");
+		useSimulatedFrameTimer = true;
+	}
+	if(useSimulatedFrameTimer && !simulatedFrameTimer.init(loop, simulatedFrameRate()))
 	{
 		exit(1);
 	}
@@ -108,17 +135,28 @@ void initFrameTimer(EventLoop loop)
 void deinitFrameTimer()
 {
 	frameTimer.deinit();
+	simulatedFrameTimer.deinit();
 }
 
 void frameTimerScheduleVSync()
 {
-	if(frameTimer)
+	if(useSimulatedFrameTimer)
+	{
+		if(simulatedFrameTimer)
+			simulatedFrameTimer.scheduleVSync();
+	}
+	else if(frameTimer)
 		frameTimer.scheduleVSync();
 }
 
 void frameTimerCancel()
 {
-	if(frameTimer)
+	if(useSimulatedFrameTimer)
+	{
+		if(simulatedFrameTimer)
+			simulatedFrameTimer.cancel();
+	}
+	else if(frameTimer)
 		frameTimer.cancel();
 }
 
@@ -208,7 +246,10 @@ bool SGIFrameTimer::init(EventLoop loop)
 {
 	if(fd >= 0)
 		return true;
-	if(!glXGetProcAddress((const GLubyte*)"glXWaitVideoSyncSGI"))
+	// glXGetProcAddress() returns non-null for any name, so check the extension string too
+	auto glxExtensions = glXQueryExtensionsString(dpy, DefaultScreen(dpy));
+	if(!glxExtensions || !strstr(glxExtensions, "GLX_SGI_video_sync") ||
+		!glXGetProcAddress((const GLubyte*)"glXWaitVideoSyncSGI"))
 	{
 		logErr("error creating frame timer, GLX_SGI_video_sync extension is required");
 		return false;
@@ -31,28 +31,34 @@ void XScreen::init(::Screen *xScreen)
 	yMM = HeightMMOfScreen(xScreen);
 	auto screenRes = XRRGetScreenResourcesCurrent(DisplayOfScreen(xScreen), RootWindowOfScreen(xScreen));
 	auto primaryOutput = XRRGetOutputPrimary(DisplayOfScreen(xScreen), RootWindowOfScreen(xScreen));
-	auto outputInfo = XRRGetOutputInfo(DisplayOfScreen(xScreen), screenRes, primaryOutput);
-	auto crtcInfo = XRRGetCrtcInfo(DisplayOfScreen(xScreen), screenRes, outputInfo->crtc);
-	iterateTimes(screenRes->nmode, i)
+	auto outputInfo = primaryOutput ? XRRGetOutputInfo(DisplayOfScreen(xScreen), screenRes, primaryOutput) : nullptr;
+	auto crtcInfo = outputInfo && outputInfo->crtc ? XRRGetCrtcInfo(DisplayOfScreen(xScreen), screenRes, outputInfo->crtc) : nullptr;
+	if(crtcInfo)
 	{
-		auto &modeInfo = screenRes->modes[i];
-		if(modeInfo.id == crtcInfo->mode)
+		iterateTimes(screenRes->nmode, i)
 		{
-			if(modeInfo.hTotal && modeInfo.vTotal)
+			auto &modeInfo = screenRes->modes[i];
+			if(modeInfo.id == crtcInfo->mode)
 			{
-				frameTime_ = ((double)modeInfo.hTotal * (double)modeInfo.vTotal) / (double)modeInfo.dotClock;
+				if(modeInfo.hTotal && modeInfo.vTotal)
+				{
+					frameTime_ = ((double)modeInfo.hTotal * (double)modeInfo.vTotal) / (double)modeInfo.dotClock;
+				}
+				break;
 			}
-			else
-			{
-				logWarn("unknown display time");
-				frameTime_ = 1. / 60.;
-				reliableFrameTime = false;
-			}
-			break;
 		}
 	}
-	XRRFreeCrtcInfo(crtcInfo);
-	XRRFreeOutputInfo(outputInfo);
+	if(!frameTime_)
+	{
+		// also the case on virtual servers like Xvfb with no active output
+		logWarn("unknown display time");
+		frameTime_ = 1. / 60.;
+		reliableFrameTime = false;
+	}
+	if(crtcInfo)
+		XRRFreeCrtcInfo(crtcInfo);
+	if(outputInfo)
+		XRRFreeOutputInfo(outputInfo);
 	XRRFreeScreenResources(screenRes);
 	assert(frameTime_);
 	logMsg("X screen: 0x%p %dx%d (%dx%dmm) %.2fHz", xScreen,
@@ -238,20 +238,16 @@ void ArchiveIterator::rewind()
 	init(std::move(io), dummy);
 }
 
-ArchiveIO fileFromArchive(const char *archivePath, const char *filePath)
-{
-	for(auto &entry : FS::ArchiveIterator{archivePath})
-	{
-		if(entry.type() == FS::file_type::directory)
-		{
-			continue;
-		}
-		if(string_equal(entry.name(), filePath))
-		{
-			return entry.moveIO();
-		}
-	}
-	return {};
+GenericIO fileFromArchive(const char *archivePath, const char *filePath)
+{
+	std::error_code ec{};
+	auto index = ArchiveIndex::open(archivePath, ec);
+	if(!index)
+		return {};
+	auto entry = index->find(filePath);
+	if(!entry)
+		return {};
+	return index->openEntry(*entry);
 }
 
 }
@@ -2,9 +2,11 @@ ifndef inc_fs_archive
 inc_fs_archive := 1
 
 include $(IMAGINE_PATH)/src/io/ArchiveIO.mk
+include $(IMAGINE_PATH)/make/package/zlib.mk
 
 configDefs += CONFIG_FS_ARCHIVE
 
-SRC += fs/ArchiveFS.cc
+SRC += fs/ArchiveFS.cc \
+fs/ArchiveIndex.cc
 
 endif
@@ -0,0 +1,629 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "ArchIndex"
+#include <imagine/fs/ArchiveFS.hh>
+#include <imagine/fs/FS.hh>
+#include <imagine/io/BufferMapIO.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/string.h>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <zlib.h>
+
+namespace FS
+{
+
+static constexpr uint MAX_CACHED_INDEXES = 4;
+static constexpr uint32 ZIP_EOCD_SIG = 0x06054b50;
+static constexpr uint32 ZIP64_EOCD_LOCATOR_SIG = 0x07064b50;
+static constexpr uint32 ZIP64_EOCD_SIG = 0x06064b50;
+static constexpr uint32 ZIP_CENTRAL_HEADER_SIG = 0x02014b50;
+static constexpr uint32 ZIP_LOCAL_HEADER_SIG = 0x04034b50;
+static constexpr uint16 ZIP_STORED = 0;
+static constexpr uint16 ZIP_DEFLATED = 8;
+
+static std::atomic<size_t> blockCacheLimit_{16 * 1024 * 1024};
+static std::mutex cacheMutex{};
+// most recently used first
+static std::vector<std::shared_ptr<ArchiveIndex>> cache{};
+
+// Decompressed blocks of every open deflated entry share one LRU list so the
+// limit bounds their total however many entries are open. Blocks are handed
+// out by shared_ptr so eviction by another entry can't free one mid-copy.
+using BlockData = std::shared_ptr<std::vector<uint8>>;
+
+struct CachedBlock
+{
+	const void *owner;
+	uint32 point;
+	BlockData data;
+};
+
+static std::mutex blockCacheMutex{};
+static std::list<CachedBlock> blockCache{}; // most recently used first
+static size_t blockCacheBytes = 0;
+
+static BlockData findCachedBlock(const void *owner, uint32 point)
+{
+	std::lock_guard<std::mutex> lock{blockCacheMutex};
+	for(auto it = blockCache.begin(); it != blockCache.end(); ++it)
+	{
+		if(it->owner == owner && it->point == point)
+		{
+			blockCache.splice(blockCache.begin(), blockCache, it);
+			return it->data;
+		}
+	}
+	return {};
+}
+
+// evicts blocks until bytes more fit under the limit, reusing the memory of
+// the last evicted block if no reader still holds it
+static std::vector<uint8> takeBlockCacheSpace(size_t bytes)
+{
+	std::vector<uint8> reuse{};
+	std::lock_guard<std::mutex> lock{blockCacheMutex};
+	while(blockCache.size() && blockCacheBytes + bytes > ArchiveIndex::blockCacheLimit())
+	{
+		auto &block = blockCache.back();
+		blockCacheBytes -= block.data->capacity();
+		if(block.data.use_count() == 1)
+			reuse = std::move(*block.data);
+		blockCache.pop_back();
+	}
+	reuse.clear();
+	return reuse;
+}
+
+static BlockData addCachedBlock(const void *owner, uint32 point, std::vector<uint8> data)
+{
+	auto block = std::make_shared<std::vector<uint8>>(std::move(data));
+	std::lock_guard<std::mutex> lock{blockCacheMutex};
+	blockCacheBytes += block->capacity();
+	blockCache.emplace_front(CachedBlock{owner, point, block});
+	return block;
+}
+
+static void dropCachedBlocks(const void *owner)
+{
+	std::lock_guard<std::mutex> lock{blockCacheMutex};
+	for(auto it = blockCache.begin(); it != blockCache.end();)
+	{
+		if(it->owner == owner)
+		{
+			blockCacheBytes -= it->data->capacity();
+			it = blockCache.erase(it);
+		}
+		else
+			++it;
+	}
+}
+
+static uint16 readLE16(const uint8 *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static uint32 readLE32(const uint8 *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32)p[3] << 24);
+}
+
+static uint64_t readLE64(const uint8 *p)
+{
+	return readLE32(p) | ((uint64_t)readLE32(p + 4) << 32);
+}
+
+// Inflates a deflated ZIP entry straight out of the mapped archive. The
+// output is split into blocks of at least one span that end on a deflate
+// block boundary, and the inflate state at each boundary (input offset,
+// leftover bits & the 32KB window) is kept as a restart point, so seeking
+// only decompresses from the start of the block holding the new position.
+// Decompressed blocks stay in the shared block cache.
+class ZipInflateIO : public IO
+{
+public:
+	using IOUtils::read;
+	using IOUtils::write;
+	using IOUtils::seek;
+
+	ZipInflateIO(std::shared_ptr<ArchiveIndex> index, const uint8 *data, uint64_t compressedSize, uint64_t size):
+		index{std::move(index)}, data{data}, compressedSize{compressedSize}, size_{size},
+		// caps the number of saved windows at a few hundred on huge entries
+		span{std::max((uint64_t)MIN_SPAN, size / 256)}
+	{
+		point.emplace_back(RestartPoint{});
+	}
+
+	~ZipInflateIO() final
+	{
+		close();
+	}
+
+	ssize_t read(void *buff, size_t bytes, std::error_code *ecOut) final
+	{
+		if(!index)
+		{
+			if(ecOut)
+				*ecOut = {EBADF, std::system_category()};
+			return -1;
+		}
+		bytes = std::min((uint64_t)bytes, size_ - pos);
+		size_t bytesRead = 0;
+		while(bytesRead < bytes)
+		{
+			uint32 blockPoint;
+			auto block = blockAt(pos, blockPoint);
+			if(!block)
+			{
+				if(ecOut)
+					*ecOut = {EIO, std::system_category()};
+				return -1;
+			}
+			auto blockOffset = pos - point[blockPoint].out;
+			auto copySize = std::min((uint64_t)block->size() - blockOffset, (uint64_t)(bytes - bytesRead));
+			memcpy((char*)buff + bytesRead, &(*block)[blockOffset], copySize);
+			bytesRead += copySize;
+			pos += copySize;
+		}
+		return bytesRead;
+	}
+
+	ssize_t write(const void *buff, size_t bytes, std::error_code *ecOut) final
+	{
+		if(ecOut)
+			*ecOut = {ENOSYS, std::system_category()};
+		return -1;
+	}
+
+	off_t seek(off_t offset, IO::SeekMode mode, std::error_code *ecOut) final
+	{
+		uint64_t newPos;
+		switch(mode)
+		{
+			case SEEK_SET: newPos = offset; break;
+			case SEEK_CUR: newPos = pos + offset; break;
+			case SEEK_END: newPos = size_ + offset; break;
+			default:
+				logErr("invalid seek mode: %d", (int)mode);
+				if(ecOut)
+					*ecOut = {EINVAL, std::system_category()};
+				return -1;
+		}
+		if(!index || newPos > size_)
+		{
+			if(ecOut)
+				*ecOut = {EINVAL, std::system_category()};
+			return -1;
+		}
+		// blocks decompress on the next read
+		pos = newPos;
+		return pos;
+	}
+
+	void close() final
+	{
+		if(index)
+			dropCachedBlocks(this);
+		index = {};
+		point.clear();
+	}
+
+	size_t size() final
+	{
+		return size_;
+	}
+
+	bool eof() final
+	{
+		return pos == size_;
+	}
+
+	explicit operator bool() final
+	{
+		return (bool)index;
+	}
+
+private:
+	static constexpr uint WINDOW_SIZE = 32 * 1024;
+	static constexpr uint MIN_SPAN = 1024 * 1024;
+
+	struct RestartPoint
+	{
+		uint64_t out; // offset in the decompressed data
+		uint64_t in; // offset of the first whole input byte
+		int bits; // bits of the previous input byte still to be used
+		std::unique_ptr<uint8[]> window;
+	};
+
+	std::shared_ptr<ArchiveIndex> index{}; // keeps the archive mapped
+	const uint8 *data{};
+	uint64_t compressedSize = 0;
+	uint64_t size_ = 0;
+	uint64_t pos = 0;
+	uint64_t span = 0;
+	std::vector<RestartPoint> point{};
+
+	BlockData blockAt(uint64_t offset, uint32 &idx)
+	{
+		while(true)
+		{
+			auto it = std::upper_bound(point.begin(), point.end(), offset,
+				[](uint64_t offset, const RestartPoint &p){ return offset < p.out; });
+			idx = (it - point.begin()) - 1;
+			auto block = findCachedBlock(this, idx);
+			if(!block)
+				block = decodeBlock(idx);
+			if(!block)
+				return {};
+			if(offset < point[idx].out + block->size())
+				return block;
+			// the offset is past the blocks found so far, decoding this one added the next point
+			if(idx + 1 == point.size())
+			{
+				logErr("offset %llu past end of inflated data", (unsigned long long)offset);
+				return {};
+			}
+		}
+	}
+
+	BlockData decodeBlock(uint32 idx)
+	{
+		z_stream strm{};
+		if(inflateInit2(&strm, -MAX_WBITS) != Z_OK)
+		{
+			logErr("error initializing inflate");
+			return {};
+		}
+		auto &start = point[idx];
+		if(start.bits)
+			inflatePrime(&strm, start.bits, data[start.in - 1] >> (8 - start.bits));
+		if(start.window)
+			inflateSetDictionary(&strm, start.window.get(), WINDOW_SIZE);
+		std::vector<uint8> out = takeBlockCacheSpace(span);
+		size_t outSize = 0;
+		uint64_t inPos = start.in;
+		bool ok = true;
+		while(true)
+		{
+			// inflate may still need a call with no input left to report the stream end
+			if(!strm.avail_in && inPos < compressedSize)
+			{
+				strm.next_in = (Bytef*)&data[inPos];
+				strm.avail_in = std::min(compressedSize - inPos, (uint64_t)UINT_MAX);
+				inPos += strm.avail_in;
+			}
+			if(out.size() - outSize < WINDOW_SIZE)
+				out.resize(std::max(out.size() * 2, (size_t)span + WINDOW_SIZE));
+			strm.next_out = &out[outSize];
+			strm.avail_out = std::min(out.size() - outSize, (size_t)UINT_MAX);
+			auto outStart = strm.avail_out;
+			// Z_BLOCK returns at the end of each deflate block
+			int ret = inflate(&strm, Z_BLOCK);
+			outSize += outStart - strm.avail_out;
+			if(ret == Z_STREAM_END)
+				break;
+			if(ret != Z_OK)
+			{
+				if(ret == Z_BUF_ERROR)
+					logErr("compressed data ended early");
+				else
+					logErr("inflate error:%d", ret);
+				ok = false;
+				break;
+			}
+			bool atBlockEnd = (strm.data_type & 128) && !(strm.data_type & 64);
+			if(atBlockEnd && outSize >= span)
+			{
+				if(idx + 1 == point.size())
+				{
+					auto window = std::make_unique<uint8[]>(WINDOW_SIZE);
+					memcpy(window.get(), &out[outSize - WINDOW_SIZE], WINDOW_SIZE);
+					uint64_t in = inPos - strm.avail_in;
+					point.emplace_back(RestartPoint{point[idx].out + outSize, in, strm.data_type & 7, std::move(window)});
+				}
+				break;
+			}
+		}
+		inflateEnd(&strm);
+		if(!ok)
+			return {};
+		out.resize(outSize);
+		return addCachedBlock(this, idx, std::move(out));
+	}
+};
+
+std::shared_ptr<ArchiveIndex> ArchiveIndex::open(const char *path, std::error_code &result)
+{
+	auto fileStatus = status(path, result);
+	if(result)
+		return {};
+	std::lock_guard<std::mutex> lock{cacheMutex};
+	for(auto it = cache.begin(); it != cache.end(); ++it)
+	{
+		auto &index = **it;
+		if(string_equal(index.path(), path) &&
+			index.fileSize == fileStatus.size() && index.fileTime == fileStatus.lastWriteTime())
+		{
+			std::rotate(cache.begin(), it, it + 1);
+			return cache.front();
+		}
+	}
+	std::shared_ptr<ArchiveIndex> index{new ArchiveIndex};
+	if(auto ec = index->init(path);
+		ec)
+	{
+		result = ec;
+		return {};
+	}
+	index->fileSize = fileStatus.size();
+	index->fileTime = fileStatus.lastWriteTime();
+	// drop any stale index of the same path
+	cache.erase(std::remove_if(cache.begin(), cache.end(),
+		[path](auto &i){ return string_equal(i->path(), path); }), cache.end());
+	cache.insert(cache.begin(), index);
+	if(cache.size() > MAX_CACHED_INDEXES)
+		cache.pop_back();
+	return index;
+}
+
+void ArchiveIndex::clearCache()
+{
+	std::lock_guard<std::mutex> lock{cacheMutex};
+	cache.clear();
+}
+
+void ArchiveIndex::setBlockCacheLimit(size_t bytes)
+{
+	blockCacheLimit_.store(bytes, std::memory_order_relaxed);
+}
+
+size_t ArchiveIndex::blockCacheLimit()
+{
+	return blockCacheLimit_.load(std::memory_order_relaxed);
+}
+
+std::error_code ArchiveIndex::init(const char *path)
+{
+	string_copy(path_, path);
+	if(auto ec = file.open(path, IO::AccessHint::RANDOM);
+		ec)
+	{
+		return ec;
+	}
+	if(!file.mmapConst() || !readZipDirectory())
+	{
+		// entries are opened through libarchive, no need to keep the file open
+		file.close();
+		if(auto ec = readArchiveEntries();
+			ec)
+		{
+			return ec;
+		}
+	}
+	iterateTimes(entry.size(), i)
+	{
+		auto &e = entry[i];
+		if(e.isDirectory)
+			continue;
+		nameMap.emplace(e.name, i);
+		crcMap.emplace(e.crc32, i);
+	}
+	return {};
+}
+
+bool ArchiveIndex::readZipDirectory()
+{
+	auto data = (const uint8*)file.mmapConst();
+	uint64_t size = file.size();
+	if(size < 22)
+		return false;
+	// the end of central directory record is followed by a comment of up to 64KB
+	const uint8 *eocd{};
+	for(uint64_t offset = size - 22, searchEnd = offset > 0xFFFF ? offset - 0xFFFF : 0;; offset--)
+	{
+		if(readLE32(data + offset) == ZIP_EOCD_SIG)
+		{
+			eocd = data + offset;
+			break;
+		}
+		if(offset == searchEnd)
+			break;
+	}
+	if(!eocd)
+		return false;
+	uint64_t entries = readLE16(eocd + 10);
+	uint64_t dirSize = readLE32(eocd + 12);
+	uint64_t dirOffset = readLE32(eocd + 16);
+	if(entries == 0xFFFF || dirSize == 0xFFFFFFFF || dirOffset == 0xFFFFFFFF)
+	{
+		if(eocd - data < 20 || readLE32(eocd - 20) != ZIP64_EOCD_LOCATOR_SIG)
+			return false;
+		uint64_t eocd64Offset = readLE64(eocd - 20 + 8);
+		if(size < 56 || eocd64Offset > size - 56 || readLE32(data + eocd64Offset) != ZIP64_EOCD_SIG)
+			return false;
+		auto eocd64 = data + eocd64Offset;
+		entries = readLE64(eocd64 + 32);
+		dirSize = readLE64(eocd64 + 40);
+		dirOffset = readLE64(eocd64 + 48);
+	}
+	if(dirOffset > size || dirSize > size - dirOffset || entries > dirSize / 46)
+		return false;
+	entry.reserve(entries);
+	auto p = data + dirOffset;
+	auto dirEnd = p + dirSize;
+	iterateTimes(entries, i)
+	{
+		if(dirEnd - p < 46 || readLE32(p) != ZIP_CENTRAL_HEADER_SIG)
+		{
+			logErr("bad central directory entry %u in %s", (uint)i, path());
+			entry.clear();
+			return false;
+		}
+		uint16 flags = readLE16(p + 8);
+		uint16 method = readLE16(p + 10);
+		uint32 crc = readLE32(p + 16);
+		uint64_t compressedSize = readLE32(p + 20);
+		uint64_t uncompressedSize = readLE32(p + 24);
+		uint16 nameLen = readLE16(p + 28);
+		uint16 extraLen = readLE16(p + 30);
+		uint16 commentLen = readLE16(p + 32);
+		uint64_t headerOffset = readLE32(p + 42);
+		if(dirEnd - p < 46 + nameLen + extraLen + commentLen)
+		{
+			entry.clear();
+			return false;
+		}
+		auto name = (const char*)p + 46;
+		// ZIP64 extended information holds the fields saturated above, in order
+		for(auto extra = p + 46 + nameLen, extraEnd = extra + extraLen; extraEnd - extra >= 4;)
+		{
+			uint16 id = readLE16(extra);
+			uint16 len = readLE16(extra + 2);
+			auto field = extra + 4;
+			extra = field + len;
+			if(id != 0x0001 || extra > extraEnd)
+				continue;
+			auto readField =
+				[&](uint64_t &val)
+				{
+					if(val != 0xFFFFFFFF || extra - field < 8)
+						return;
+					val = readLE64(field);
+					field += 8;
+				};
+			readField(uncompressedSize);
+			readField(compressedSize);
+			readField(headerOffset);
+		}
+		bool isDir = nameLen && name[nameLen - 1] == '/';
+		// encrypted entries can't be read directly
+		bool directAccess = !(flags & 0x1) && (method == ZIP_STORED || method == ZIP_DEFLATED);
+		entry.emplace_back(Entry{{name, nameLen}, uncompressedSize, compressedSize, headerOffset,
+			crc, directAccess ? method : NO_METHOD, isDir});
+		p += 46 + nameLen + extraLen + commentLen;
+	}
+	logMsg("indexed %u ZIP entries in %s", (uint)entry.size(), path());
+	return true;
+}
+
+std::error_code ArchiveIndex::readArchiveEntries()
+{
+	std::error_code ec{};
+	for(auto &e : ArchiveIterator{path(), ec})
+	{
+		auto type = e.type();
+		entry.emplace_back(Entry{e.name(), e.size(), 0, 0, e.crc32(), NO_METHOD,
+			type == file_type::directory});
+	}
+	if(ec)
+		return ec;
+	logMsg("indexed %u entries in %s", (uint)entry.size(), path());
+	return {};
+}
+
+const ArchiveIndex::Entry *ArchiveIndex::find(const char *name) const
+{
+	auto it = nameMap.find(name);
+	if(it == nameMap.end())
+		return nullptr;
+	return &entry[it->second];
+}
+
+const ArchiveIndex::Entry *ArchiveIndex::findCRC(uint32 crc) const
+{
+	auto it = crcMap.find(crc);
+	if(it == crcMap.end())
+		return nullptr;
+	return &entry[it->second];
+}
+
+GenericIO ArchiveIndex::openEntry(const Entry &e)
+{
+	if(e.isDirectory)
+		return {};
+	if(e.method == NO_METHOD)
+		return openByScan(e);
+	auto data = (const uint8*)file.mmapConst();
+	uint64_t size = file.size();
+	if(size < 30 || e.headerOffset > size - 30 || readLE32(data + e.headerOffset) != ZIP_LOCAL_HEADER_SIG)
+	{
+		logErr("bad local header for %s", e.name.c_str());
+		return {};
+	}
+	auto header = data + e.headerOffset;
+	uint64_t dataOffset = e.headerOffset + 30 + readLE16(header + 26) + readLE16(header + 28);
+	if(dataOffset > size || e.compressedSize > size - dataOffset)
+	{
+		logErr("entry %s extends past archive end", e.name.c_str());
+		return {};
+	}
+	if(e.method == ZIP_STORED)
+	{
+		if(e.size != e.compressedSize)
+			return {};
+		// the window holds a reference to the index so the mapping outlives it
+		auto indexRef = new std::shared_ptr<ArchiveIndex>{shared_from_this()};
+		BufferMapIO io{};
+		io.open(data + dataOffset, e.size,
+			[indexRef](BufferMapIO &)
+			{
+				delete indexRef;
+			});
+		return io.makeGeneric();
+	}
+	return {std::make_unique<ZipInflateIO>(shared_from_this(), data + dataOffset, e.compressedSize, e.size)};
+}
+
+GenericIO ArchiveIndex::openSeekableEntry(const Entry &e)
+{
+	if(e.method != NO_METHOD)
+		return openEntry(e);
+	// libarchive only streams forward, so decompress it all up front
+	auto io = openByScan(e);
+	if(!io)
+		return {};
+	auto buff = new char[e.size];
+	if(io.read(buff, e.size) != (ssize_t)e.size)
+	{
+		logErr("error reading %s into memory", e.name.c_str());
+		delete[] buff;
+		return {};
+	}
+	BufferMapIO mapIO{};
+	mapIO.open(buff, e.size, [buff](BufferMapIO &){ delete[] buff; });
+	return mapIO.makeGeneric();
+}
+
+GenericIO ArchiveIndex::openByScan(const Entry &e)
+{
+	for(auto &archEntry : ArchiveIterator{path()})
+	{
+		if(archEntry.type() == file_type::directory)
+			continue;
+		if(e.name == archEntry.name())
+		{
+			return archEntry.moveIO().makeGeneric();
+		}
+	}
+	return {};
+}
+
+}
@@ -17,6 +17,7 @@
 #include <imagine/gfx/Gfx.hh>
 #include <imagine/gfx/Texture.hh>
 #include <imagine/util/ScopeGuard.hh>
+#include <imagine/logger/Trace.hh>
 #include <imagine/util/utility.h>
 #include <imagine/mem/mem.h>
 #include "private.hh"
@@ -742,6 +743,7 @@ void Texture::bind()
 
 void Texture::write(uint level, const IG::Pixmap &pixmap, IG::WP destPos, uint assumeAlign)
 {
+	IG_TRACE_SPAN("Texture::write");
 	//logDMsg("writing pixmap %dx%d to pos %dx%d", pixmap.x, pixmap.y, destPos.x, destPos.y);
 	if(unlikely(!texName_))
 	{
@@ -856,6 +858,7 @@ LockedTextureBuffer Texture::lock(uint level)
 	assumeExpr(r);
 	if(directTex)
 	{
+		IG_TRACE_SPAN("Texture::lock");
 		assert(level == 0);
 		auto buff = directTex->lock(*r, nullptr);
 		IG::Pixmap pix{pixDesc, buff.data, {buff.pitch, IG::Pixmap::BYTE_UNITS}};
@@ -871,6 +874,7 @@ LockedTextureBuffer Texture::lock(uint level)
 
 LockedTextureBuffer Texture::lock(uint level, IG::WindowRect rect)
 {
+	IG_TRACE_SPAN("Texture::lock");
 	assumeExpr(r);
 	assert(rect.x2  <= size(level).x);
 	assert(rect.y2 <= size(level).y);
@@ -913,6 +917,7 @@ LockedTextureBuffer Texture::lock(uint level, IG::WindowRect rect)
 
 void Texture::unlock(LockedTextureBuffer lockBuff)
 {
+	IG_TRACE_SPAN("Texture::unlock");
 	assumeExpr(r);
 	if(directTex)
 		directTex->unlock(*r, texName_);
@@ -18,6 +18,7 @@
 #include <sys/inotify.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <time.h>
 #include <imagine/util/algorithm.h>
 #include <imagine/util/bits.h>
 #include <imagine/util/fd-utils.h>
@@ -371,6 +372,14 @@ static bool processDevNode(const char *path, int id, bool notify)
 		logWarn("unable to get device name");
 		string_copy(nameStr, "Unknown");
 	}
+	#ifdef EVIOCSCLOCKID
+	// events default to CLOCK_REALTIME, but input times are compared to the monotonic clock
+	int clockId = CLOCK_MONOTONIC;
+	if(ioctl(fd, EVIOCSCLOCKID, &clockId) < 0)
+	{
+		logWarn("unable to set monotonic event clock");
+	}
+	#endif
 	evDevice.emplace_back(std::make_unique<EvdevInputDevice>(id, fd, Device::TYPE_BIT_GAMEPAD, nameStr.data()));
 	auto &evDev = evDevice.back();
 	bool isJoystick = evDev->setupJoystickBits();
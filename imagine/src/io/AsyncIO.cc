@@ -0,0 +1,286 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "AsyncIO"
+#include "AsyncIO.hh"
+#include <imagine/logger/logger.h>
+#include <mutex>
+// Android's seccomp filter kills apps making io_uring syscalls
+#if defined __linux__ && !defined __ANDROID__ && __has_include(<linux/io_uring.h>)
+#define CONFIG_IO_URING
+#include <imagine/thread/Thread.hh>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace IG
+{
+
+ThreadPool &ioThreadPool()
+{
+	static ThreadPool pool{};
+	static std::once_flag initFlag{};
+	std::call_once(initFlag, [](){ pool.init(2); });
+	return pool;
+}
+
+#ifdef CONFIG_IO_URING
+
+// One ring shared by every IO. Submitters fill SQEs under a lock while a
+// detached thread waits on the ring and runs completions, so the ring is
+// never destroyed once created. Submitted requests stay linked in a list
+// until completed so they can be failed if that thread has to quit.
+class ReadRing
+{
+public:
+	static constexpr uint ENTRIES = 64;
+
+	bool init();
+	bool submit(int fd, void *buff, size_t bytes, off_t offset, IO::ReadAsyncDelegate onComplete);
+
+private:
+	struct Request
+	{
+		iovec iov;
+		IO::ReadAsyncDelegate onComplete;
+		Request *prev{};
+		Request *next{};
+	};
+
+	int ringFd = -1;
+	uint sqEntries = 0;
+	uint cqEntries = 0;
+	uint *sqHead{};
+	uint *sqTail{};
+	uint sqMask = 0;
+	uint *sqArray{};
+	io_uring_sqe *sqes{};
+	uint *cqHead{};
+	uint *cqTail{};
+	uint cqMask = 0;
+	io_uring_cqe *cqes{};
+	std::atomic_uint inFlight{};
+	std::mutex submitMutex{}; // guards the SQ, pending list, and dead
+	Request *pending{};
+	bool dead = false;
+
+	void runCompletions();
+	void link(Request *req);
+	void unlink(Request *req);
+	void failPending(int error);
+};
+
+static int ioUringSetup(uint entries, io_uring_params *params)
+{
+	return syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int ioUringEnter(int fd, uint toSubmit, uint minComplete, uint flags)
+{
+	return syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0);
+}
+
+bool ReadRing::init()
+{
+	io_uring_params params{};
+	ringFd = ioUringSetup(ENTRIES, &params);
+	if(ringFd == -1)
+	{
+		logMsg("io_uring unavailable:%s", strerror(errno));
+		return false;
+	}
+	sqEntries = params.sq_entries;
+	cqEntries = params.cq_entries;
+	size_t sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint);
+	size_t cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+	if(singleMmap)
+		sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+	auto sqRing = (char*)mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+	auto cqRing = singleMmap ? sqRing :
+		(char*)mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+	sqes = (io_uring_sqe*)mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+	if(sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqes == MAP_FAILED)
+	{
+		logErr("error mapping io_uring:%s", strerror(errno));
+		// the mappings are released with the process, the ring itself when its fd closes
+		::close(ringFd);
+		return false;
+	}
+	sqHead = (uint*)(sqRing + params.sq_off.head);
+	sqTail = (uint*)(sqRing + params.sq_off.tail);
+	sqMask = *(uint*)(sqRing + params.sq_off.ring_mask);
+	sqArray = (uint*)(sqRing + params.sq_off.array);
+	cqHead = (uint*)(cqRing + params.cq_off.head);
+	cqTail = (uint*)(cqRing + params.cq_off.tail);
+	cqMask = *(uint*)(cqRing + params.cq_off.ring_mask);
+	cqes = (io_uring_cqe*)(cqRing + params.cq_off.cqes);
+	makeDetachedThread([this](){ runCompletions(); });
+	logMsg("using io_uring with %u entries", sqEntries);
+	return true;
+}
+
+bool ReadRing::submit(int fd, void *buff, size_t bytes, off_t offset, IO::ReadAsyncDelegate onComplete)
+{
+	// more reads than CQEs could overflow the completion queue on older kernels
+	if(inFlight.fetch_add(1, std::memory_order_relaxed) >= cqEntries)
+	{
+		inFlight.fetch_sub(1, std::memory_order_relaxed);
+		return false;
+	}
+	std::lock_guard<std::mutex> lock{submitMutex};
+	uint tail = *sqTail;
+	if(dead || tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries)
+	{
+		inFlight.fetch_sub(1, std::memory_order_relaxed);
+		return false;
+	}
+	// READV rather than READ works back to the first io_uring kernels
+	auto req = new Request{{buff, bytes}, onComplete};
+	uint idx = tail & sqMask;
+	auto &sqe = sqes[idx];
+	memset(&sqe, 0, sizeof(sqe));
+	sqe.opcode = IORING_OP_READV;
+	sqe.fd = fd;
+	sqe.off = offset;
+	sqe.addr = (uintptr_t)&req->iov;
+	sqe.len = 1;
+	sqe.user_data = (uintptr_t)req;
+	sqArray[idx] = idx;
+	link(req);
+	__atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+	if(ioUringEnter(ringFd, 1, 0, 0) != 1)
+	{
+		// Without SQPOLL the kernel only reads the SQ inside io_uring_enter(),
+		// so an SQE it didn't consume can be taken back and the read done by the caller
+		if(__atomic_load_n(sqHead, __ATOMIC_ACQUIRE) == tail)
+		{
+			logWarn("error submitting read:%s", strerror(errno));
+			__atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+			unlink(req);
+			delete req;
+			inFlight.fetch_sub(1, std::memory_order_relaxed);
+			return false;
+		}
+	}
+	return true;
+}
+
+void ReadRing::link(Request *req)
+{
+	req->next = pending;
+	if(pending)
+		pending->prev = req;
+	pending = req;
+}
+
+void ReadRing::unlink(Request *req)
+{
+	if(req->prev)
+		req->prev->next = req->next;
+	else
+		pending = req->next;
+	if(req->next)
+		req->next->prev = req->prev;
+}
+
+void ReadRing::failPending(int error)
+{
+	Request *req;
+	{
+		std::lock_guard<std::mutex> lock{submitMutex};
+		dead = true;
+		req = pending;
+		pending = {};
+	}
+	while(req)
+	{
+		auto next = req->next;
+		req->onComplete(-1, {error, std::system_category()});
+		delete req;
+		req = next;
+	}
+}
+
+void ReadRing::runCompletions()
+{
+	for(;;)
+	{
+		if(ioUringEnter(ringFd, 0, 1, IORING_ENTER_GETEVENTS) == -1 && errno != EINTR && errno != EAGAIN)
+		{
+			int error = errno;
+			logErr("error waiting on io_uring:%s", strerror(error));
+			failPending(error);
+			return;
+		}
+		uint head = *cqHead;
+		uint tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+		for(; head != tail; head++)
+		{
+			auto &cqe = cqes[head & cqMask];
+			auto req = (Request*)cqe.user_data;
+			int res = cqe.res;
+			// hand the CQE back before running user code
+			__atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+			inFlight.fetch_sub(1, std::memory_order_relaxed);
+			{
+				std::lock_guard<std::mutex> lock{submitMutex};
+				unlink(req);
+			}
+			if(res < 0)
+			{
+				logErr("error reading %zu bytes:%s", req->iov.iov_len, strerror(-res));
+				req->onComplete(-1, {-res, std::system_category()});
+			}
+			else
+				req->onComplete(res, {});
+			delete req;
+		}
+	}
+}
+
+bool submitRingRead(int fd, void *buff, size_t bytes, off_t offset, IO::ReadAsyncDelegate onComplete)
+{
+	static ReadRing *ring{};
+	static std::once_flag initFlag{};
+	std::call_once(initFlag,
+		[]()
+		{
+			auto newRing = new ReadRing{};
+			if(newRing->init())
+				ring = newRing;
+			else
+				delete newRing;
+		});
+	return ring && ring->submit(fd, buff, bytes, offset, onComplete);
+}
+
+#else
+
+bool submitRingRead(int fd, void *buff, size_t bytes, off_t offset, IO::ReadAsyncDelegate onComplete)
+{
+	return false;
+}
+
+#endif
+
+}
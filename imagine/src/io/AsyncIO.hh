@@ -0,0 +1,33 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/io/IO.hh>
+#include <imagine/thread/ThreadPool.hh>
+
+namespace IG
+{
+
+// threads for reads that may block on the device, kept apart from
+// ThreadPool::shared() so they don't hold up compute tasks
+ThreadPool &ioThreadPool();
+
+// Queues a read of fd on the process-wide io_uring, onComplete runs on
+// the ring's completion thread. Returns false without calling onComplete
+// if io_uring isn't available or the ring is full.
+bool submitRingRead(int fd, void *buff, size_t bytes, off_t offset, IO::ReadAsyncDelegate onComplete);
+
+}
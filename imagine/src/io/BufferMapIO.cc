@@ -16,6 +16,20 @@
 #define LOGTAG "BufferMapIO"
 #include <imagine/io/BufferMapIO.hh>
 #include <imagine/logger/logger.h>
+#include <imagine/util/system/pagesize.h>
+#include <sys/mman.h>
+#ifdef __ANDROID__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef __ANDROID__
+// Bionic is missing extended mremap with new_address parameter
+static void *mremap(void *old_address, size_t old_size, size_t new_size, int flags, void *new_address)
+{
+	return (void*)syscall(__NR_mremap, old_address, old_size, new_size, flags, new_address);
+}
+#endif
 
 BufferMapIO::~BufferMapIO()
 {
@@ -49,6 +63,48 @@ std::error_code BufferMapIO::open(const void *buff, size_t size, OnCloseDelegate
 	return {};
 }
 
+std::error_code BufferMapIO::openMmap(void *buff, size_t size)
+{
+	auto ec = open(buff, size,
+		[](BufferMapIO &io)
+		{
+			logMsg("unmapping %p", io.data);
+			munmap((void*)io.data, io.dataSize);
+		});
+	isMmap = true;
+	return ec;
+}
+
+std::error_code BufferMapIO::moveMappingTo(void *addr)
+{
+	#if defined __linux__
+	if(!isMmap)
+		return {ENOTSUP, std::system_category()};
+	auto mapSize = roundUpToPageSize(dataSize);
+	if(mremap((void*)data, mapSize, mapSize, MREMAP_MAYMOVE | MREMAP_FIXED, addr) == MAP_FAILED)
+	{
+		auto err = errno;
+		logErr("error moving mapping %p to %p", data, addr);
+		return {err, std::system_category()};
+	}
+	logMsg("moved mapping %p to %p", data, addr);
+	// the pages now belong to the caller
+	onClose = {};
+	isMmap = false;
+	resetData();
+	// private mappings can become writable even if the file was opened read-only
+	if(mprotect(addr, mapSize, PROT_READ | PROT_WRITE) == -1)
+	{
+		auto err = errno;
+		logErr("error making mapping at %p writable", addr);
+		return {err, std::system_category()};
+	}
+	return {};
+	#else
+	return {ENOTSUP, std::system_category()};
+	#endif
+}
+
 void BufferMapIO::close()
 {
 	if(data)
@@ -58,6 +114,7 @@ void BufferMapIO::close()
 			onClose(*this);
 			onClose = {};
 		}
+		isMmap = false;
 		resetData();
 	}
 }
@@ -19,6 +19,7 @@
 #include <imagine/fs/FS.hh>
 #include <imagine/logger/logger.h>
 #include "IOUtils.hh"
+#include "AsyncIO.hh"
 
 template class IOUtils<IO>;
 template class IOUtils<GenericIO>;
@@ -34,6 +35,27 @@ ssize_t IO::readAtPos(void *buff, size_t bytes, off_t offset, std::error_code *e
 	return bytesRead;
 }
 
+void IO::readAsync(void *buff, size_t bytes, off_t offset, ReadAsyncDelegate onComplete)
+{
+	struct AsyncRead
+	{
+		IO &io;
+		void *buff;
+		size_t bytes;
+		off_t offset;
+		ReadAsyncDelegate onComplete;
+	};
+	auto read = new AsyncRead{*this, buff, bytes, offset, onComplete};
+	IG::ioThreadPool().run(
+		[read]()
+		{
+			std::error_code ec{};
+			auto bytesRead = read->io.readAtPos(read->buff, read->bytes, read->offset, &ec);
+			read->onComplete(bytesRead, ec);
+			delete read;
+		});
+}
+
 GenericIO::GenericIO(GenericIO &&o)
 {
 	io = std::move(o.io);
@@ -139,6 +161,11 @@ const char *GenericIO::mmapConst()
 	return io ? io->mmapConst() : nullptr;
 }
 
+std::error_code GenericIO::moveMappingTo(void *addr)
+{
+	return io ? io->moveMappingTo(addr) : std::error_code{EBADF, std::system_category()};
+}
+
 ssize_t GenericIO::write(const void *buff, size_t bytes, std::error_code *ecOut)
 {
 	if(!io)
@@ -194,6 +221,22 @@ void GenericIO::advise(off_t offset, size_t bytes, IO::Advice advice)
 		io->advise(offset, bytes, advice);
 }
 
+void GenericIO::prefetch(off_t offset, size_t bytes)
+{
+	if(io)
+		io->prefetch(offset, bytes);
+}
+
+void GenericIO::readAsync(void *buff, size_t bytes, off_t offset, IO::ReadAsyncDelegate onComplete)
+{
+	if(!io)
+	{
+		onComplete(-1, {EBADF, std::system_category()});
+		return;
+	}
+	io->readAsync(buff, bytes, offset, onComplete);
+}
+
 GenericIO::operator bool()
 {
 	return io && *io;
@@ -222,6 +265,34 @@ std::error_code writeToNewFile(const char *path, void *data, size_t size)
 	return {};
 }
 
+std::error_code writeToNewFileAtomic(const char *path, const void *data, size_t size)
+{
+	// kept in the same directory so the rename never crosses filesystems
+	auto tempPath = FS::makePathStringPrintf("%s.tmp", path);
+	{
+		FileIO f;
+		auto ec = f.create(tempPath.data());
+		if(!f)
+			return ec;
+		ec = f.writeAll((void*)data, size);
+		if(ec)
+		{
+			f.close();
+			FS::remove(tempPath);
+			return ec;
+		}
+		f.sync();
+	}
+	std::error_code ec{};
+	FS::rename(tempPath.data(), path, ec);
+	if(ec)
+	{
+		logErr("error renaming %s to %s", tempPath.data(), path);
+		FS::remove(tempPath);
+	}
+	return ec;
+}
+
 ssize_t readFromFile(const char *path, void *data, size_t size)
 {
 	FileIO f;
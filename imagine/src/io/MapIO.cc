@@ -119,6 +119,15 @@ void MapIO::advise(off_t offset, size_t bytes, Advice advice)
 		logWarn("madvise for offset 0x%llX with size %zu failed", (unsigned long long)offset, bytes);
 	}
 }
+
+void MapIO::prefetch(off_t offset, size_t bytes)
+{
+	if(offset >= (off_t)dataSize)
+		return;
+	// the kernel reads file pages in asynchronously, a worker touching
+	// them could fault on a mapping closed meanwhile
+	advise(offset, bytes, Advice::WILLNEED);
+}
 #endif
 
 void MapIO::setData(const void *dataPtr, size_t size)
@@ -85,8 +85,8 @@ std::error_code PosixFileIO::open(const char *path, IO::AccessHint access, uint
 		}
 	}
 
-	// setup advice if using read access
-	if((mode & IO::OPEN_READ))
+	// setup advice if using read access, the default without OPEN_WRITE
+	if((mode & IO::OPEN_READ) || !(mode & IO::OPEN_WRITE))
 	{
 		switch(access)
 		{
@@ -115,6 +115,11 @@ const char *PosixFileIO::mmapConst()
 	return io().mmapConst();
 }
 
+std::error_code PosixFileIO::moveMappingTo(void *addr)
+{
+	return io().moveMappingTo(addr);
+}
+
 ssize_t PosixFileIO::write(const void *buff, size_t bytes, std::error_code *ecOut)
 {
 	return io().write(buff, bytes, ecOut);
@@ -155,6 +160,16 @@ void PosixFileIO::advise(off_t offset, size_t bytes, IO::Advice advice)
 	io().advise(offset, bytes, advice);
 }
 
+void PosixFileIO::prefetch(off_t offset, size_t bytes)
+{
+	io().prefetch(offset, bytes);
+}
+
+void PosixFileIO::readAsync(void *buff, size_t bytes, off_t offset, IO::ReadAsyncDelegate onComplete)
+{
+	io().readAsync(buff, bytes, offset, onComplete);
+}
+
 PosixFileIO::operator bool()
 {
 	return (bool)io();
@@ -22,6 +22,7 @@
 #include <imagine/util/utility.h>
 #include <imagine/logger/logger.h>
 #include "utils.hh"
+#include "AsyncIO.hh"
 
 using namespace IG;
 
@@ -191,13 +192,19 @@ bool PosixIO::eof()
 	return tell() >= (off_t)size();
 }
 
-#if _XOPEN_SOURCE >= 600 || _POSIX_C_SOURCE >= 200112L
+// Bionic only has posix_fadvise() from Android 5.0
+#if (defined __linux__ && (!defined __ANDROID__ || __ANDROID_API__ >= 21)) || \
+	(!defined __APPLE__ && (_XOPEN_SOURCE >= 600 || _POSIX_C_SOURCE >= 200112L))
+#define HAS_FADVISE
+#endif
+
+#ifdef HAS_FADVISE
 static int adviceToFAdv(IO::Advice advice)
 {
 	switch(advice)
 	{
 		default: return POSIX_FADV_NORMAL;
-		case IO::Advice::SEQUENTIAL: return POSIX_FADV_NORMAL;
+		case IO::Advice::SEQUENTIAL: return POSIX_FADV_SEQUENTIAL;
 		case IO::Advice::RANDOM: return POSIX_FADV_RANDOM;
 		case IO::Advice::WILLNEED: return POSIX_FADV_WILLNEED;
 	}
@@ -206,20 +213,75 @@ static int adviceToFAdv(IO::Advice advice)
 
 void PosixIO::advise(off_t offset, size_t bytes, Advice advice)
 {
-	#ifdef __APPLE__
-	if(advice == Advice::SEQUENTIAL || advice == Advice::WILLNEED)
+	#if defined __APPLE__
+	if(advice == Advice::WILLNEED && bytes)
+	{
+		radvisory ra{offset, (int)std::min(bytes, (size_t)INT_MAX)};
+		fcntl(fd_, F_RDADVISE, &ra);
+	}
+	else if(advice == Advice::SEQUENTIAL || advice == Advice::WILLNEED)
 		fcntl(fd_, F_RDAHEAD, 1);
-	#else
-		#if _XOPEN_SOURCE >= 600 || _POSIX_C_SOURCE >= 200112L
-		int fAdv =  adviceToFAdv(advice);
-		if(posix_fadvise(fd_, offset, bytes, fAdv) != 0)
-		{
-			logMsg("fadvise for offset 0x%llX with size %zu failed", (unsigned long long)offset, bytes);
-		}
-		#endif
+	#elif defined HAS_FADVISE
+	int fAdv = adviceToFAdv(advice);
+	if(int err = posix_fadvise(fd_, offset, bytes, fAdv);
+		err)
+	{
+		logMsg("fadvise for offset 0x%llX with size %zu failed:%s", (unsigned long long)offset, bytes, strerror(err));
+	}
 	#endif
 }
 
+void PosixIO::prefetch(off_t offset, size_t bytes)
+{
+	if(fd_ == -1)
+		return;
+	// the task reads through its own fd so closing this IO can't race it
+	int fd = dup(fd_);
+	if(fd == -1)
+	{
+		logErr("error duplicating fd %d for prefetch", fd_);
+		return;
+	}
+	if(!bytes)
+		bytes = std::max((off_t)fd_size(fd) - offset, (off_t)0);
+	struct PrefetchRange
+	{
+		int fd;
+		off_t offset;
+		size_t bytes;
+	};
+	auto range = new PrefetchRange{fd, offset, bytes};
+	IG::ioThreadPool().run(
+		[range]()
+		{
+			#if defined __linux__ && !defined __ANDROID__
+			// fills the page cache without copying out, blocks until read
+			readahead(range->fd, range->offset, range->bytes);
+			#else
+			char buff[16 * 1024];
+			off_t offset = range->offset;
+			size_t bytesLeft = range->bytes;
+			while(bytesLeft)
+			{
+				auto bytesRead = ::pread(range->fd, buff, std::min(bytesLeft, sizeof(buff)), offset);
+				if(bytesRead <= 0)
+					break;
+				offset += bytesRead;
+				bytesLeft -= bytesRead;
+			}
+			#endif
+			::close(range->fd);
+			delete range;
+		});
+}
+
+void PosixIO::readAsync(void *buff, size_t bytes, off_t offset, ReadAsyncDelegate onComplete)
+{
+	if(fd_ != -1 && IG::submitRingRead(fd_, buff, bytes, offset, onComplete))
+		return;
+	IO::readAsync(buff, bytes, offset, onComplete);
+}
+
 PosixIO::operator bool()
 {
 	return fd_ != -1;
@@ -234,7 +296,8 @@ std::error_code openPosixMapIO(BufferMapIO &io, IO::AccessHint access, int fd)
 {
 	io.close();
 	off_t size = fd_size(fd);
-	int flags = MAP_SHARED;
+	// private so moveMappingTo() can make the pages writable
+	int flags = MAP_PRIVATE;
 	#if defined __linux__
 	if(access == IO::AccessHint::ALL)
 		flags |= MAP_POPULATE;
@@ -242,11 +305,5 @@ std::error_code openPosixMapIO(BufferMapIO &io, IO::AccessHint access, int fd)
 	void *data = mmap(nullptr, size, PROT_READ, flags, fd, 0);
 	if(data == MAP_FAILED)
 		return {errno, std::system_category()};
-	io.open((const char*)data, size,
-		[data](BufferMapIO &io)
-		{
-			logMsg("unmapping %p", data);
-			munmap(data, io.size());
-		});
-	return {};
+	return io.openMmap(data, size);
 }
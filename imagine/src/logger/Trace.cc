@@ -0,0 +1,206 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "Trace"
+#include <imagine/logger/Trace.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/io/FileIO.hh>
+#include <imagine/time/Time.hh>
+#include <imagine/util/string.h>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace Trace
+{
+
+static constexpr uint EVENTS_PER_THREAD = 16384;
+
+struct Event
+{
+	const char *name;
+	uint64_t start; // nanoseconds
+	uint64_t dur;
+};
+
+// written only by its own thread, read by writeJSON()
+struct ThreadBuffer
+{
+	std::array<Event, EVENTS_PER_THREAD> event{};
+	std::atomic<uint64_t> written{};
+	uint tid = 0;
+	std::array<char, 32> name{};
+};
+
+static std::mutex bufferListMutex{};
+static std::vector<ThreadBuffer*> bufferList{};
+static thread_local ThreadBuffer *threadBuffer{};
+// bumped by deinit() so threads drop their freed buffer and register a new one
+static std::atomic<uint> bufferGeneration{};
+static thread_local uint threadBufferGeneration{};
+static std::atomic_bool enabled{};
+
+static uint64_t now()
+{
+	return IG::Time::now().nSecs();
+}
+
+// trace timestamps start from program load
+static const uint64_t baseTime = now();
+
+static ThreadBuffer &buffer()
+{
+	auto gen = bufferGeneration.load(std::memory_order_acquire);
+	if(likely(threadBuffer && threadBufferGeneration == gen))
+		return *threadBuffer;
+	// kept until deinit() so events outlive their thread
+	auto buff = new ThreadBuffer;
+	std::lock_guard<std::mutex> lock{bufferListMutex};
+	buff->tid = bufferList.size() + 1;
+	snprintf(buff->name.data(), buff->name.size(), "Thread %u", buff->tid);
+	bufferList.emplace_back(buff);
+	threadBuffer = buff;
+	threadBufferGeneration = gen;
+	return *buff;
+}
+
+Span::Span(const char *name):
+	name{name},
+	start{enabled.load(std::memory_order_relaxed) ? now() : 0}
+{}
+
+Span::~Span()
+{
+	if(!start || !enabled.load(std::memory_order_relaxed))
+		return;
+	auto end = now();
+	auto &buff = buffer();
+	auto idx = buff.written.load(std::memory_order_relaxed);
+	buff.event[idx % EVENTS_PER_THREAD] = {name, start, end - start};
+	buff.written.store(idx + 1, std::memory_order_release);
+}
+
+void setEnabled(bool on)
+{
+	enabled.store(on, std::memory_order_relaxed);
+}
+
+bool isEnabled()
+{
+	return enabled.load(std::memory_order_relaxed);
+}
+
+void setThreadName(const char *name)
+{
+	string_copy(buffer().name, name);
+}
+
+void deinit()
+{
+	enabled.store(false, std::memory_order_relaxed);
+	std::lock_guard<std::mutex> lock{bufferListMutex};
+	for(auto buff : bufferList)
+	{
+		delete buff;
+	}
+	bufferList.clear();
+	bufferList.shrink_to_fit();
+	bufferGeneration.fetch_add(1, std::memory_order_release);
+}
+
+static bool writeString(IO &io, const char *str)
+{
+	size_t len = strlen(str);
+	return io.write(str, len) == (ssize_t)len;
+}
+
+// copies str escaped for use inside a JSON string, truncating to fit
+template <size_t S>
+static void escapeJSONString(std::array<char, S> &out, const char *str)
+{
+	size_t len = 0;
+	for(; *str; str++)
+	{
+		auto c = *str;
+		if(c == '"' || c == '\\')
+		{
+			if(len + 2 >= S)
+				break;
+			out[len++] = '\\';
+			out[len++] = c;
+		}
+		else if((unsigned char)c < 0x20)
+		{
+			if(len + 6 >= S)
+				break;
+			len += snprintf(&out[len], S - len, "\\u%04x", c);
+		}
+		else
+		{
+			if(len + 1 >= S)
+				break;
+			out[len++] = c;
+		}
+	}
+	out[len] = 0;
+}
+
+std::error_code writeJSON(const char *path)
+{
+	FileIO io;
+	if(auto ec = io.create(path);
+		ec)
+	{
+		logErr("error creating %s", path);
+		return ec;
+	}
+	bool wasEnabled = enabled.exchange(false, std::memory_order_relaxed);
+	std::lock_guard<std::mutex> lock{bufferListMutex};
+	bool ok = writeString(io, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	const char *sep = "";
+	uint events = 0;
+	for(auto buff : bufferList)
+	{
+		char line[256];
+		std::array<char, 128> name;
+		escapeJSONString(name, buff->name.data());
+		snprintf(line, sizeof(line), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+			sep, buff->tid, name.data());
+		ok = ok && writeString(io, line);
+		sep = ",\n";
+		auto written = buff->written.load(std::memory_order_acquire);
+		auto first = written > EVENTS_PER_THREAD ? written - EVENTS_PER_THREAD : 0;
+		for(auto i = first; i < written; i++)
+		{
+			auto &e = buff->event[i % EVENTS_PER_THREAD];
+			escapeJSONString(name, e.name);
+			snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				sep, name.data(), buff->tid, (e.start - baseTime) / 1000., e.dur / 1000.);
+			ok = ok && writeString(io, line);
+			events++;
+		}
+	}
+	ok = ok && writeString(io, "\n]}\n");
+	enabled.store(wasEnabled, std::memory_order_relaxed);
+	if(!ok)
+		return {EIO, std::system_category()};
+	logMsg("wrote %u events from %u threads to %s", events, (uint)bufferList.size(), path);
+	return {};
+}
+
+}
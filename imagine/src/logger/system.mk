@@ -13,3 +13,8 @@ else ifeq ($(ENV), webos)
 else ifeq ($(ENV), ps3)
  include $(imagineSrcDir)/logger/ps3/build.mk
 endif
+
+ifeq ($(imagineTrace), 1)
+ configDefs += CONFIG_TRACE
+ SRC += logger/Trace.cc
+endif
@@ -0,0 +1,266 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "ThreadPool"
+#include <imagine/thread/ThreadPool.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/logger/Trace.hh>
+#include <imagine/util/algorithm.h>
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace IG
+{
+
+// times TaskGroup::wait() yields with nothing to run before blocking
+static constexpr uint WAIT_SPINS = 64;
+
+// index of the calling thread's worker, -1 if it's not in a pool
+static thread_local int thisWorkerIdx = -1;
+static thread_local ThreadPool *thisWorkerPool{};
+
+ThreadPool::~ThreadPool()
+{
+	deinit();
+}
+
+bool ThreadPool::init(uint threads, bool pinThreads)
+{
+	if(workers)
+		return true;
+	if(!threads)
+	{
+		threads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+	}
+	quit = false;
+	worker = std::make_unique<Worker[]>(threads);
+	workers = threads;
+	iterateTimes(threads, i)
+	{
+		worker[i].thread = std::make_unique<IG::thread>([this, i, pinThreads](){ workerLoop(i, pinThreads); });
+	}
+	logMsg("started %u worker threads%s", threads, pinThreads ? " pinned to CPUs" : "");
+	return true;
+}
+
+void ThreadPool::deinit()
+{
+	if(!workers)
+		return;
+	{
+		std::lock_guard<std::mutex> lock{sleepMutex};
+		quit = true;
+	}
+	// workers drain the queues before exiting so no TaskGroup is left waiting
+	sleepCond.notify_all();
+	iterateTimes(workers, i)
+	{
+		worker[i].thread->join();
+	}
+	worker.reset();
+	workers = 0;
+	queuedTasks.store(0, std::memory_order_relaxed);
+}
+
+void ThreadPool::run(TaskDelegate task, TaskGroup *group)
+{
+	if(group)
+		group->pending.fetch_add(1, std::memory_order_relaxed);
+	Task t{task, group};
+	if(!workers)
+	{
+		runTask(t);
+		return;
+	}
+	// workers push to their own deque, other threads spread tasks round-robin
+	uint idx = thisWorkerPool == this ? thisWorkerIdx :
+		nextSubmitWorker.fetch_add(1, std::memory_order_relaxed) % workers;
+	{
+		std::lock_guard<std::mutex> lock{worker[idx].mutex};
+		worker[idx].tasks.emplace_back(t);
+	}
+	queuedTasks.fetch_add(1, std::memory_order_release);
+	{
+		// taking the lock orders this with a worker checking queuedTasks before sleeping
+		std::lock_guard<std::mutex> lock{sleepMutex};
+	}
+	sleepCond.notify_one();
+}
+
+void ThreadPool::runParallelFor(uint begin, uint end, RangeDelegate func, uint grainSize)
+{
+	if(begin >= end)
+		return;
+	grainSize = std::max(grainSize, 1u);
+	uint chunks = (end - begin + grainSize - 1) / grainSize;
+	if(chunks == 1 || !workers)
+	{
+		func(begin, end);
+		return;
+	}
+	struct RangeState
+	{
+		RangeDelegate func;
+		std::atomic_uint next;
+		uint end;
+		uint grainSize;
+
+		void runChunks()
+		{
+			// chunks are claimed dynamically so uneven work balances out
+			for(uint b = next.fetch_add(grainSize, std::memory_order_relaxed); b < end;
+				b = next.fetch_add(grainSize, std::memory_order_relaxed))
+			{
+				func(b, std::min(b + grainSize, end));
+			}
+		}
+	} state{func, {begin}, end, grainSize};
+	TaskGroup group{*this};
+	auto helpers = std::min(chunks - 1, workers);
+	iterateTimes(helpers, i)
+	{
+		group.run([statePtr = &state](){ statePtr->runChunks(); });
+	}
+	state.runChunks();
+	group.wait();
+}
+
+ThreadPool &ThreadPool::shared()
+{
+	static ThreadPool pool{};
+	static std::once_flag initFlag{};
+	std::call_once(initFlag, [](){ pool.init(); });
+	return pool;
+}
+
+bool ThreadPool::runQueuedTask(uint firstWorker)
+{
+	if(!queuedTasks.load(std::memory_order_acquire))
+		return false;
+	Task task{};
+	bool gotTask = false;
+	iterateTimes(workers, i)
+	{
+		uint idx = (firstWorker + i) % workers;
+		auto &w = worker[idx];
+		std::lock_guard<std::mutex> lock{w.mutex};
+		if(w.tasks.empty())
+			continue;
+		// own tasks are taken newest first while they're still in cache,
+		// stolen ones oldest first since those tend to be the biggest
+		if(idx == firstWorker && thisWorkerPool == this)
+		{
+			task = w.tasks.back();
+			w.tasks.pop_back();
+		}
+		else
+		{
+			task = w.tasks.front();
+			w.tasks.pop_front();
+		}
+		gotTask = true;
+		break;
+	}
+	if(!gotTask)
+		return false;
+	queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+	runTask(task);
+	return true;
+}
+
+void ThreadPool::workerLoop(uint idx, bool pin)
+{
+	thisWorkerIdx = idx;
+	thisWorkerPool = this;
+	#ifdef CONFIG_TRACE
+	char name[16];
+	snprintf(name, sizeof(name), "Worker %u", idx);
+	IG_TRACE_THREAD_NAME(name);
+	#endif
+	if(pin)
+	{
+		#ifdef __linux__
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		CPU_SET((idx + 1) % std::max(std::thread::hardware_concurrency(), 1u), &cpus);
+		if(sched_setaffinity(0, sizeof(cpus), &cpus) != 0)
+			logWarn("error setting affinity of worker %u", idx);
+		#endif
+	}
+	while(true)
+	{
+		if(runQueuedTask(idx))
+			continue;
+		std::unique_lock<std::mutex> lock{sleepMutex};
+		sleepCond.wait(lock,
+			[this](){ return quit || queuedTasks.load(std::memory_order_acquire); });
+		if(quit && !queuedTasks.load(std::memory_order_acquire))
+			return;
+	}
+}
+
+void ThreadPool::runTask(Task &task)
+{
+	task.func();
+	if(task.group)
+		task.group->taskDone();
+}
+
+void ThreadPool::TaskGroup::run(TaskDelegate task)
+{
+	pool.run(task, this);
+}
+
+void ThreadPool::TaskGroup::taskDone()
+{
+	// decremented under the lock so wait() can't return and destroy the
+	// group while the last task is still notifying it
+	std::lock_guard<std::mutex> lock{doneMutex};
+	if(pending.fetch_sub(1, std::memory_order_release) == 1)
+		doneCond.notify_all();
+}
+
+void ThreadPool::TaskGroup::wait()
+{
+	uint firstWorker = thisWorkerPool == &pool ? thisWorkerIdx : 0;
+	uint spins = 0;
+	while(pending.load(std::memory_order_acquire))
+	{
+		// help out instead of blocking, which also keeps nested waits from deadlocking
+		if(pool.runQueuedTask(firstWorker))
+		{
+			spins = 0;
+			continue;
+		}
+		// the remaining tasks are running elsewhere, they usually finish soon
+		if(spins < WAIT_SPINS)
+		{
+			spins++;
+			std::this_thread::yield();
+			continue;
+		}
+		std::unique_lock<std::mutex> lock{doneMutex};
+		doneCond.wait(lock, [this](){ return !pending.load(std::memory_order_relaxed); });
+		return;
+	}
+	// the last task may have just dropped the count and still hold the lock
+	std::lock_guard<std::mutex> lock{doneMutex};
+}
+
+}
@@ -7,3 +7,5 @@ else ifneq ($(filter ios macosx,$(ENV)),)
 else ifeq ($(ENV), win32)
  include $(imagineSrcDir)/thread/Win32Thread.mk
 endif
+
+SRC += thread/ThreadPool.cc
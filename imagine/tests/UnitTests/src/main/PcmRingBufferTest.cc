@@ -0,0 +1,184 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/util/ringbuffer/PcmRingBuffer.hh>
+#ifdef __linux__
+#include <imagine/util/ringbuffer/LinuxRingBuffer.hh>
+#endif
+#include <thread>
+#include "test.hh"
+
+// bytes count up from 0 so any lost, repeated or reordered byte is caught
+static void fillSequence(uint8 *data, size_t size, uint8 &next)
+{
+	for(size_t i = 0; i < size; i++)
+	{
+		data[i] = next++;
+	}
+}
+
+static bool matchesSequence(const uint8 *data, size_t size, uint8 &next)
+{
+	bool matches = true;
+	for(size_t i = 0; i < size; i++)
+	{
+		if(data[i] != next++)
+			matches = false;
+	}
+	return matches;
+}
+
+template <class MEMORY>
+static void testWrapAround()
+{
+	PcmRingBuffer<MEMORY> ring{};
+	TEST_CHECK(ring.init(1000));
+	TEST_CHECK(ring.freeSpace() == 1000);
+	TEST_CHECK(!ring.writtenSize());
+	uint8 writeNext = 0, readNext = 0;
+	uint8 data[400];
+	// odd sizes so reads and writes straddle the end of the buffer at different points
+	for(uint i = 0; i < 200; i++)
+	{
+		size_t writeSize = 1 + (i * 97) % 400;
+		auto free = ring.freeSpace();
+		fillSequence(data, writeSize, writeNext);
+		auto written = ring.write(data, writeSize);
+		TEST_CHECK(written == std::min(writeSize, free));
+		// the part that didn't fit gets written again next time
+		writeNext -= writeSize - written;
+		TEST_CHECK(ring.writtenSize() + ring.freeSpace() == 1000);
+		size_t readSize = 1 + (i * 61) % 400;
+		auto fill = ring.writtenSize();
+		auto read = ring.read(data, readSize);
+		TEST_CHECK(read == std::min(readSize, fill));
+		TEST_CHECK(matchesSequence(data, read, readNext));
+	}
+	ring.deinit();
+}
+
+template <class MEMORY>
+static void testFullAndEmpty()
+{
+	PcmRingBuffer<MEMORY> ring{};
+	TEST_CHECK(ring.init(64));
+	uint8 data[64]{};
+	TEST_CHECK(ring.write(data, 64) == 64);
+	TEST_CHECK(!ring.freeSpace());
+	TEST_CHECK(!ring.freeContiguousSpace());
+	TEST_CHECK(ring.write(data, 1) == 0);
+	TEST_CHECK(ring.read(data, 64) == 64);
+	TEST_CHECK(!ring.writtenSize());
+	TEST_CHECK(ring.freeSpace() == 64);
+	auto stats = ring.stats();
+	TEST_CHECK(stats.maxFill == 64);
+	TEST_CHECK(!stats.shortReads);
+	TEST_CHECK(ring.read(data, 1) == 0);
+	stats = ring.stats();
+	TEST_CHECK(!stats.minFill);
+	TEST_CHECK(stats.shortReads == 1);
+}
+
+// writes through writeAddr()/commitWrite() and reads through readAddr()/commitRead(),
+// only using the contiguous span unless the memory is mirrored
+template <class MEMORY>
+static void testDirectAccess()
+{
+	PcmRingBuffer<MEMORY> ring{};
+	TEST_CHECK(ring.init(4096));
+	uint8 writeNext = 0, readNext = 0;
+	for(uint i = 0; i < 100; i++)
+	{
+		size_t size = std::min(ring.freeContiguousSpace(), (size_t)1 + (i * 331) % 3000);
+		fillSequence((uint8*)ring.writeAddr(), size, writeNext);
+		ring.commitWrite(size);
+		size_t readSize = std::min(ring.writtenSize(), (size_t)1 + (i * 173) % 3000);
+		if(MEMORY::isMirrored)
+		{
+			TEST_CHECK(matchesSequence((const uint8*)ring.readAddr(), readSize, readNext));
+			ring.commitRead(readSize);
+		}
+		else
+		{
+			uint8 data[3000];
+			TEST_CHECK(ring.read(data, readSize) == readSize);
+			TEST_CHECK(matchesSequence(data, readSize, readNext));
+		}
+	}
+}
+
+// a producer and consumer thread pass a byte sequence through a small ring
+template <class MEMORY>
+static void testThreaded()
+{
+	PcmRingBuffer<MEMORY> ring{};
+	TEST_CHECK(ring.init(1024));
+	const size_t total = 4 * 1024 * 1024;
+	bool sequenceMatches = true;
+	std::thread consumer
+	{
+		[&]()
+		{
+			uint8 data[300];
+			uint8 next = 0;
+			size_t received = 0;
+			while(received < total)
+			{
+				auto read = ring.read(data, 1 + received % 300);
+				if(!read)
+				{
+					std::this_thread::yield();
+					continue;
+				}
+				if(!matchesSequence(data, read, next))
+					sequenceMatches = false;
+				received += read;
+			}
+		}
+	};
+	uint8 data[500];
+	uint8 next = 0;
+	size_t sent = 0;
+	while(sent < total)
+	{
+		auto size = std::min(total - sent, (size_t)1 + sent % 500);
+		fillSequence(data, size, next);
+		auto written = ring.write(data, size);
+		next -= size - written;
+		sent += written;
+		if(!written)
+			std::this_thread::yield();
+	}
+	consumer.join();
+	TEST_CHECK(sequenceMatches);
+	TEST_CHECK(!ring.writtenSize());
+}
+
+template <class MEMORY>
+static void runTestsWithMemory()
+{
+	testWrapAround<MEMORY>();
+	testFullAndEmpty<MEMORY>();
+	testDirectAccess<MEMORY>();
+	testThreaded<MEMORY>();
+}
+
+void runPcmRingBufferTests()
+{
+	runTestsWithMemory<MallocRingBufferMemory>();
+	#ifdef __linux__
+	runTestsWithMemory<LinuxMirroredMemory>();
+	#endif
+}
@@ -0,0 +1,204 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/audio/Resampler.hh>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "test.hh"
+
+using namespace Audio;
+
+static const Resampler::Quality qualities[]
+{
+	Resampler::Quality::LOW, Resampler::Quality::MEDIUM, Resampler::Quality::HIGH
+};
+
+static std::vector<int16> makeSine(double freq, double rate, uint frames, uint channels, double amplitude)
+{
+	std::vector<int16> data(frames * channels);
+	for(uint i = 0; i < frames; i++)
+	{
+		auto sample = (int16)std::lrint(amplitude * std::sin(2. * M_PI * freq * i / rate));
+		for(uint c = 0; c < channels; c++)
+		{
+			data[i * channels + c] = sample;
+		}
+	}
+	return data;
+}
+
+static std::vector<int16> resampleAll(Resampler &resampler, const std::vector<int16> &in)
+{
+	auto ch = resampler.channels();
+	uint inFrames = in.size() / ch;
+	std::vector<int16> out(resampler.maxOutputFrames(inFrames) * ch);
+	auto outFrames = resampler.process(in.data(), inFrames, out.data(), out.size() / ch);
+	out.resize(outFrames * ch);
+	return out;
+}
+
+static void testInvalidConfig()
+{
+	Resampler resampler{};
+	TEST_CHECK(!resampler.init(0, 48000, 2));
+	TEST_CHECK(!resampler.init(48000, 0, 2));
+	TEST_CHECK(!resampler.init(48000, 44100, 0));
+	TEST_CHECK(!resampler.init(48000, 44100, Resampler::MAX_CHANNELS + 1));
+	// decimating this far needs more taps than the filter allows
+	TEST_CHECK(!resampler.init(48000, 100, 2));
+	TEST_CHECK(!resampler);
+	TEST_CHECK(resampler.init(48000, 44100, 2));
+	TEST_CHECK(resampler);
+}
+
+// a constant signal comes out at the same level for any ratio
+static void testDCGain()
+{
+	for(auto quality : qualities)
+	{
+		for(double outRate : {22050., 44100., 48000., 96000.})
+		{
+			Resampler resampler{};
+			TEST_CHECK(resampler.init(44100, outRate, 1, quality));
+			std::vector<int16> in(4096, 10000);
+			auto out = resampleAll(resampler, in);
+			TEST_CHECK(out.size() > 1000);
+			// skip the start where the zeroed history is still in the filter
+			bool matches = true;
+			for(size_t i = 512; i < out.size(); i++)
+			{
+				if(std::abs(out[i] - 10000) > 2)
+					matches = false;
+			}
+			TEST_CHECK(matches);
+		}
+	}
+}
+
+// an in-band tone keeps its frequency, level and timing
+static void testSine()
+{
+	for(auto quality : qualities)
+	{
+		const double inRate = 32000, outRate = 48000, freq = 1000, amplitude = 16000;
+		Resampler resampler{};
+		TEST_CHECK(resampler.init(inRate, outRate, 2, quality));
+		auto out = resampleAll(resampler, makeSine(freq, inRate, 8000, 2, amplitude));
+		TEST_CHECK(out.size() / 2 > 10000);
+		double maxError = 0;
+		for(size_t i = 512; i < out.size() / 2; i++)
+		{
+			double expected = amplitude * std::sin(2. * M_PI * freq * i / outRate);
+			for(uint c = 0; c < 2; c++)
+			{
+				maxError = std::max(maxError, std::abs(out[i * 2 + c] - expected));
+			}
+		}
+		TEST_CHECK(maxError < amplitude * 0.01);
+	}
+}
+
+// a tone above the output's Nyquist frequency is filtered out when decimating
+static void testAliasRejection()
+{
+	for(auto quality : qualities)
+	{
+		const double amplitude = 16000;
+		Resampler resampler{};
+		TEST_CHECK(resampler.init(48000, 22050, 1, quality));
+		auto out = resampleAll(resampler, makeSine(16000, 48000, 16000, 1, amplitude));
+		double sumSq = 0;
+		size_t count = 0;
+		for(size_t i = 512; i < out.size(); i++)
+		{
+			sumSq += (double)out[i] * out[i];
+			count++;
+		}
+		TEST_CHECK(count);
+		// less than 1/100th of the tone's RMS level, -40dB
+		TEST_CHECK(std::sqrt(sumSq / count) < amplitude / std::sqrt(2.) * 0.01);
+	}
+}
+
+// output doesn't depend on how the input is split into calls, apart from
+// rounding where the position lands on a whole input frame
+static void testChunking()
+{
+	auto in = makeSine(440, 44100, 10000, 2, 12000);
+	Resampler whole{};
+	TEST_CHECK(whole.init(44100, 48000, 2));
+	auto expected = resampleAll(whole, in);
+	Resampler chunked{};
+	TEST_CHECK(chunked.init(44100, 48000, 2));
+	std::vector<int16> out{};
+	uint pos = 0, chunk = 1;
+	while(pos < 10000)
+	{
+		auto frames = std::min(chunk, 10000 - pos);
+		auto maxOutFrames = chunked.maxOutputFrames(frames);
+		// room past the limit to catch it being too low
+		std::vector<int16> outChunk((maxOutFrames + 64) * 2);
+		auto outFrames = chunked.process(&in[pos * 2], frames, outChunk.data(), outChunk.size() / 2);
+		TEST_CHECK(outFrames <= maxOutFrames);
+		out.insert(out.end(), outChunk.begin(), outChunk.begin() + outFrames * 2);
+		pos += frames;
+		chunk = chunk * 3 % 977 + 1;
+	}
+	TEST_CHECK(out.size() == expected.size());
+	bool matches = true;
+	for(size_t i = 0; i < std::min(out.size(), expected.size()); i++)
+	{
+		if(std::abs(out[i] - expected[i]) > 2)
+			matches = false;
+	}
+	TEST_CHECK(matches);
+}
+
+// inputFramesNeeded() is the fewest input frames that give the requested output,
+// including with the ratio adjusted
+static void testInputFramesNeeded()
+{
+	Resampler resampler{};
+	TEST_CHECK(resampler.init(44100, 48000, 2));
+	auto in = makeSine(440, 44100, 4096, 2, 12000);
+	std::vector<int16> out(4096 * 2);
+	uint pos = 0;
+	for(uint i = 0; i < 50; i++)
+	{
+		resampler.setRatioAdjust(i % 2 ? 1.005 : 0.995);
+		uint outFrames = 100 + i;
+		auto inFrames = resampler.inputFramesNeeded(outFrames);
+		if(pos + inFrames > 4096)
+			pos = 0;
+		if(inFrames)
+		{
+			auto trial = resampler;
+			TEST_CHECK(trial.process(&in[pos * 2], inFrames - 1, out.data(), outFrames) < outFrames);
+		}
+		TEST_CHECK(resampler.process(&in[pos * 2], inFrames, out.data(), outFrames) == outFrames);
+		pos += inFrames;
+	}
+}
+
+void runResamplerTests()
+{
+	testInvalidConfig();
+	testDCGain();
+	testSine();
+	testAliasRejection();
+	testChunking();
+	testInputFramesNeeded();
+}